@@ -1,5 +1,8 @@
 #include "blinker.h"
 #include <Arduino.h>
+#include "task.h"
+#include "morse-table.h"
+#include "energy.h"
 
 #define LED_PIN D4            // Pino do LED (GPIO2, ativo em HIGH)
 #define DOT_TIME 300          // Duração de ponto (ms)
@@ -10,30 +13,15 @@
 
 static char message[] = "SEMPRE ALERTA";  // Mensagem padrão em Morse
 static char morseMessage[100] = "";       // Buffer para mensagem Morse
-static bool blinkerActive = false;        // Estado do LED
-static unsigned long blinkerStartTime = 0; // Tempo inicial do evento
-static unsigned long blinkerDuration = 0; // Duração do evento
-static int morseIndex = 0;                // Índice do símbolo Morse
-
-// Tabela Morse em PROGMEM
-const struct {                            
-  const char* morse;
-  char letter;
-} morseBlinkerTable[] PROGMEM = {
-  { ".-", 'A' }, { "-...", 'B' }, { "-.-.", 'C' }, { "-..", 'D' }, { ".", 'E' },
-  { "..-.", 'F' }, { "--.", 'G' }, { "....", 'H' }, { "..", 'I' }, { ".---", 'J' },
-  { "-.-", 'K' }, { ".-..", 'L' }, { "--", 'M' }, { "-.", 'N' }, { "---", 'O' },
-  { ".--.", 'P' }, { "--.-", 'Q' }, { ".-.", 'R' }, { "...", 'S' }, { "-", 'T' },
-  { "..-", 'U' }, { "...-", 'V' }, { ".--", 'W' }, { "-..-", 'X' }, { "-.--", 'Y' },
-  { "--..", 'Z' }, { ".----", '1' }, { "..---", '2' }, { "...--", '3' },
-  { "....-", '4' }, { ".....", '5' }, { "-....", '6' }, { "--...", '7' },
-  { "---..", '8' }, { "----.", '9' }, { "-----", '0' }
-};
+static size_t morseIndex = 0;             // Índice do símbolo Morse
+static char current = '\0';               // Símbolo em execução
+static Task blinkerTask;                  // Tarefa sequencial do piscar
 
 // Configura LED e mensagem inicial
 void initBlinker() {
   pinMode(LED_PIN, OUTPUT);
   digitalWrite(LED_PIN, HIGH);
+  noteEnergyOutput(ENERGY_LED, true);
   setBlinkerMessage(message);
 }
 
@@ -45,17 +33,13 @@ void charToMorse(char c, char* morse) {
     strcat(morse, " ");
     return;
   }
-  for (int i = 0; i < 36; i++) {
-    char letter = pgm_read_byte(&morseBlinkerTable[i].letter);
-    if (letter == toupper(c)) {
-      strcpy_P(morse, morseBlinkerTable[i].morse);
-      Serial.print(now);
-      Serial.print(" - Convertendo caractere '");
-      Serial.print(c);
-      Serial.print("' para Morse: ");
-      Serial.println(morse);
-      break;
-    }
+  morseCodeToString(encodeMorse(c), morse);
+  if (morse[0] != '\0') {
+    Serial.print(now);
+    Serial.print(" - Convertendo caractere '");
+    Serial.print(c);
+    Serial.print("' para Morse: ");
+    Serial.println(morse);
   }
 }
 
@@ -77,44 +61,28 @@ void setBlinkerMessage(const char* newMessage) {
   Serial.println(morseMessage);
 }
 
-// Atualiza piscar do LED
+// Atualiza piscar do LED (tarefa: retoma exatamente no fim de cada espera)
 void updateBlinker() {
-  unsigned long now = millis();
-  if (!blinkerActive && morseIndex < strlen(morseMessage)) {
-    char current = morseMessage[morseIndex];
-    if (current == '.') {
-      digitalWrite(LED_PIN, HIGH);
-      blinkerDuration = DOT_TIME;
-      blinkerActive = true;
-      blinkerStartTime = now;
-      morseIndex++;
-    } else if (current == '-') {
+  TASK_BEGIN(blinkerTask);
+  for (;;) {
+    if (morseIndex >= strlen(morseMessage)) {
+      morseIndex = 0;
+      TASK_YIELD(blinkerTask);
+      continue;
+    }
+    current = morseMessage[morseIndex++];
+    if (current == '.' || current == '-') {
       digitalWrite(LED_PIN, HIGH);
-      blinkerDuration = DASH_TIME;
-      blinkerActive = true;
-      blinkerStartTime = now;
-      morseIndex++;
+      noteEnergyOutput(ENERGY_LED, true);
+      TASK_DELAY(blinkerTask, current == '.' ? DOT_TIME : DASH_TIME);
     } else if (current == '/') {
-      blinkerDuration = LETTER_GAP;
-      blinkerActive = true;
-      blinkerStartTime = now;
-      morseIndex++;
+      TASK_DELAY(blinkerTask, LETTER_GAP);
     } else if (current == ' ') {
-      blinkerDuration = WORD_GAP;
-      blinkerActive = true;
-      blinkerStartTime = now;
-      morseIndex++;
+      TASK_DELAY(blinkerTask, WORD_GAP);
     }
-  }
-
-  if (blinkerActive && (now - blinkerStartTime >= blinkerDuration)) {
     digitalWrite(LED_PIN, LOW);
-    blinkerActive = false;
-    blinkerDuration = SYMBOL_GAP;
-    blinkerStartTime = now;
-  }
-
-  if (morseIndex >= strlen(morseMessage) && !blinkerActive) {
-    morseIndex = 0;
+    noteEnergyOutput(ENERGY_LED, false);
+    TASK_DELAY(blinkerTask, SYMBOL_GAP);
   }
+  TASK_END(blinkerTask);
 }
@@ -7,6 +7,6 @@ void initBlinker(); // Configura LED e mensagem Morse inicial
 
 void setBlinkerMessage(const char* newMessage); // Define mensagem Morse
 
-void updateBlinker(); // Atualiza piscar do LED
+void updateBlinker(); // Atualiza piscar do LED (chamar a cada volta do loop)
 
 #endif
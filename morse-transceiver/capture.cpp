@@ -0,0 +1,132 @@
+#include "capture.h"
+#include "display.h"  // DISPLAY_PAGED libera ~900 bytes do framebuffer
+
+#if DISPLAY_PAGED
+#define CAPTURE_FRAMES 48     // Quadros mantidos no anel (+16 x 52 bytes com o display por páginas)
+#else
+#define CAPTURE_FRAMES 32     // Quadros mantidos no anel
+#endif
+#define CAPTURE_SNAPLEN 40    // Bytes de texto guardados por quadro
+#define CAPTURE_LINKTYPE 147  // LINKTYPE_USER0 (camada de enlace sintética)
+#define CAPTURE_HEX_LINE 32   // Bytes por linha "pcap:" no dump
+
+// Cabeçalho sintético de enlace (4 bytes): 'M', 'T', direção (0 = RX, 1 = TX), flags (bit 0 = truncado)
+#define CAPTURE_HEADER_LEN 4
+
+struct CaptureFrame {
+  uint32_t seconds;       // Timestamp em micros() estendido para 64 bits
+  uint32_t microseconds;
+  uint8_t direction;
+  uint8_t length;         // Bytes guardados
+  uint8_t originalLength; // Tamanho original (limitado a 255)
+  char data[CAPTURE_SNAPLEN];
+};
+
+#if CAPTURE_ENABLED
+static CaptureFrame frames[CAPTURE_FRAMES];
+static volatile uint32_t framesWritten = 0;  // Único escritor: o loop principal
+static uint32_t lastMicros = 0;
+static uint32_t microsWraps = 0;             // Voltas de micros() (~71 min cada)
+#endif
+
+#if CAPTURE_ENABLED
+// micros() estendido para 64 bits; precisa ser chamado ao menos uma vez por volta (~71 min)
+static uint64_t captureMicros() {
+  uint32_t nowMicros = micros();
+  if (nowMicros < lastMicros) microsWraps++;
+  lastMicros = nowMicros;
+  return ((uint64_t)microsWraps << 32) | nowMicros;
+}
+#endif
+
+void updateCapture() {
+#if CAPTURE_ENABLED
+  captureMicros();  // Sem quadros por mais de uma volta a virada passaria despercebida
+#endif
+}
+
+// Escritor único e sem trava: grava o slot e só depois publica o contador
+void captureFrame(CaptureDirection direction, const char* data, size_t length) {
+#if CAPTURE_ENABLED
+  uint64_t timestamp = captureMicros();
+  uint32_t index = framesWritten;
+  CaptureFrame& frame = frames[index % CAPTURE_FRAMES];
+  frame.seconds = (uint32_t)(timestamp / 1000000ULL);
+  frame.microseconds = (uint32_t)(timestamp % 1000000ULL);
+  frame.direction = (uint8_t)direction;
+  frame.length = (uint8_t)min(length, (size_t)CAPTURE_SNAPLEN);
+  frame.originalLength = (uint8_t)min(length, (size_t)255);
+  memcpy(frame.data, data, frame.length);
+  framesWritten = index + 1;
+#endif
+}
+
+#if CAPTURE_ENABLED
+static uint8_t hexBuffer[CAPTURE_HEX_LINE];
+static size_t hexLength = 0;
+
+static void flushHex(Print& out) {
+  if (hexLength == 0) return;
+  out.print("pcap:");
+  for (size_t i = 0; i < hexLength; i++) {
+    if (hexBuffer[i] < 0x10) out.print('0');
+    out.print(hexBuffer[i], HEX);
+  }
+  out.println();
+  hexLength = 0;
+}
+
+static void writeHex(Print& out, const void* data, size_t length) {
+  const uint8_t* bytes = (const uint8_t*)data;
+  for (size_t i = 0; i < length; i++) {
+    hexBuffer[hexLength++] = bytes[i];
+    if (hexLength == CAPTURE_HEX_LINE) flushHex(out);
+  }
+}
+
+// Campos do pcap em little-endian (ordem nativa do ESP8266)
+static void writeHex32(Print& out, uint32_t value) {
+  writeHex(out, &value, sizeof(value));
+}
+
+static void writeHex16(Print& out, uint16_t value) {
+  writeHex(out, &value, sizeof(value));
+}
+#endif
+
+// Saída: linhas "pcap:<hex>"; no PC, `grep ^pcap: log | cut -c6- | xxd -r -p > captura.pcap`
+void dumpCapturePcap(Print& out) {
+#if CAPTURE_ENABLED
+  unsigned long now = millis();
+  uint32_t written = framesWritten;
+  uint32_t first = (written > CAPTURE_FRAMES) ? written - CAPTURE_FRAMES : 0;
+  out.print(now);
+  out.print(" - Exportando captura: ");
+  out.print(written - first);
+  out.println(" quadros");
+  hexLength = 0;
+  writeHex32(out, 0xA1B2C3D4);  // Magic (microssegundos)
+  writeHex16(out, 2);           // Versão 2.4
+  writeHex16(out, 4);
+  writeHex32(out, 0);           // Fuso
+  writeHex32(out, 0);           // Precisão
+  writeHex32(out, CAPTURE_HEADER_LEN + CAPTURE_SNAPLEN);
+  writeHex32(out, CAPTURE_LINKTYPE);
+  for (uint32_t i = first; i < written; i++) {
+    CaptureFrame frame = frames[i % CAPTURE_FRAMES];
+    if (framesWritten - i > CAPTURE_FRAMES) continue;  // Sobrescrito durante a cópia
+    uint8_t header[CAPTURE_HEADER_LEN] = { 'M', 'T', frame.direction, (uint8_t)(frame.length < frame.originalLength ? 1 : 0) };
+    writeHex32(out, frame.seconds);
+    writeHex32(out, frame.microseconds);
+    writeHex32(out, CAPTURE_HEADER_LEN + frame.length);
+    writeHex32(out, CAPTURE_HEADER_LEN + frame.originalLength);
+    writeHex(out, header, sizeof(header));
+    writeHex(out, frame.data, frame.length);
+  }
+  flushHex(out);
+  out.print(millis());
+  out.println(" - Captura exportada");
+#else
+  out.println("Captura desabilitada (CAPTURE_ENABLED = 0)");
+#endif
+}
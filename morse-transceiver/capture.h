@@ -0,0 +1,16 @@
+#ifndef CAPTURE_H
+#define CAPTURE_H
+
+#include <Arduino.h>
+
+#define CAPTURE_ENABLED 1  // 0 = desliga a captura de quadros (sem custo em RAM)
+
+enum CaptureDirection { CAPTURE_RX, CAPTURE_TX };
+
+void captureFrame(CaptureDirection direction, const char* data, size_t length); // Registra quadro enviado/recebido
+
+void updateCapture(); // Acompanha as voltas de micros() mesmo sem tráfego (chamar a cada segundo)
+
+void dumpCapturePcap(Print& out); // Exporta o anel como pcap em hexadecimal (linhas "pcap:")
+
+#endif
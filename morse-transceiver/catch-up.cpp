@@ -0,0 +1,118 @@
+#include "catch-up.h"
+#include "event-bus.h"
+
+#define CATCHUP_CAPACITY 96   // Caracteres recentes mantidos (TX + RX)
+#define CATCHUP_CHUNK 24      // Caracteres por linha enviada a cada tick
+#define CATCHUP_RX_FLAG 0x80  // Bit 7 marca caractere recebido (RX)
+
+enum CatchUpStage { CATCHUP_IDLE, CATCHUP_BEGIN, CATCHUP_DATA, CATCHUP_END };
+
+static uint8_t ring[CATCHUP_CAPACITY];      // Anel: bits 0-6 = caractere, bit 7 = RX
+static uint32_t ringTotal = 0;              // Total gravado (posição absoluta)
+static uint32_t catchUpCursor = 0;          // Próxima posição absoluta a enviar
+static uint32_t catchUpEnd = 0;             // Fim do snapshot em envio
+static CatchUpStage stage = CATCHUP_IDLE;   // Etapa do envio atual
+
+// Grava caractere decodificado no anel (sobrescreve o mais antigo)
+void recordCatchUpChar(ConnectionState dir, char letter) {
+  uint8_t entry = (uint8_t)letter & 0x7F;
+  if (dir != TX) entry |= CATCHUP_RX_FLAG;
+  ring[ringTotal % CATCHUP_CAPACITY] = entry;
+  ringTotal++;
+}
+
+static void onLetter(const BusEvent& event) {
+  recordCatchUpChar((ConnectionState)event.arg, (char)event.value);
+}
+
+void initCatchUp() {
+  subscribeEvent(BUS_LETTER, onLetter);
+}
+
+// Tira snapshot do anel; o envio acontece aos poucos em nextCatchUpLine()
+void startCatchUp() {
+  unsigned long now = millis();
+  catchUpEnd = ringTotal;
+  catchUpCursor = (ringTotal > CATCHUP_CAPACITY) ? ringTotal - CATCHUP_CAPACITY : 0;
+  stage = CATCHUP_BEGIN;
+  Serial.print(now);
+  Serial.print(" - Catch-up iniciado com ");
+  Serial.print(catchUpEnd - catchUpCursor);
+  Serial.println(" caracteres");
+}
+
+// Monta uma linha por chamada: "catchup:begin", blocos ">TX<RX" e "catchup:end[>simbolo]"
+bool nextCatchUpLine(char* line, size_t size) {
+  unsigned long now = millis();
+  if (stage == CATCHUP_IDLE) return false;
+  if (stage == CATCHUP_BEGIN) {
+    snprintf(line, size, "catchup:begin");
+    stage = CATCHUP_DATA;
+    return true;
+  }
+  if (stage == CATCHUP_DATA) {
+    uint32_t oldest = (ringTotal > CATCHUP_CAPACITY) ? ringTotal - CATCHUP_CAPACITY : 0;
+    if (catchUpCursor < oldest) catchUpCursor = oldest;  // Anel sobrescrito durante envio
+    if (catchUpCursor < catchUpEnd) {
+      size_t len = snprintf(line, size, "catchup:");
+      int lastDir = -1;
+      size_t count = 0;
+      // Marcador de direção só quando muda: cada bloco começa com um marcador
+      while (catchUpCursor < catchUpEnd && count < CATCHUP_CHUNK && len + 3 < size) {
+        uint8_t entry = ring[catchUpCursor % CATCHUP_CAPACITY];
+        int dir = (entry & CATCHUP_RX_FLAG) ? 1 : 0;
+        if (dir != lastDir) {
+          line[len++] = dir ? '<' : '>';
+          lastDir = dir;
+        }
+        line[len++] = (char)(entry & 0x7F);
+        catchUpCursor++;
+        count++;
+      }
+      line[len] = '\0';
+      return true;
+    }
+    stage = CATCHUP_END;
+  }
+  // Envia também o símbolo em composição, se o AP estiver transmitindo
+  const char* symbol = getCurrentSymbol();
+  if (getConnectionState() == TX && strlen(symbol) > 0) {
+    snprintf(line, size, "catchup:end>%s", symbol);
+  } else {
+    snprintf(line, size, "catchup:end");
+  }
+  stage = CATCHUP_IDLE;
+  Serial.print(now);
+  Serial.println(" - Catch-up concluido");
+  return true;
+}
+
+// Lado cliente: TX do AP vira RX local e vice-versa
+void applyCatchUpLine(const char* payload) {
+  unsigned long now = millis();
+  if (strcmp(payload, "begin") == 0) {
+    clearHistory();
+    Serial.print(now);
+    Serial.println(" - Catch-up recebido: historico reiniciado");
+    return;
+  }
+  if (strncmp(payload, "end", 3) == 0) {
+    if (payload[3] == '>') restoreSymbol(payload + 4);
+    Serial.print(now);
+    Serial.print(" - Catch-up aplicado; TX: ");
+    Serial.print(getHistoryTX());
+    Serial.print(", RX: ");
+    Serial.println(getHistoryRX());
+    return;
+  }
+  ConnectionState dir = RX;
+  for (const char* p = payload; *p != '\0'; p++) {
+    if (*p == '>') {
+      dir = RX;
+    } else if (*p == '<') {
+      dir = TX;
+    } else if (isprint((unsigned char)*p)) {
+      appendHistory(dir, *p);
+    }
+  }
+}
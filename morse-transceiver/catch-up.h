@@ -0,0 +1,17 @@
+#ifndef CATCH_UP_H
+#define CATCH_UP_H
+
+#include <Arduino.h>
+#include "cw-transceiver.h"
+
+void initCatchUp(); // Assina os caracteres decodificados (barramento de eventos)
+
+void recordCatchUpChar(ConnectionState dir, char letter); // Grava caractere decodificado no anel recente
+
+void startCatchUp(); // Inicia envio do catch-up para cliente recém-conectado (AP)
+
+bool nextCatchUpLine(char* line, size_t size); // Próxima linha do catch-up; false se nada pendente
+
+void applyCatchUpLine(const char* payload); // Aplica linha "catchup:" recebida do AP (cliente)
+
+#endif
@@ -1,50 +1,186 @@
 #include "cw-transceiver.h"
 #include "network.h"
+#include "metrics.h"
+#include "scrollback.h"
+#include "morse-table.h"
+#include "mopp-gateway.h"
+#include "key-timing.h"
+#include "event-bus.h"
+#include "keyer.h"
+#include "transcript.h"
+#include "energy.h"
 
 static ConnectionState connectionState = FREE;
 static Mode mode = DIDACTIC;
 static char historyTX[30] = "";
 static char historyRX[30] = "";
 static char currentSymbol[7] = "";
+static InputSource symbolSource = LOCAL_INPUT;  // Quem chaveou a letra em curso
+static char lastTranslated[2] = "";  // Última letra decodificada (display)
 static unsigned long lastLocalPress = 0;
 static unsigned long lastLocalRelease = 0;
 static unsigned long lastRemotePress = 0;
 static unsigned long lastRemoteRelease = 0;
 static unsigned long lastActivity = 0;
 static bool letterGapProcessed = false;
+static unsigned long modeSwitchedAt = 0;
+static bool modeSwitched = false;
 
-const char* morseCode[] = {
-  ".-", "-...", "-.-.", "-..", ".", "..-.", "--.", "....", "..", ".---", "-.-", ".-..", "--", "-.", "---", ".--.", "--.-", ".-.", "...", "-", "..-", "...-", ".--", "-..-", "-.--", "--..",  // A-Z
-  "-----", ".----", "..---", "...--", "....-", ".....", "-....", "--...", "---..", "----.",  // 0-9
-  ".-.-.-", "--..--", "..--..", "-.-.-", "-....-", "-..-"  // . , ? ; - /
+// Instante da última borda de cada pino, gravado pela ISR: a duração medida não
+// depende de quando o loop amostra a tecla (período de 5 ms + atraso do loop)
+struct KeyEdges {
+  uint8_t pin;
+  volatile unsigned long pressAt;
+  volatile unsigned long releaseAt;
+  volatile bool pressSeen;
+  volatile bool releaseSeen;
 };
+static KeyEdges keyEdges[2] = { { LOCAL_PIN, 0, 0, false, false }, { REMOTE_PIN, 0, 0, false, false } };
 
-const char* morseChars = "ABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789.,?;-/";
+static void IRAM_ATTR onKeyEdge(void* arg) {
+  KeyEdges* edges = static_cast<KeyEdges*>(arg);
+  unsigned long at = millis();
+  bool down = digitalRead(edges->pin) == LOW;
+  if (edges->pin == LOCAL_PIN) keyerKeyEdge(down);  // Transmissor segue a chave local (se KEYER_ENABLED)
+  if (down) {
+    edges->pressAt = at;
+    edges->pressSeen = true;
+  } else {
+    edges->releaseAt = at;
+    edges->releaseSeen = true;
+  }
+}
+
+// Consome a borda gravada; usa "now" se não houve borda ou se ela é anterior a notBefore (repique)
+static unsigned long KEY_IRAM takeEdge(volatile bool& seen, volatile unsigned long& at, unsigned long notBefore, unsigned long now) {
+  noInterrupts();
+  bool valid = seen && (long)(at - notBefore) >= 0 && (long)(now - at) >= 0;
+  unsigned long edge = at;
+  seen = false;
+  interrupts();
+  return valid ? edge : now;
+}
+
+// Soltura aceita: log e contabilidade do buzzer, fora do caminho da tecla
+static void noteRelease(InputSource source, unsigned long now, long duration) {
+  Serial.print(now);
+  Serial.print(" - Duration ");
+  Serial.print(source == LOCAL_INPUT ? "local" : "remote");
+  Serial.print(": ");
+  Serial.println(duration);
+  noteEnergyOutput(ENERGY_BUZZER, false);
+  Serial.print(now);
+  Serial.println(" - Buzzer: OFF");
+}
+
+// Decodificador: consome os elementos publicados pelo amostrador da chave
+static void onKeyElement(const BusEvent& event) {
+  InputSource source = (InputSource)event.arg;
+  noteRelease(source, event.at, event.value);
+  if (source == LOCAL_INPUT && isScrollbackActive()) {
+    // Na rolagem: ponto = página anterior, traço = página seguinte
+    if (event.value <= SHORT_PRESS) {
+      scrollbackOlder();
+    } else {
+      scrollbackNewer();
+    }
+    return;
+  }
+  captureInput(source, event.value);
+}
+
+// Demais transições do amostrador: o que chama código na flash (Serial, métricas,
+// MOPP, energia, rolagem, histórico) roda aqui, no dispatchEvents()
+static void onKeyNote(const BusEvent& event) {
+  unsigned long now = event.at;
+  switch ((KeyNote)event.arg) {
+    case KEY_NOTE_PRESS:
+      Serial.print(now);
+      Serial.print(" - Press ");
+      Serial.println(event.value == LOCAL_INPUT ? "local" : "remote");
+      noteEnergyOutput(ENERGY_BUZZER, true);
+      Serial.print(now);
+      Serial.println(" - Buzzer: ON");
+      break;
+    case KEY_NOTE_MODE:
+      noteRelease(LOCAL_INPUT, now, event.value);
+      Serial.print(now);
+      Serial.print(" - Modo alterado para: ");
+      Serial.println(mode == DIDACTIC ? "DIDACTIC" : "MORSE");
+      break;
+    case KEY_NOTE_SCROLLBACK:
+      noteRelease(LOCAL_INPUT, now, event.value);
+      toggleScrollback();  // Pressão de 1,2-2 s entra/sai da rolagem do histórico
+      break;
+    case KEY_NOTE_LETTER: {
+      char letter = (char)(event.value & 0xFF);
+      if (letter != '\0') {
+        updateHistory(letter);
+        lastTranslated[0] = letter;
+        Serial.print(now);
+        Serial.print(" - Historico atualizado (");
+        Serial.print(connectionState == TX ? "TX" : "RX");
+        Serial.print("): ");
+        Serial.println(letter);
+        Serial.print(now);
+        Serial.print(" - Ultima letra traduzida: ");
+        Serial.println(letter);
+        Serial.print(now);
+        Serial.println(" - Gap processado");
+      } else {
+        char symbol[7];
+        morseCodeToString((uint8_t)(event.value >> 8), symbol);
+        recordMetric(METRIC_DECODE_ERRORS, 1);
+        Serial.print(now);
+        Serial.print(" - Simbolo nao reconhecido: ");
+        Serial.println(symbol);
+      }
+      moppNoteLetterEnd();
+      break;
+    }
+    case KEY_NOTE_IDLE:
+      Serial.print(now);
+      Serial.println(" - Inativo: FREE");
+      Serial.print(now);
+      Serial.println(" - Rede liberada por inatividade");
+      break;
+  }
+}
 
 void initCWTransceiver() {
+  subscribeEvent(BUS_KEY_ELEMENT, onKeyElement);
+  subscribeEvent(BUS_KEY_NOTE, onKeyNote);
   pinMode(LOCAL_PIN, INPUT_PULLUP);
   pinMode(REMOTE_PIN, INPUT_PULLUP);
   pinMode(BUZZER_PIN, OUTPUT);
   digitalWrite(BUZZER_PIN, LOW);
+  attachInterruptArg(digitalPinToInterrupt(LOCAL_PIN), onKeyEdge, &keyEdges[0], CHANGE);
+  attachInterruptArg(digitalPinToInterrupt(REMOTE_PIN), onKeyEdge, &keyEdges[1], CHANGE);
   lastActivity = millis();
   Serial.print(millis());
   Serial.println(" - CW Transceiver inicializado");
 }
 
-void updateCWTransceiver() {
-  unsigned long now = millis();
+void KEY_IRAM updateCWTransceiver() {
+  uint32_t start = ESP.getCycleCount();
   handleButtonPress(LOCAL_INPUT);
   handleButtonPress(REMOTE);
   handleButtonRelease(LOCAL_INPUT);
   handleButtonRelease(REMOTE);
   handleInactivity();
   handleLetterGap();
+  recordKeyTiming(KEY_PROBE_SAMPLE, ESP.getCycleCount() - start);
 }
 
+// Fora da IRAM: roda nos consumidores do barramento (chave, re-temporizador, MOPP)
 void captureInput(InputSource source, unsigned long duration) {
   unsigned long now = millis();
   char symbol = (duration <= SHORT_PRESS) ? '.' : '-';
+  recordMetric(METRIC_EVENTS, 1);
+  moppNoteElement(duration);
   size_t len = strlen(currentSymbol);
+  stampElement(source, len == 0);  // Carimbo HLC: o da letra é o do primeiro elemento
+  if (len == 0) symbolSource = source;
   if (len < 6) {
     currentSymbol[len] = symbol;
     currentSymbol[len + 1] = '\0';
@@ -56,102 +192,89 @@ void captureInput(InputSource source, unsigned long duration) {
     connectionState = TX;
     Serial.print(now);
     Serial.println(" - Exibindo estado: TX");
-    sendDuration(duration);
   } else if (source == REMOTE && connectionState == FREE) {
     connectionState = RX;
     Serial.print(now);
     Serial.println(" - Exibindo estado: RX");
   }
+  if (source == LOCAL_INPUT && connectionState == TX) sendDuration(duration);  // Todos os elementos do câmbio
+  if (source == REMOTE) lastRemoteRelease = now;  // Duração chega na soltura: base do gap de letra
   lastActivity = now;
   letterGapProcessed = false;
 }
 
-void handleButtonPress(InputSource source) {
+// Caminho da tecla (IRAM): só borda, classificação e postEvent(); log e efeitos vão
+// para onKeyElement()/onKeyNote(). millis(), digitalRead/Write e postEvent() estão na IRAM
+void KEY_IRAM handleButtonPress(InputSource source) {
   unsigned long now = millis();
   int pin = (source == LOCAL_INPUT) ? LOCAL_PIN : REMOTE_PIN;
+  KeyEdges& edges = keyEdges[source == LOCAL_INPUT ? 0 : 1];
   unsigned long& lastPress = (source == LOCAL_INPUT) ? lastLocalPress : lastRemotePress;
-  if (digitalRead(pin) == LOW && now - lastPress > DEBOUNCE_TIME) {
-    Serial.print(now);
-    Serial.print(" - Press ");
-    Serial.println(source == LOCAL_INPUT ? "local" : "remote");
+  unsigned long& lastRelease = (source == LOCAL_INPUT) ? lastLocalRelease : lastRemoteRelease;
+  // Só na transição: enquanto a tecla segue pressionada lastPress não é renovado
+  if (digitalRead(pin) == LOW && lastPress == 0 && now - lastRelease > DEBOUNCE_TIME) {
+    now = takeEdge(edges.pressSeen, edges.pressAt, lastRelease + DEBOUNCE_TIME, now);
+    edges.releaseSeen = false;  // Subidas antes da pressão são repique
     digitalWrite(BUZZER_PIN, HIGH);
-    Serial.print(now);
-    Serial.println(" - Buzzer: ON");
     lastPress = now;
     lastActivity = now;
     letterGapProcessed = false;
-    Serial.print(now);
-    Serial.println(" - letterGapProcessed resetado para false");
+    postEvent(BUS_KEY_NOTE, KEY_NOTE_PRESS, source);
   }
 }
 
-void handleButtonRelease(InputSource source) {
+void KEY_IRAM handleButtonRelease(InputSource source) {
   unsigned long now = millis();
   int pin = (source == LOCAL_INPUT) ? LOCAL_PIN : REMOTE_PIN;
+  KeyEdges& edges = keyEdges[source == LOCAL_INPUT ? 0 : 1];
   unsigned long& lastPress = (source == LOCAL_INPUT) ? lastLocalPress : lastRemotePress;
   unsigned long& lastRelease = (source == LOCAL_INPUT) ? lastLocalRelease : lastRemoteRelease;
   if (digitalRead(pin) == HIGH && now - lastPress > DEBOUNCE_TIME && lastPress != 0) {
+    now = takeEdge(edges.releaseSeen, edges.releaseAt, lastPress + DEBOUNCE_TIME, now);
     unsigned long duration = now - lastPress;
     if (duration >= DEBOUNCE_TIME) {
-      Serial.print(now);
-      Serial.print(" - Duration ");
-      Serial.print(source == LOCAL_INPUT ? "local" : "remote");
-      Serial.print(": ");
-      Serial.println(duration);
       if (source == LOCAL_INPUT && duration >= LONG_PRESS * 5) {
         mode = (mode == DIDACTIC) ? MORSE : DIDACTIC;
-        Serial.print(now);
-        Serial.print(" - Modo alterado para: ");
-        Serial.println(mode == DIDACTIC ? "DIDACTIC" : "MORSE");
+        modeSwitched = true;
+        modeSwitchedAt = now;
         currentSymbol[0] = '\0';
+        postEvent(BUS_KEY_NOTE, KEY_NOTE_MODE, duration);
+      } else if (source == LOCAL_INPUT && duration >= LONG_PRESS * 3) {
+        currentSymbol[0] = '\0';
+        postEvent(BUS_KEY_NOTE, KEY_NOTE_SCROLLBACK, duration);
       } else {
-        captureInput(source, duration);
+        postEvent(BUS_KEY_ELEMENT, source, duration);  // Decodificado (ou página da rolagem) no dispatchEvents() desta volta
       }
       digitalWrite(BUZZER_PIN, LOW);
-      Serial.print(now);
-      Serial.println(" - Buzzer: OFF");
       lastRelease = now;
       lastActivity = now;
       letterGapProcessed = false;
-      Serial.print(now);
-      Serial.println(" - letterGapProcessed resetado para false");
     }
     lastPress = 0;
   }
 }
 
-void handleInactivity() {
+void KEY_IRAM handleInactivity() {
   unsigned long now = millis();
   if (now - lastActivity > INACTIVITY_TIMEOUT && connectionState != FREE) {
     connectionState = FREE;
-    Serial.print(now);
-    Serial.println(" - Inativo: FREE");
-    Serial.print(now);
-    Serial.println(" - Rede liberada por inatividade");
     lastLocalRelease = now;
     lastRemoteRelease = now;
+    postEvent(BUS_KEY_NOTE, KEY_NOTE_IDLE, 0);
   }
 }
 
-void handleLetterGap() {
+void KEY_IRAM handleLetterGap() {
   unsigned long now = millis();
-  if (!letterGapProcessed && strlen(currentSymbol) > 0) {
-    unsigned long lastRelease = (connectionState == TX) ? lastLocalRelease : lastRemoteRelease;
+  if (!letterGapProcessed && currentSymbol[0] != '\0') {
+    // Pela origem da letra, não pelo estado: sem enlace a chave local fica em FREE
+    unsigned long lastRelease = (symbolSource == LOCAL_INPUT) ? lastLocalRelease : lastRemoteRelease;
     if (now - lastRelease >= LETTER_GAP && lastRelease != 0) {
-      char letter = translateMorse();
-      if (letter != '\0') {
-        updateHistory(letter);
-        Serial.print(now);
-        Serial.print(" - Historico atualizado (");
-        Serial.print(connectionState == TX ? "TX" : "RX");
-        Serial.print("): ");
-        Serial.println(letter);
-        Serial.print(now);
-        Serial.print(" - Ultima letra traduzida: ");
-        Serial.println(letter);
-        Serial.print(now);
-        Serial.println(" - Gap processado");
-      }
+      uint32_t start = ESP.getCycleCount();
+      uint8_t code = morseCodeFromString(currentSymbol);
+      char letter = decodeMorse(code);
+      recordKeyTiming(KEY_PROBE_DECODE, ESP.getCycleCount() - start);
+      postEvent(BUS_KEY_NOTE, KEY_NOTE_LETTER, (long)code << 8 | (uint8_t)letter);
       currentSymbol[0] = '\0';
       letterGapProcessed = true;
     }
@@ -159,17 +282,15 @@ void handleLetterGap() {
 }
 
 char translateMorse() {
-  if (strlen(currentSymbol) == 0) return '\0';
-  for (size_t i = 0; i < sizeof(morseCode) / sizeof(morseCode[0]); i++) {
-    if (strcmp(currentSymbol, morseCode[i]) == 0) {
-      return morseChars[i];
-    }
-  }
-  return '\0';
+  return decodeMorse(morseCodeFromString(currentSymbol));
 }
 
 void updateHistory(char letter) {
-  char* history = (connectionState == TX) ? historyTX : historyRX;
+  appendHistory(connectionState, letter);
+}
+
+void appendHistory(ConnectionState dir, char letter) {
+  char* history = (dir == TX) ? historyTX : historyRX;
   size_t len = strlen(history);
   if (len < 29) {
     history[len] = letter;
@@ -179,6 +300,31 @@ void updateHistory(char letter) {
     history[28] = letter;
     history[29] = '\0';
   }
+  postEvent(BUS_LETTER, dir, letter);  // Catch-up, log na flash e display
+}
+
+void clearHistory() {
+  historyTX[0] = '\0';
+  historyRX[0] = '\0';
+}
+
+void restoreSymbol(const char* symbol) {
+  if (strlen(currentSymbol) > 0) return;
+  strncpy(currentSymbol, symbol, 6);
+  currentSymbol[6] = '\0';
+  lastActivity = millis();
+  letterGapProcessed = false;
+}
+
+// Estado salvo antes de um reset (warm-restart.cpp); TX/RX voltam a FREE pelo timeout de inatividade
+void restoreTransceiver(Mode savedMode, ConnectionState savedState, const char* savedTX, const char* savedRX) {
+  mode = savedMode;
+  connectionState = savedState;
+  strncpy(historyTX, savedTX, sizeof(historyTX) - 1);
+  historyTX[sizeof(historyTX) - 1] = '\0';
+  strncpy(historyRX, savedRX, sizeof(historyRX) - 1);
+  historyRX[sizeof(historyRX) - 1] = '\0';
+  lastActivity = millis();
 }
 
 ConnectionState getConnectionState() {
@@ -200,3 +346,12 @@ const char* getHistoryTX() {
 const char* getHistoryRX() {
   return historyRX;
 }
+
+const char* getLastTranslated() {
+  return lastTranslated;
+}
+
+bool isModeSwitching() {
+  if (modeSwitched && millis() - modeSwitchedAt >= MODE_SWITCH_DISPLAY) modeSwitched = false;
+  return modeSwitched;
+}
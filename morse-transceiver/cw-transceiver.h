@@ -6,6 +6,14 @@
 enum InputSource { LOCAL_INPUT, REMOTE };
 enum ConnectionState { FREE, TX, RX };
 enum Mode { DIDACTIC, MORSE };
+// BUS_KEY_NOTE: o que o amostrador (IRAM) decidiu e o consumidor registra
+enum KeyNote : uint8_t {
+  KEY_NOTE_PRESS,       // value = InputSource
+  KEY_NOTE_MODE,        // Troca de modo já aplicada (value = duração em ms)
+  KEY_NOTE_SCROLLBACK,  // Entrar/sair da rolagem (value = duração em ms)
+  KEY_NOTE_LETTER,      // Fim de letra (value = código << 8 | caractere; caractere 0 = não reconhecido)
+  KEY_NOTE_IDLE         // Inatividade: estado voltou a FREE
+};
 
 #define LOCAL_PIN D5
 #define REMOTE_PIN D6
@@ -15,6 +23,7 @@ enum Mode { DIDACTIC, MORSE };
 #define LONG_PRESS 400
 #define LETTER_GAP 800
 #define INACTIVITY_TIMEOUT 5000
+#define MODE_SWITCH_DISPLAY 2000  // Tela "MODE" após a troca de modo
 
 void initCWTransceiver();
 void updateCWTransceiver();
@@ -25,10 +34,16 @@ void handleInactivity();
 void handleLetterGap();
 char translateMorse();
 void updateHistory(char letter);
+void appendHistory(ConnectionState dir, char letter);
+void clearHistory();
+void restoreSymbol(const char* symbol);
+void restoreTransceiver(Mode savedMode, ConnectionState savedState, const char* savedTX, const char* savedRX);
 ConnectionState getConnectionState();
 Mode getMode();
 const char* getCurrentSymbol();
 const char* getHistoryTX();
 const char* getHistoryRX();
+const char* getLastTranslated();
+bool isModeSwitching();
 
 #endif
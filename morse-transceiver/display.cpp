@@ -5,6 +5,11 @@
 #include "cw-transceiver.h"
 #include "bitmap.h"
 #include "network.h"  // Para getNetworkStrength()
+#include "scrollback.h"
+#include "retimer.h"
+#include "event-bus.h"
+#include "exchange.h"
+#include "energy.h"
 
 #define SCREEN_WIDTH 128
 #define SCREEN_HEIGHT 64
@@ -15,7 +20,99 @@
 #define DISPLAY_UPDATE_INTERVAL 100
 #define NETWORK_UPDATE_INTERVAL 5000  // Verifica sinal a cada 5s
 
+#define OLED_PAGES (SCREEN_HEIGHT / 8)
+#define OLED_CHUNK 16  // Bytes de dados por transmissão I2C (cabe no buffer do Wire)
+#define OLED_CONTRAST 0xCF  // O mesmo do Adafruit_SSD1306::begin() com charge pump interno
+
+enum View { VIEW_MODE, VIEW_ENERGY, VIEW_SCROLLBACK, VIEW_MAIN };
+
+// Conteúdo decidido uma vez por atualização; drawFrame() só desenha (pode rodar uma vez por página)
+static struct {
+  View view;
+  ConnectionState state;
+  const char* historyTX;
+  const char* historyRX;
+  char big[8];  // Texto grande à direita: letra, símbolo ou cursor
+  const uint8_t* page;  // Rolagem: página atual do histórico
+  size_t pageLength;
+  uint8_t lagSeconds;  // Atraso da re-temporização (0 = em dia, sem indicador)
+  bool dup;  // Indicativo recebido já trabalhado
+  float energyMah[ENERGY_COUNT];  // Página de consumo ("energy show")
+  EnergySubsystem energyLargest;
+} frame;
+
+static bool panelOn = false;
+static uint16_t litPixels = 0;  // Pixels acesos no último quadro (contabilidade de energia)
+
+static uint16_t countLit(const uint8_t* data, size_t length) {
+  uint16_t lit = 0;
+  for (size_t i = 0; i < length; i++) lit += __builtin_popcount(data[i]);
+  return lit;
+}
+
+#if DISPLAY_PAGED
+// Só uma página do SSD1306 (8 linhas x 128 colunas) em RAM: o layout é refeito
+// para cada página e os pixels fora dela são descartados
+class PageCanvas : public Adafruit_GFX {
+ public:
+  uint8_t page = 0;
+  uint8_t buffer[SCREEN_WIDTH];
+
+  PageCanvas() : Adafruit_GFX(SCREEN_WIDTH, SCREEN_HEIGHT) {}
+
+  void drawPixel(int16_t x, int16_t y, uint16_t color) override {
+    if (x < 0 || x >= SCREEN_WIDTH || y < 0 || (y >> 3) != page) return;
+    uint8_t bit = 1 << (y & 7);
+    if (color == WHITE) {
+      buffer[x] |= bit;
+    } else if (color == BLACK) {
+      buffer[x] &= ~bit;
+    } else {
+      buffer[x] ^= bit;
+    }
+  }
+};
+
+static PageCanvas canvas;
+
+static bool oledCommands(const uint8_t* commands, size_t count) {
+  Wire.beginTransmission(OLED_ADDRESS);
+  Wire.write((uint8_t)0x00);  // Co = 0, D/C = 0: sequência de comandos
+  Wire.write(commands, count);
+  return Wire.endTransmission() == 0;
+}
+
+// Mesma sequência do Adafruit_SSD1306::begin() para 128x64 com charge pump interno
+static bool initPanel() {
+  static const uint8_t init[] = {
+    0xAE, 0xD5, 0x80, 0xA8, SCREEN_HEIGHT - 1, 0xD3, 0x00, 0x40, 0x8D, 0x14, 0x20, 0x00,
+    0xA1, 0xC8, 0xDA, 0x12, 0x81, OLED_CONTRAST, 0xD9, 0xF1, 0xDB, 0x40, 0xA4, 0xA6, 0x2E, 0xAF
+  };
+  return oledCommands(init, sizeof(init));
+}
+
+// Desenha cada página no buffer de 128 bytes e envia antes de passar à próxima; devolve os pixels acesos
+static uint16_t streamPages(void (*draw)(Adafruit_GFX& gfx)) {
+  uint16_t lit = 0;
+  for (uint8_t page = 0; page < OLED_PAGES; page++) {
+    memset(canvas.buffer, 0, sizeof(canvas.buffer));
+    canvas.page = page;
+    draw(canvas);
+    lit += countLit(canvas.buffer, sizeof(canvas.buffer));
+    const uint8_t window[] = { 0x21, 0, SCREEN_WIDTH - 1, 0x22, page, page };
+    oledCommands(window, sizeof(window));
+    for (uint8_t x = 0; x < SCREEN_WIDTH; x += OLED_CHUNK) {
+      Wire.beginTransmission(OLED_ADDRESS);
+      Wire.write((uint8_t)0x40);  // D/C = 1: dados
+      Wire.write(canvas.buffer + x, OLED_CHUNK);
+      Wire.endTransmission();
+    }
+  }
+  return lit;
+}
+#else
 static Adafruit_SSD1306 display(SCREEN_WIDTH, SCREEN_HEIGHT, &Wire, -1);
+#endif
 static unsigned long lastBlink = 0;
 static unsigned long lastDisplay = 0;
 static char lastHistoryTX[30] = "";
@@ -27,34 +124,158 @@ static bool lastModeSwitching = false;
 static unsigned long lastUpdateTime = 0;
 static unsigned long lastNetworkUpdate = 0;
 static char lastStrength[5] = " OFF";  // Cache para otimizacao
+static uint16_t lastScrollbackVersion = 0;
 
-void initDisplay() {
+static void drawSplash(Adafruit_GFX& gfx) {
+  gfx.drawBitmap(0, 0, bitmap, SCREEN_WIDTH, SCREEN_HEIGHT, WHITE);
+}
+
+static void drawNothing(Adafruit_GFX&) {
+}
+
+static void drawFrame(Adafruit_GFX& gfx) {
+  gfx.setTextSize(1);
+  gfx.setTextColor(WHITE);
+  if (frame.view == VIEW_MODE) {
+    gfx.setTextSize(2);
+    gfx.setCursor(32, SCREEN_HEIGHT / 4 - 8);
+    gfx.println(getMode() == DIDACTIC ? "DIDACTIC" : "MORSE");
+    gfx.setCursor(32, SCREEN_HEIGHT * 3 / 4 - 8);
+    gfx.println("MODE");
+  } else if (frame.view == VIEW_ENERGY) {
+    // Consumo estimado por subsistema, maior consumidor em vídeo inverso
+    gfx.setCursor(0, 0);
+    gfx.print("ENERGIA (mAh)");
+    for (uint8_t i = 0; i < ENERGY_COUNT; i++) {
+      bool largest = i == frame.energyLargest;
+      gfx.setTextColor(largest ? BLACK : WHITE, largest ? WHITE : BLACK);
+      gfx.setCursor(0, 8 + i * 8);
+      gfx.print(getEnergyName((EnergySubsystem)i));
+      gfx.setCursor(48, 8 + i * 8);
+      gfx.print(frame.energyMah[i], 3);
+    }
+    gfx.setTextColor(WHITE);
+  } else if (frame.view == VIEW_SCROLLBACK) {
+    // Rolagem do historico: pagina de 6 linhas x 10 caracteres, RX em video inverso
+    gfx.drawFastVLine(64, 0, 64, WHITE);
+    for (size_t i = 0; i < frame.pageLength; i++) {
+      size_t row = i / 10;
+      bool rx = frame.page[i] & SCROLLBACK_RX_FLAG;
+      gfx.setTextColor(rx ? BLACK : WHITE, rx ? WHITE : BLACK);
+      gfx.setCursor(2 + (i % 10) * 6, 2 + row * 10 + (row >= 3 ? 2 : 0));
+      gfx.print((char)(frame.page[i] & 0x7F));
+    }
+    gfx.setTextColor(WHITE);
+    gfx.setCursor(68, 2);
+    gfx.print("HIST");
+    gfx.setCursor(68, 24);
+    gfx.print("pag ");
+    gfx.print(getScrollbackPageIndex() + 1);
+    gfx.setCursor(68, 36);
+    gfx.print("de ");
+    gfx.print(getScrollbackPageCount());
+  } else {
+    gfx.drawFastVLine(64, 0, 64, WHITE);
+    gfx.drawFastHLine(0, 32, 64, WHITE);
+    if (frame.state == TX) {
+      gfx.setCursor(68, 2);
+      gfx.print("TX");
+    } else if (frame.state == RX) {
+      gfx.setCursor(68, 55);
+      gfx.print("RX");
+    }
+
+    // Sinal Wi-Fi alinhado a direita (4 chars)
+    gfx.setCursor(104, 2);  // 128 - 4*6 = 104 para textSize(1)
+    gfx.print(lastStrength);
+
+    // Indicativo repetido (treino de contest), abaixo do TX
+    if (frame.dup) {
+      gfx.setCursor(68, 11);
+      gfx.print("DUP");
+    }
+
+    // Atraso da re-temporização em relação ao remetente, abaixo do sinal
+    if (frame.lagSeconds > 0) {
+      gfx.setCursor(104, 11);
+      gfx.print('+');
+      gfx.print(frame.lagSeconds);
+      gfx.print('s');
+    }
+
+    // Historico TX (esquerda superior) e RX (esquerda inferior), 10 + 10 + 9 caracteres
+    const char* histories[2] = { frame.historyTX, frame.historyRX };
+    for (uint8_t h = 0; h < 2; h++) {
+      char line[11];
+      for (uint8_t row = 0; row < 3; row++) {
+        size_t offset = row * 10;
+        line[0] = '\0';
+        if (strlen(histories[h]) > offset) {
+          strncpy(line, histories[h] + offset, row == 2 ? 9 : 10);
+          line[row == 2 ? 9 : 10] = '\0';
+        }
+        gfx.setCursor(2, 2 + h * 32 + row * 10);
+        gfx.print(line);
+      }
+    }
+
+    // Letra/simbolo direito
+    gfx.setTextSize(6);
+    gfx.setCursor(90, 20);
+    gfx.print(frame.big);
+    gfx.setTextSize(1);
+  }
+}
+
+// Desenha e envia ao painel: página a página (DISPLAY_PAGED) ou pelo framebuffer do Adafruit_SSD1306
+static void renderDisplay(void (*draw)(Adafruit_GFX& gfx)) {
+#if DISPLAY_PAGED
+  litPixels = streamPages(draw);
+#else
+  display.clearDisplay();
+  draw(display);
+  display.display();
+  litPixels = countLit(display.getBuffer(), SCREEN_WIDTH * SCREEN_HEIGHT / 8);
+#endif
+}
+
+// Caractere novo: atualiza já, sem esperar a próxima volta de 500 ms do loop
+static void onLetter(const BusEvent&) {
+  updateDisplay();
+}
+
+void initDisplay(bool splash) {
   unsigned long now = millis();
+  subscribeEvent(BUS_LETTER, onLetter);
   Serial.print(now);
   Serial.println(" - Inicializando I2C (SDA=D2, SCL=D1)");
   Wire.begin(D2, D1);
   Serial.print(now);
   Serial.print(" - Tentando inicializar SSD1306 no endereco 0x");
   Serial.println(OLED_ADDRESS, HEX);
+#if DISPLAY_PAGED
+  if (!initPanel()) {
+#else
   if (!display.begin(SSD1306_SWITCHCAPVCC, OLED_ADDRESS)) {
+#endif
     Serial.print(now);
     Serial.println(" - Erro: Falha ao inicializar SSD1306");
     for (;;);
   }
   Serial.print(now);
   Serial.println(" - SSD1306 inicializado com sucesso");
-  display.clearDisplay();
-  Serial.print(now);
-  Serial.println(" - Exibindo bitmap inicial");
-  display.drawBitmap(0, 0, bitmap, SCREEN_WIDTH, SCREEN_HEIGHT, WHITE);
-  display.display();
-  Serial.print(now);
-  Serial.println(" - Display inicializado com bitmap");
-  delay(DISPLAY_INIT_DURATION);  // Bloqueante; scans network async nao afetam
-  display.clearDisplay();
-  display.display();
-  Serial.print(now);
-  Serial.println(" - Display limpo apos bitmap");
+  panelOn = true;
+  if (splash) {
+    Serial.print(now);
+    Serial.println(" - Exibindo bitmap inicial");
+    renderDisplay(drawSplash);
+    Serial.print(now);
+    Serial.println(" - Display inicializado com bitmap");
+    delay(DISPLAY_INIT_DURATION);  // Bloqueante; scans network async nao afetam
+    renderDisplay(drawNothing);
+    Serial.print(now);
+    Serial.println(" - Display limpo apos bitmap");
+  }
   updateDisplay();
   Serial.print(now);
   Serial.println(" - Estrutura da tela exibida apos inicializacao");
@@ -71,14 +292,23 @@ void updateDisplay() {
   const char* lastTranslated = getLastTranslated();
   ConnectionState currentState = getConnectionState();
   bool modeSwitching = isModeSwitching();
+  uint16_t scrollbackVersion = getScrollbackVersion();
   static bool firstUpdate = true;
-  bool contentChanged = strcmp(currentHistTX, lastHistoryTX) != 0 ||
+  bool contentChanged = scrollbackVersion != lastScrollbackVersion ||
+                       strcmp(currentHistTX, lastHistoryTX) != 0 ||
                        strcmp(currentHistRX, lastHistoryRX) != 0 ||
                        strcmp(currentSymbol, lastSymbol) != 0 ||
                        currentState != lastState ||
                        modeSwitching != lastModeSwitching ||
                        strcmp(lastTranslated, lastTranslatedDisplay) != 0;
   bool logUpdate = contentChanged || firstUpdate;
+  uint8_t lagSeconds = min(getRetimeLag() / 1000, 99UL);
+  bool lagChanged = lagSeconds != frame.lagSeconds;
+  bool dup = isDupShowing();
+  bool dupChanged = dup != frame.dup;
+  static unsigned long lastEnergyFrame = 0;
+  bool energy = isEnergyShowing();
+  bool energyChanged = energy != (frame.view == VIEW_ENERGY) || (energy && now - lastEnergyFrame >= 1000);
 
   // Verifica sinal Wi-Fi a cada NETWORK_UPDATE_INTERVAL, mas imprime apenas se alterado
   bool strengthChanged = false;
@@ -94,7 +324,7 @@ void updateDisplay() {
     lastNetworkUpdate = now;
   }
 
-  if (!firstUpdate && !contentChanged && !modeSwitching && !strengthChanged &&
+  if (!firstUpdate && !contentChanged && !modeSwitching && !strengthChanged && !lagChanged && !dupChanged && !energyChanged &&
       !(getMode() == DIDACTIC && now - lastBlink >= CURSOR_BLINK)) return;
   firstUpdate = false;
 
@@ -106,66 +336,45 @@ void updateDisplay() {
     Serial.println(lastTranslatedDisplay);
   }
 
-  display.clearDisplay();
-  display.setTextSize(1);
-  display.setTextColor(WHITE);
-
+  frame.state = currentState;
+  frame.historyTX = currentHistTX;
+  frame.historyRX = currentHistRX;
+  frame.big[0] = '\0';
+  frame.lagSeconds = lagSeconds;
+  frame.dup = dup;
   if (modeSwitching) {
-    display.setTextSize(2);
-    display.setCursor(32, SCREEN_HEIGHT / 4 - 8);
-    if (getMode() == DIDACTIC) {
-      display.println("DIDACTIC");
-      display.setCursor(32, SCREEN_HEIGHT * 3 / 4 - 8);
-      display.println("MODE");
-    } else {
-      display.println("MORSE");
-      display.setCursor(32, SCREEN_HEIGHT * 3 / 4 - 8);
-      display.println("MODE");
-    }
+    frame.view = VIEW_MODE;
     if (logUpdate) {
       Serial.print(now);
       Serial.println(" - Exibindo modo no display");
     }
+  } else if (energy) {
+    frame.view = VIEW_ENERGY;
+    for (uint8_t i = 0; i < ENERGY_COUNT; i++) frame.energyMah[i] = getEnergyMah((EnergySubsystem)i);
+    frame.energyLargest = getLargestConsumer();
+    lastEnergyFrame = now;
+  } else if (isScrollbackActive()) {
+    frame.view = VIEW_SCROLLBACK;
+    frame.page = getScrollbackPage(&frame.pageLength);
+    if (logUpdate) {
+      Serial.print(now);
+      Serial.print(" - Exibindo pagina do historico: ");
+      Serial.println(getScrollbackPageIndex() + 1);
+    }
   } else {
-    display.drawFastVLine(64, 0, 64, WHITE);
-    display.drawFastHLine(0, 32, 64, WHITE);
-
-    if (currentState == TX) {
-      display.setCursor(68, 2);
-      display.print("TX");
-      if (logUpdate) {
-        Serial.print(now);
-        Serial.println(" - Exibindo estado: TX");
-      }
-    } else if (currentState == RX) {
-      display.setCursor(68, 55);
-      display.print("RX");
-      if (logUpdate) {
-        Serial.print(now);
-        Serial.println(" - Exibindo estado: RX");
-      }
+    frame.view = VIEW_MAIN;
+    if (logUpdate && currentState == TX) {
+      Serial.print(now);
+      Serial.println(" - Exibindo estado: TX");
+    } else if (logUpdate && currentState == RX) {
+      Serial.print(now);
+      Serial.println(" - Exibindo estado: RX");
     }
-
-    // Sinal Wi-Fi alinhado a direita (4 chars)
-    display.setCursor(104, 2);  // 128 - 4*6 = 104 para textSize(1)
-    display.print(lastStrength);
-
-    // Historico TX (esquerda superior)
-    char lineTX1[11], lineTX2[11], lineTX3[10];
-    memset(lineTX1, 0, sizeof(lineTX1)); memset(lineTX2, 0, sizeof(lineTX2)); memset(lineTX3, 0, sizeof(lineTX3));
-    strncpy(lineTX1, currentHistTX, 10); strncpy(lineTX2, currentHistTX + 10, 10); strncpy(lineTX3, currentHistTX + 20, 9);
-    display.setCursor(2, 2); display.print(lineTX1); display.setCursor(2, 12); display.print(lineTX2); display.setCursor(2, 22); display.print(lineTX3);
     if (logUpdate && strlen(currentHistTX) > 0) {
       Serial.print(now);
       Serial.print(" - Exibindo historico TX: ");
       Serial.println(currentHistTX);
     }
-
-    // Historico RX (esquerda inferior)
-    char lineRX1[11], lineRX2[11], lineRX3[10];
-    memset(lineRX1, 0, sizeof(lineRX1)); memset(lineRX2, 0, sizeof(lineRX2)); memset(lineRX3, 0, sizeof(lineRX3));
-    strncpy(lineRX1, currentHistRX, 10); strncpy(lineRX2, currentHistRX + 10, 10); strncpy(lineRX3, currentHistRX + 20, 9);
-    display.setCursor(2, 34); display.print(lineRX1); display.setCursor(2, 44); display.print(lineRX2); display.setCursor(2, 54); display.print(lineRX3);
     if (logUpdate && strlen(currentHistRX) > 0) {
       Serial.print(now);
       Serial.print(" - Exibindo historico RX: ");
@@ -173,11 +382,9 @@ void updateDisplay() {
     }
 
     // Letra/simbolo direito
-    display.setTextSize(6);
-    display.setCursor(90, 20);
     if (getMode() == DIDACTIC) {
       if (strlen(lastTranslatedDisplay) > 0 && now - lastDisplay < DISPLAY_DURATION) {
-        display.print(lastTranslatedDisplay);
+        strcpy(frame.big, lastTranslatedDisplay);
         if (logUpdate) {
           Serial.print(now);
           Serial.print(" - Exibindo letra: ");
@@ -187,12 +394,13 @@ void updateDisplay() {
         lastBlink = now;
         static bool showCursor = true;
         showCursor = !showCursor;
-        if (showCursor) display.print("_");
+        if (showCursor) strcpy(frame.big, "_");
         // Sem log para cursor piscante
       }
     } else if (getMode() == MORSE) {
       if (strlen(currentSymbol) > 0) {
-        display.print(currentSymbol);
+        strncpy(frame.big, currentSymbol, sizeof(frame.big) - 1);
+        frame.big[sizeof(frame.big) - 1] = '\0';
         if (logUpdate) {
           Serial.print(now);
           Serial.print(" - Exibindo simbolo atual: ");
@@ -203,7 +411,8 @@ void updateDisplay() {
                  (strlen(currentHistRX) > 0 && currentState == RX)) {
         char lastChar = (currentState == TX) ? currentHistTX[strlen(currentHistTX) - 1] : currentHistRX[strlen(currentHistRX) - 1];
         if (lastChar != '\0' && now - lastDisplay < DISPLAY_DURATION) {
-          display.print(lastChar);
+          frame.big[0] = lastChar;
+          frame.big[1] = '\0';
           if (logUpdate) {
             Serial.print(now);
             Serial.print(" - Exibindo simbolo: ");
@@ -212,10 +421,9 @@ void updateDisplay() {
         }
       }
     }
-    display.setTextSize(1);
   }
 
-  display.display();
+  renderDisplay(drawFrame);
   // Sem log geral para "Display atualizado"; apenas em mudanças de conteudo ou sinal acima
 
   strcpy(lastHistoryTX, currentHistTX);
@@ -223,4 +431,13 @@ void updateDisplay() {
   strcpy(lastSymbol, currentSymbol);
   lastState = currentState;
   lastModeSwitching = modeSwitching;
+  lastScrollbackVersion = scrollbackVersion;
+}
+
+uint8_t getDisplayContrast() {
+  return panelOn ? OLED_CONTRAST : 0;
+}
+
+float getDisplayLitFraction() {
+  return litPixels / (float)(SCREEN_WIDTH * SCREEN_HEIGHT);
 }
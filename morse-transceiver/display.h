@@ -3,8 +3,12 @@
 
 #include <Arduino.h>
 
-void initDisplay();
+#define DISPLAY_PAGED 0  // 1 = desenha página a página (128 bytes) sem o framebuffer de 1 KB do Adafruit_SSD1306
+
+void initDisplay(bool splash = true); // false: retomada após reset, sem a imagem de 3 s
 void updateDisplay();
+uint8_t getDisplayContrast(); // Contraste do painel (0 = desligado/não inicializado)
+float getDisplayLitFraction(); // Fração de pixels acesos no último quadro enviado
 
 extern const char* getNetworkStrength();  // De network.h
 
@@ -0,0 +1,197 @@
+#include "energy.h"
+#include <ESP8266WiFi.h>
+#include "tx-power.h"
+#include "display.h"
+
+static const char* const NAMES[ENERGY_COUNT] = { "TX", "RX", "SLEEP", "CPU", "OLED", "BUZZER", "LED" };
+
+#if ENERGY_ENABLED
+static double milliampSeconds[ENERGY_COUNT];  // double: semanas a 1 Hz sem perder as parcelas pequenas
+static double activeSeconds[ENERGY_COUNT];    // Tempo no estado (rádio) ou ligado
+static bool outputOn[ENERGY_COUNT];
+static unsigned long outputOnSince[ENERGY_COUNT];
+static uint32_t outputOnMs[ENERGY_COUNT];     // Tempo ligado desde a última integração
+static uint32_t loopWorkUs = 0;
+static double cpuBusySeconds = 0;
+static double lastTxSeconds = 0;  // Mesma precisão de tx-power: a diferença de dois totais grandes em float zera
+static double lastTxMilliampSeconds = 0;
+static unsigned long startedAt = 0;
+static unsigned long lastUpdate = 0;
+static unsigned long shownAt = 0;
+static bool shown = false;
+
+static void charge(EnergySubsystem subsystem, float seconds, float milliamps) {
+  activeSeconds[subsystem] += seconds;
+  milliampSeconds[subsystem] += seconds * milliamps;
+}
+
+// Estado do rádio fora do tempo no ar; amostrado a cada integração (1 s no loop)
+static EnergySubsystem radioState() {
+  WiFiMode_t mode = WiFi.getMode();
+  if (mode == WIFI_OFF) return ENERGY_COUNT;
+  if (mode == WIFI_STA && WiFi.status() == WL_CONNECTED && WiFi.getSleepMode() != WIFI_NONE_SLEEP) return ENERGY_RADIO_SLEEP;
+  return ENERGY_RADIO_RX;  // AP não dorme; scan e associação também não
+}
+#endif
+
+void initEnergy() {
+#if ENERGY_ENABLED
+  unsigned long now = millis();
+  memset(milliampSeconds, 0, sizeof(milliampSeconds));
+  memset(activeSeconds, 0, sizeof(activeSeconds));
+  lastTxSeconds = getTxSeconds();
+  lastTxMilliampSeconds = getTxMilliampSeconds();
+  loopWorkUs = 0;
+  cpuBusySeconds = 0;
+  startedAt = now;
+  lastUpdate = now;
+  Serial.print(now);
+  Serial.print(" - Contabilidade de energia iniciada (CPU a ");
+  Serial.print(ESP.getCpuFreqMHz());
+  Serial.println(" MHz)");
+#endif
+}
+
+void updateEnergy() {
+#if ENERGY_ENABLED
+  unsigned long now = millis();
+  uint32_t elapsedMs = now - lastUpdate;
+  if (elapsedMs == 0) return;
+  float elapsed = elapsedMs / 1000.0f;
+  lastUpdate = now;
+
+  // Rádio: tempo no ar e carga vêm de tx-power (corrente pela potência atual); o resto é RX ou sleep
+  double txSeconds = getTxSeconds() - lastTxSeconds;
+  double txMilliampSeconds = getTxMilliampSeconds() - lastTxMilliampSeconds;
+  lastTxSeconds += txSeconds;
+  lastTxMilliampSeconds += txMilliampSeconds;
+  activeSeconds[ENERGY_RADIO_TX] += txSeconds;
+  milliampSeconds[ENERGY_RADIO_TX] += txMilliampSeconds;
+  EnergySubsystem radio = radioState();
+  float listening = max(elapsed - (float)txSeconds, 0.0f);
+  if (radio == ENERGY_RADIO_RX) charge(radio, listening, ENERGY_RADIO_RX_MA);
+  if (radio == ENERGY_RADIO_SLEEP) charge(radio, listening, ENERGY_RADIO_SLEEP_MA);
+
+  // CPU: fração do tempo no corpo do loop, na frequência atual
+  float busy = min(loopWorkUs / (elapsedMs * 1000.0f), 1.0f);
+  float scale = ESP.getCpuFreqMHz() >= 160 ? ENERGY_CPU_160_FACTOR : 1.0f;
+  loopWorkUs = 0;
+  charge(ENERGY_CPU, elapsed, (ENERGY_CPU_IDLE_MA + (ENERGY_CPU_ACTIVE_MA - ENERGY_CPU_IDLE_MA) * busy) * scale);
+  cpuBusySeconds += elapsed * busy;
+
+  // OLED: corrente proporcional aos pixels acesos e ao contraste
+  uint8_t contrast = getDisplayContrast();
+  if (contrast > 0) {
+    charge(ENERGY_DISPLAY, elapsed, ENERGY_OLED_BASE_MA + ENERGY_OLED_FULL_MA * getDisplayLitFraction() * contrast / 255.0f);
+  }
+
+  for (uint8_t output = ENERGY_BUZZER; output <= ENERGY_LED; output++) {
+    if (outputOn[output]) {
+      outputOnMs[output] += now - outputOnSince[output];
+      outputOnSince[output] = now;
+    }
+    charge((EnergySubsystem)output, outputOnMs[output] / 1000.0f, output == ENERGY_BUZZER ? ENERGY_BUZZER_MA : ENERGY_LED_MA);
+    outputOnMs[output] = 0;
+  }
+#endif
+}
+
+void noteEnergyOutput(EnergySubsystem output, bool on) {
+#if ENERGY_ENABLED
+  if (output != ENERGY_BUZZER && output != ENERGY_LED) return;
+  unsigned long now = millis();
+  if (on && !outputOn[output]) {
+    outputOnSince[output] = now;
+  } else if (!on && outputOn[output]) {
+    outputOnMs[output] += now - outputOnSince[output];
+  }
+  outputOn[output] = on;
+#else
+  (void)output;
+  (void)on;
+#endif
+}
+
+void noteLoopWork(uint32_t us) {
+#if ENERGY_ENABLED
+  loopWorkUs += us;
+#else
+  (void)us;
+#endif
+}
+
+float getEnergyMah(EnergySubsystem subsystem) {
+#if ENERGY_ENABLED
+  return subsystem < ENERGY_COUNT ? milliampSeconds[subsystem] / 3600.0 : 0;
+#else
+  (void)subsystem;
+  return 0;
+#endif
+}
+
+const char* getEnergyName(EnergySubsystem subsystem) {
+  return subsystem < ENERGY_COUNT ? NAMES[subsystem] : "?";
+}
+
+EnergySubsystem getLargestConsumer() {
+  EnergySubsystem largest = ENERGY_RADIO_TX;
+#if ENERGY_ENABLED
+  for (uint8_t i = 1; i < ENERGY_COUNT; i++) {
+    if (milliampSeconds[i] > milliampSeconds[largest]) largest = (EnergySubsystem)i;
+  }
+#endif
+  return largest;
+}
+
+void showEnergy() {
+#if ENERGY_ENABLED
+  shownAt = millis();
+  shown = true;
+#endif
+}
+
+bool isEnergyShowing() {
+#if ENERGY_ENABLED
+  if (shown && millis() - shownAt >= ENERGY_SHOW_DURATION) shown = false;
+  return shown;
+#else
+  return false;
+#endif
+}
+
+void dumpEnergy(Print& out) {
+#if ENERGY_ENABLED
+  unsigned long now = millis();
+  double total = 0;
+  for (uint8_t i = 0; i < ENERGY_COUNT; i++) total += milliampSeconds[i];
+  float hours = (lastUpdate - startedAt) / 3600000.0f;
+  out.print(now);
+  out.print(" - Energia estimada: ");
+  out.print(total / 3600.0, 3);
+  out.print(" mAh em ");
+  out.print(hours, 2);
+  out.print(" h (media ");
+  out.print(hours > 0 ? total / 3600.0 / hours : 0, 1);
+  out.print(" mA), CPU a ");
+  out.print(ESP.getCpuFreqMHz());
+  out.print(" MHz ocupada ");
+  out.print(activeSeconds[ENERGY_CPU] > 0 ? cpuBusySeconds * 100.0 / activeSeconds[ENERGY_CPU] : 0, 1);
+  out.print("%, maior consumidor: ");
+  out.println(getEnergyName(getLargestConsumer()));
+  for (uint8_t i = 0; i < ENERGY_COUNT; i++) {
+    out.print("  ");
+    out.print(NAMES[i]);
+    out.print(": ");
+    out.print(activeSeconds[i], 1);
+    out.print(" s ativo, ");
+    out.print(activeSeconds[i] > 0 ? milliampSeconds[i] / activeSeconds[i] : 0, 1);
+    out.print(" mA, ");
+    out.print(milliampSeconds[i] / 3600.0, 4);
+    out.print(" mAh (");
+    out.print(total > 0 ? milliampSeconds[i] * 100.0 / total : 0, 0);
+    out.println("%)");
+  }
+#else
+  out.println("Energia desabilitada (ENERGY_ENABLED = 0)");
+#endif
+}
@@ -0,0 +1,41 @@
+#ifndef ENERGY_H
+#define ENERGY_H
+
+#include <Arduino.h>
+
+#define ENERGY_ENABLED 1               // 1 = estima consumo (mAh) por subsistema
+#define ENERGY_RADIO_RX_MA 70.0f       // Rádio ligado ouvindo (AP, scan, STA sem modem sleep)
+#define ENERGY_RADIO_SLEEP_MA 15.0f    // STA associada em modem sleep (média com os beacons DTIM)
+#define ENERGY_CPU_IDLE_MA 8.0f        // CPU a 80 MHz fora do corpo do loop (yield/SDK)
+#define ENERGY_CPU_ACTIVE_MA 14.0f     // CPU a 80 MHz executando o loop
+#define ENERGY_CPU_160_FACTOR 1.6f     // Multiplicador da CPU a 160 MHz
+#define ENERGY_OLED_BASE_MA 0.5f       // Painel ligado, tudo apagado
+#define ENERGY_OLED_FULL_MA 22.0f      // Todos os pixels acesos no contraste máximo
+#define ENERGY_BUZZER_MA 25.0f
+#define ENERGY_LED_MA 3.0f
+#define ENERGY_SHOW_DURATION 10000     // ms da página de consumo no display ("energy show")
+
+// TX usa o modelo de corrente de tx-power.cpp (base + inclinação x dBm) sobre o tempo no ar
+enum EnergySubsystem : uint8_t { ENERGY_RADIO_TX, ENERGY_RADIO_RX, ENERGY_RADIO_SLEEP, ENERGY_CPU, ENERGY_DISPLAY, ENERGY_BUZZER, ENERGY_LED, ENERGY_COUNT };
+
+void initEnergy(); // Zera os acumuladores (chamar após initDisplay e initTxPower)
+
+void updateEnergy(); // Integra o consumo de cada subsistema desde a última chamada (1 s no loop)
+
+void noteEnergyOutput(EnergySubsystem output, bool on); // Buzzer ou LED ligado/desligado (tempo ligado)
+
+void noteLoopWork(uint32_t us); // Tempo de CPU gasto numa volta do loop (atividade)
+
+float getEnergyMah(EnergySubsystem subsystem);
+
+const char* getEnergyName(EnergySubsystem subsystem); // Rótulo curto ("TX", "OLED"...)
+
+EnergySubsystem getLargestConsumer();
+
+void showEnergy(); // Página de consumo no display por ENERGY_SHOW_DURATION
+
+bool isEnergyShowing();
+
+void dumpEnergy(Print& out); // Tempo, mA médio e mAh por subsistema, maior consumidor
+
+#endif
@@ -0,0 +1,73 @@
+#include "event-bus.h"
+#include "key-timing.h"
+
+#define BUS_PRIORITIES 3
+#define BUS_QUEUE_SIZE 16      // Eventos por prioridade (potência de 2)
+#define BUS_MAX_HANDLERS 8     // Consumidores por tipo (BUS_LETTER é o mais disputado; sobra folga)
+#define BUS_DISPATCH_BUDGET 16 // Eventos entregues por chamada
+
+// 0 = elementos (decodificador/sidetone), 1 = caracteres e palavras (gravação/display), 2 = console
+static const uint8_t PRIORITY[BUS_EVENT_COUNT] = { 0, 0, 0, 1, 1, 2 };
+
+// Uma fila circular por prioridade. Produtores e consumidores rodam no loop
+// (tarefas cooperativas, callbacks do lwIP entre voltas): sem trava
+struct BusQueue {
+  BusEvent events[BUS_QUEUE_SIZE];
+  uint8_t head;
+  uint8_t tail;
+};
+
+static BusQueue queues[BUS_PRIORITIES];
+static BusHandler handlers[BUS_EVENT_COUNT][BUS_MAX_HANDLERS];
+static unsigned long eventsDropped = 0;
+
+void subscribeEvent(BusEventType type, BusHandler handler) {
+  for (uint8_t i = 0; i < BUS_MAX_HANDLERS; i++) {
+    if (handlers[type][i] == nullptr) {
+      handlers[type][i] = handler;
+      return;
+    }
+  }
+  // Erro de montagem, não de execução: para aqui em vez de seguir com um consumidor surdo
+  Serial.print(millis());
+  Serial.print(" - Erro: barramento sem vaga para mais um consumidor do evento ");
+  Serial.print(type);
+  Serial.println("; aumente BUS_MAX_HANDLERS");
+  for (;;);
+}
+
+bool KEY_IRAM postEvent(BusEventType type, uint8_t arg, long value) {
+  BusQueue& queue = queues[PRIORITY[type]];
+  if ((uint8_t)(queue.head - queue.tail) >= BUS_QUEUE_SIZE) {
+    eventsDropped++;
+    return false;
+  }
+  BusEvent& event = queue.events[queue.head % BUS_QUEUE_SIZE];
+  event.type = type;
+  event.arg = arg;
+  event.at = millis();
+  event.value = value;
+  queue.head++;
+  return true;
+}
+
+void dispatchEvents() {
+  for (uint8_t budget = 0; budget < BUS_DISPATCH_BUDGET; budget++) {
+    // Reavalia a partir da maior prioridade: o que um consumidor publicar passa na frente
+    uint8_t p = 0;
+    while (p < BUS_PRIORITIES && queues[p].head == queues[p].tail) p++;
+    if (p == BUS_PRIORITIES) break;
+    BusQueue& queue = queues[p];
+    BusEvent event = queue.events[queue.tail % BUS_QUEUE_SIZE];  // Cópia: o consumidor pode publicar na mesma fila
+    queue.tail++;
+    for (uint8_t i = 0; i < BUS_MAX_HANDLERS && handlers[event.type][i] != nullptr; i++) {
+      handlers[event.type][i](event);
+    }
+  }
+  if (eventsDropped > 0) {
+    Serial.print(millis());
+    Serial.print(" - Barramento: eventos descartados (fila cheia): ");
+    Serial.println(eventsDropped);
+    eventsDropped = 0;
+  }
+}
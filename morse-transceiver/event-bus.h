@@ -0,0 +1,31 @@
+#ifndef EVENT_BUS_H
+#define EVENT_BUS_H
+
+#include <Arduino.h>
+
+enum BusEventType : uint8_t {
+  BUS_KEY_ELEMENT,  // Elemento da chave (arg = InputSource, value = duração em ms)
+  BUS_KEY_NOTE,     // Outra transição do amostrador, para log e efeitos fora da IRAM (arg = KeyNote)
+  BUS_NET_ELEMENT,  // "duration:" recebido do peer (arg = vaga do carimbo HLC, value = duração em ms)
+  BUS_LETTER,       // Caractere decodificado (arg = ConnectionState, value = caractere)
+  BUS_TOKEN,        // Palavra reconhecida pelo extrator (arg = TokenKind, value = id para getExchangeToken())
+  BUS_CONSOLE,      // Comando da Serial (arg = comando, value = parâmetro)
+  BUS_EVENT_COUNT
+};
+
+struct BusEvent {
+  BusEventType type;
+  uint8_t arg;
+  unsigned long at;  // millis() na publicação
+  long value;
+};
+
+typedef void (*BusHandler)(const BusEvent& event);
+
+void subscribeEvent(BusEventType type, BusHandler handler); // Registra consumidor (nas funções init)
+
+bool postEvent(BusEventType type, uint8_t arg, long value); // O(1), sem alocação; false se a fila da prioridade estiver cheia
+
+void dispatchEvents(); // Entrega os pendentes aos consumidores, maior prioridade primeiro (chamar a cada volta do loop)
+
+#endif
@@ -0,0 +1,257 @@
+#include "exchange.h"
+#include "cw-transceiver.h"
+#include "event-bus.h"
+
+#define EXCHANGE_WORD_GAP 1600   // Entre caracteres (ms): acima disso começa outra palavra
+#define TOKEN_RING 4             // Palavras publicadas ainda legíveis pelos consumidores
+#define WORKED_SLOTS 128         // Conjunto de indicativos (potência de 2), endereçamento aberto
+#define WORKED_MAX 96            // Ocupação máxima (75%) para as sondagens continuarem curtas
+#define DUP_SHOW_TIME 3000
+
+// Estados do reconhecedor de indicativo: [prefixo/] [A-Z0-9]? [A-Z] [0-9] [A-Z]{1,4} [/sufixo]
+enum CallState : uint8_t {
+  CALL_START,    // Nada ainda
+  CALL_LEAD,     // Um caractere do prefixo (letra ou dígito)
+  CALL_PREFIX,   // Prefixo terminado em letra: falta o dígito
+  CALL_DIGIT,    // Dígito da área: falta o sufixo
+  CALL_SUFFIX,   // 1-4 letras do sufixo (aceita)
+  CALL_PORTABLE, // Depois de "/": /P, /M, /QRP, /5 (aceita se houver algo)
+  CALL_REJECT
+};
+
+// Estados do reconhecedor de RST: [1-5] [1-9N] [1-9N] (N = 9 abreviado)
+enum RstState : uint8_t { RST_START, RST_R, RST_S, RST_T, RST_REJECT };
+
+// Abreviações de troca comuns (comparadas só quando a palavra termina)
+static const char* const WORDS[] = { "CQ", "DE", "K", "KN", "BK", "R", "TU", "73", "SK", "AR", "+", "TEST", "QRZ", "UR", "RST", "NAME", "QTH", "OP" };
+
+struct Extractor {
+  char token[EXCHANGE_TOKEN_MAX + 1];
+  uint8_t length;
+  CallState call;
+  uint8_t callPart;  // Caracteres na parte atual (sufixo ou portátil)
+  bool prefixed;     // Já consumiu um "PREFIXO/"
+  bool leadLetter;   // Primeiro caractere do indicativo (após o prefixo) é letra
+  RstState rst;
+  bool digitsOnly;
+  bool overflow;
+  unsigned long firstAt;
+  unsigned long lastAt;
+};
+
+static Extractor extractors[2];  // 0 = TX, 1 = RX
+static uint64_t worked[WORKED_SLOTS];  // 0 = vazio; senão indicativo em base 38
+static uint16_t workedCount = 0;
+static unsigned long tokenCounts[TOKEN_KIND_COUNT];
+static unsigned long dupCount = 0;
+static unsigned long lastDupAt = 0;
+static bool dupShown = false;
+static char lastCall[EXCHANGE_TOKEN_MAX + 1] = "";
+static ExchangeToken tokens[TOKEN_RING];
+static uint32_t tokenSerial = 0;
+static uint64_t overCall = 0;  // Último indicativo do câmbio RX atual (repetir "K1ABC K1ABC" não é DUP)
+
+static void resetExtractor(Extractor& x) {
+  x.length = 0;
+  x.call = CALL_START;
+  x.callPart = 0;
+  x.prefixed = false;
+  x.rst = RST_START;
+  x.digitsOnly = true;
+  x.overflow = false;
+}
+
+// Um passo do reconhecedor de indicativo; nunca volta no texto já lido
+static CallState stepCall(Extractor& x, char c) {
+  bool letter = c >= 'A' && c <= 'Z';
+  bool digit = c >= '0' && c <= '9';
+  switch (x.call) {
+    case CALL_START:
+      x.leadLetter = letter;
+      return (letter || digit) ? CALL_LEAD : CALL_REJECT;
+    case CALL_LEAD:
+      if (c == '/' && !x.prefixed) break;
+      if (digit && x.leadLetter) return CALL_DIGIT;  // "K1"
+      return letter ? CALL_PREFIX : CALL_REJECT;          // "VE", "2E"
+    case CALL_PREFIX:
+      if (c == '/' && !x.prefixed) break;
+      return digit ? CALL_DIGIT : CALL_REJECT;
+    case CALL_DIGIT:
+      x.callPart = 0;
+      if (c == '/' && !x.prefixed) break;
+      if (!letter) return CALL_REJECT;
+      x.callPart = 1;
+      return CALL_SUFFIX;
+    case CALL_SUFFIX:
+      if (c == '/') {
+        x.callPart = 0;
+        return CALL_PORTABLE;
+      }
+      if (!letter || ++x.callPart > 4) return CALL_REJECT;
+      return CALL_SUFFIX;
+    case CALL_PORTABLE:
+      if (!(letter || digit) || ++x.callPart > 4) return CALL_REJECT;
+      return CALL_PORTABLE;
+    default:
+      return CALL_REJECT;
+  }
+  // "PREFIXO/" (até 4 caracteres): o indicativo propriamente dito começa agora
+  x.prefixed = true;
+  return (x.length <= 4) ? CALL_START : CALL_REJECT;
+}
+
+static RstState stepRst(RstState state, char c) {
+  bool signal = (c >= '1' && c <= '9') || c == 'N';
+  switch (state) {
+    case RST_START: return (c >= '1' && c <= '5') ? RST_R : RST_REJECT;
+    case RST_R: return signal ? RST_S : RST_REJECT;
+    case RST_S: return signal ? RST_T : RST_REJECT;
+    default: return RST_REJECT;
+  }
+}
+
+static uint64_t packCall(const char* call) {
+  uint64_t key = 0;
+  for (const char* p = call; *p != '\0'; p++) {
+    uint8_t digit = (*p >= 'A' && *p <= 'Z') ? *p - 'A' + 1 : (*p >= '0' && *p <= '9') ? *p - '0' + 27 : 37;
+    key = key * 38 + digit;
+  }
+  return key;
+}
+
+// Insere o indicativo; true se já estava no conjunto
+static bool markWorked(uint64_t key) {
+  uint32_t slot = (uint32_t)((key * 0x9E3779B97F4A7C15ULL) >> 57) & (WORKED_SLOTS - 1);
+  while (worked[slot] != 0) {
+    if (worked[slot] == key) return true;
+    slot = (slot + 1) & (WORKED_SLOTS - 1);
+  }
+  if (workedCount >= WORKED_MAX) {
+    Serial.print(millis());
+    Serial.println(" - Conjunto de indicativos cheio; use 'exchange reset'");
+    return false;
+  }
+  worked[slot] = key;
+  workedCount++;
+  return false;
+}
+
+static TokenKind classify(const Extractor& x) {
+  if (x.overflow || x.length == 0) return TOKEN_NONE;
+  if (x.call == CALL_SUFFIX || (x.call == CALL_PORTABLE && x.callPart > 0)) return TOKEN_CALLSIGN;
+  if (x.rst == RST_T) return TOKEN_RST;
+  for (const char* word : WORDS) {
+    if (strcmp(x.token, word) == 0) return TOKEN_WORD;
+  }
+  if (x.digitsOnly && x.length <= 4) return TOKEN_NUMBER;
+  return TOKEN_NONE;
+}
+
+// trailing: a palavra terminou porque chegou outro caractere (trailingRx = direção dele)
+static void finishToken(Extractor& x, bool rx, bool trailing, bool trailingRx) {
+  TokenKind kind = classify(x);
+  if (kind != TOKEN_NONE) {
+    tokenCounts[kind]++;
+    ExchangeToken& token = tokens[tokenSerial % TOKEN_RING];
+    strcpy(token.text, x.token);
+    token.length = x.length;
+    token.kind = kind;
+    token.rx = rx;
+    token.trailing = trailing;
+    token.trailingRx = trailingRx;
+    token.firstAt = x.firstAt;
+    postEvent(BUS_TOKEN, kind, tokenSerial++);
+    unsigned long now = millis();
+    if (kind == TOKEN_CALLSIGN) {
+      strcpy(lastCall, x.token);
+      // Só indicativos recebidos contam como trabalhados: o próprio vai em todo TX
+      uint64_t key = packCall(x.token);
+      bool dup = rx && key != overCall && markWorked(key);
+      if (rx) overCall = key;
+      if (dup) {
+        dupCount++;
+        lastDupAt = now;
+      }
+      Serial.print(now);
+      Serial.print(rx ? " - Indicativo RX: " : " - Indicativo TX: ");
+      Serial.print(x.token);
+      Serial.println(dup ? " (DUP)" : "");
+    } else if (kind == TOKEN_RST) {
+      Serial.print(now);
+      Serial.print(" - Reportagem RST: ");
+      Serial.println(x.token);
+    }
+  }
+  resetExtractor(x);
+}
+
+static void onLetter(const BusEvent& event) {
+  bool rx = event.arg != TX;
+  if (!rx) overCall = 0;  // Câmbio novo a partir do próximo RX
+  Extractor& x = extractors[rx ? 1 : 0];
+  Extractor& other = extractors[rx ? 0 : 1];
+  if (other.length > 0) finishToken(other, !rx, true, rx);  // Troca de direção fecha a palavra do outro lado
+  if (x.length > 0 && event.at - x.lastAt > EXCHANGE_WORD_GAP) finishToken(x, rx, true, rx);
+  if (x.length == 0) x.firstAt = event.at;
+  x.lastAt = event.at;
+  char c = (char)event.value;
+  if (x.length >= EXCHANGE_TOKEN_MAX) {
+    x.overflow = true;
+    return;
+  }
+  x.call = stepCall(x, c);
+  x.rst = stepRst(x.rst, c);
+  x.digitsOnly = x.digitsOnly && c >= '0' && c <= '9';
+  x.token[x.length++] = c;
+  x.token[x.length] = '\0';
+}
+
+void initExchange() {
+  resetExtractor(extractors[0]);
+  resetExtractor(extractors[1]);
+  subscribeEvent(BUS_LETTER, onLetter);
+}
+
+void updateExchange() {
+  unsigned long now = millis();
+  for (uint8_t i = 0; i < 2; i++) {
+    if (extractors[i].length > 0 && now - extractors[i].lastAt > EXCHANGE_WORD_GAP) finishToken(extractors[i], i == 1, false, false);
+  }
+  dupShown = lastDupAt != 0 && now - lastDupAt < DUP_SHOW_TIME;
+}
+
+const ExchangeToken& getExchangeToken(long id) {
+  return tokens[(uint32_t)id % TOKEN_RING];
+}
+
+bool isDupShowing() {
+  return dupShown;
+}
+
+void resetExchange() {
+  memset(worked, 0, sizeof(worked));
+  workedCount = 0;
+  dupCount = 0;
+  Serial.print(millis());
+  Serial.println(" - Conjunto de indicativos trabalhados esvaziado");
+}
+
+void dumpExchange(Print& out) {
+  out.print(millis());
+  out.print(" - Trocas: indicativos ");
+  out.print(tokenCounts[TOKEN_CALLSIGN]);
+  out.print(", RST ");
+  out.print(tokenCounts[TOKEN_RST]);
+  out.print(", números ");
+  out.print(tokenCounts[TOKEN_NUMBER]);
+  out.print(", abreviações ");
+  out.print(tokenCounts[TOKEN_WORD]);
+  out.print("; trabalhados ");
+  out.print(workedCount);
+  out.print("/");
+  out.print(WORKED_MAX);
+  out.print(", DUP ");
+  out.print(dupCount);
+  out.print(", último ");
+  out.println(lastCall[0] != '\0' ? lastCall : "-");
+}
@@ -0,0 +1,33 @@
+#ifndef EXCHANGE_H
+#define EXCHANGE_H
+
+#include <Arduino.h>
+
+#define EXCHANGE_TOKEN_MAX 12  // Caracteres por palavra (o suficiente para "EA8/DL1ABC/P")
+
+enum TokenKind : uint8_t { TOKEN_NONE, TOKEN_CALLSIGN, TOKEN_RST, TOKEN_NUMBER, TOKEN_WORD, TOKEN_KIND_COUNT };
+
+// Palavra reconhecida, publicada em BUS_TOKEN depois dos seus caracteres
+struct ExchangeToken {
+  char text[EXCHANGE_TOKEN_MAX + 1];
+  uint8_t length;
+  TokenKind kind;
+  bool rx;
+  bool trailing;     // Fechada pelo caractere seguinte, que já foi publicado em BUS_LETTER
+  bool trailingRx;   // Direção desse caractere
+  unsigned long firstAt;  // Chegada do primeiro caractere
+};
+
+void initExchange(); // Assina os caracteres decodificados (barramento de eventos)
+
+void updateExchange(); // Fecha a palavra de cada direção após EXCHANGE_WORD_GAP sem caracteres
+
+const ExchangeToken& getExchangeToken(long id); // Palavra de um evento BUS_TOKEN (válida pelas 4 palavras seguintes)
+
+bool isDupShowing(); // Indicativo recebido repetido nos últimos segundos (indicador "DUP" no display)
+
+void resetExchange(); // Esvazia o conjunto de indicativos trabalhados
+
+void dumpExchange(Print& out); // Contadores por tipo, ocupação do conjunto e último indicativo
+
+#endif
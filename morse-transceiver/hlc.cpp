@@ -0,0 +1,102 @@
+#include "hlc.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// l segue millis() + offset e dá a volta em 2^32 ms (~49,7 dias): compara pela diferença
+static bool later(uint32_t a, uint32_t b) {
+  return (int32_t)(a - b) > 0;
+}
+
+void hlcBegin(HlcClock& clock, uint16_t node, uint32_t ms) {
+  memset(&clock, 0, sizeof(clock));
+  clock.last.l = ms;  // Não 0: perto da volta de millis() o 0 estaria "no futuro"
+  clock.last.node = node;
+}
+
+uint32_t hlcPhysical(const HlcClock& clock, uint32_t ms) {
+  return ms + clock.offset;
+}
+
+Hlc hlcTick(HlcClock& clock, uint32_t ms) {
+  uint32_t physical = hlcPhysical(clock, ms);
+  if (later(physical, clock.last.l)) {
+    clock.last.l = physical;
+    clock.last.c = 0;
+  } else {
+    clock.last.c++;
+  }
+  return clock.last;
+}
+
+Hlc hlcReceive(HlcClock& clock, const Hlc& remote, uint32_t ms) {
+  uint32_t physical = hlcPhysical(clock, ms);
+  if (later(remote.l, physical)) {  // Remetente à frente: avança o tempo físico em vez de acumular em c
+    clock.offset += remote.l - physical;
+    clock.jumps++;
+    physical = remote.l;
+  }
+  uint32_t l = later(clock.last.l, remote.l) ? clock.last.l : remote.l;
+  if (later(physical, l)) {
+    clock.last.l = physical;
+    clock.last.c = 0;
+  } else if (l == clock.last.l && l == remote.l) {
+    clock.last.c = (clock.last.c > remote.c ? clock.last.c : remote.c) + 1;
+  } else if (l == clock.last.l) {
+    clock.last.c++;
+  } else {
+    clock.last.l = l;
+    clock.last.c = remote.c + 1;
+  }
+  return clock.last;
+}
+
+uint64_t hlcPack(const Hlc& stamp) {
+  return (uint64_t)stamp.l << 32 | (uint32_t)stamp.c << 16 | stamp.node;
+}
+
+bool hlcBefore(uint64_t a, uint64_t b) {
+  uint32_t la = (uint32_t)(a >> 32);
+  uint32_t lb = (uint32_t)(b >> 32);
+  if (la != lb) return later(lb, la);
+  return (uint32_t)a < (uint32_t)b;
+}
+
+Hlc hlcUnpack(uint64_t packed) {
+  Hlc stamp;
+  stamp.l = (uint32_t)(packed >> 32);
+  stamp.c = (uint16_t)(packed >> 16);
+  stamp.node = (uint16_t)packed;
+  return stamp;
+}
+
+size_t hlcFormat(const Hlc& stamp, char* out, size_t size) {
+  int n = snprintf(out, size, "@%lu.%u.%u", (unsigned long)stamp.l, (unsigned)stamp.c, (unsigned)stamp.node);
+  if (n < 0 || (size_t)n >= size) {
+    if (size > 0) out[0] = '\0';
+    return 0;
+  }
+  return (size_t)n;
+}
+
+// Campo decimal terminado por stop; false se vazio ou acima de max
+static bool parseField(const char*& p, char stop, unsigned long max, unsigned long& value) {
+  char* end;
+  if (*p < '0' || *p > '9') return false;
+  value = strtoul(p, &end, 10);
+  if (*end != stop || value > max) return false;
+  p = (stop == '\0') ? end : end + 1;
+  return true;
+}
+
+bool hlcParse(const char* line, Hlc& stamp) {
+  const char* p = strchr(line, '@');
+  if (p == nullptr) return false;
+  p++;
+  unsigned long l, c, node;
+  if (!parseField(p, '.', 0xFFFFFFFFUL, l) || !parseField(p, '.', 0xFFFF, c) || !parseField(p, '\0', 0xFFFF, node)) return false;
+  stamp.l = (uint32_t)l;
+  stamp.c = (uint16_t)c;
+  stamp.node = (uint16_t)node;
+  return true;
+}
@@ -0,0 +1,55 @@
+#ifndef HLC_H
+#define HLC_H
+
+// Relógio lógico híbrido (HLC) de cada unidade. Sem dependência do Arduino: o
+// firmware carimba elementos e caracteres e as ferramentas no PC ordenam gravações.
+//
+// Carimbo = (l, c, node): l acompanha o tempo físico em ms, c desempata eventos
+// no mesmo l e node (bits baixos do MAC) desempata unidades. hlcBefore() dá a
+// ordem total sobre hlcPack(); l dá a volta junto com millis() (~49,7 dias) e é
+// comparado pela diferença com sinal.
+//
+// O tempo físico é millis() + offset, e o offset só avança: ao receber um l maior
+// que o próprio relógio a unidade salta para ele, então unidades ligadas em horas
+// diferentes convergem para o mesmo l e c fica pequeno.
+//
+// No protocolo o carimbo vai como sufixo "@l.c.node", por exemplo
+// "duration:120@53211.0.4660"; quem não conhece o sufixo para de ler o número no
+// '@' e ignora o resto.
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define HLC_TEXT_MAX 24  // "@4294967295.65535.65535" + '\0'
+
+struct Hlc {
+  uint32_t l;     // Tempo lógico (ms)
+  uint16_t c;     // Contador dentro do mesmo l
+  uint16_t node;  // Unidade que gerou o evento
+};
+
+struct HlcClock {
+  Hlc last;         // Último carimbo emitido ou absorvido
+  uint32_t offset;  // Somado a millis(): só cresce
+  uint32_t jumps;   // Saltos do tempo físico para alcançar um remetente
+};
+
+void hlcBegin(HlcClock& clock, uint16_t node, uint32_t ms); // Zera o relógio da unidade node em millis() = ms
+
+uint32_t hlcPhysical(const HlcClock& clock, uint32_t ms); // millis() no tempo da rede
+
+Hlc hlcTick(HlcClock& clock, uint32_t ms); // Evento local (elemento da chave, envio)
+
+Hlc hlcReceive(HlcClock& clock, const Hlc& remote, uint32_t ms); // Absorve carimbo recebido; devolve o do recebimento
+
+uint64_t hlcPack(const Hlc& stamp); // l << 32 | c << 16 | node: ordena como (l, c, node)
+
+bool hlcBefore(uint64_t a, uint64_t b); // a antes de b (l em janela de 2^31 ms, depois c e node)
+
+Hlc hlcUnpack(uint64_t packed);
+
+size_t hlcFormat(const Hlc& stamp, char* out, size_t size); // Sufixo "@l.c.node"; 0 se não couber
+
+bool hlcParse(const char* line, Hlc& stamp); // Lê o sufixo após o primeiro '@' da linha; false se ausente/inválido
+
+#endif
@@ -0,0 +1,91 @@
+#include "key-timing.h"
+
+#define KEY_TIMING_BUCKETS 16  // Histograma log2: faixa [2^i, 2^(i+1)) ciclos
+
+struct KeyStats {
+  uint32_t count;
+  uint32_t min;
+  uint32_t max;
+  uint64_t sum;
+  uint64_t sumSq;
+  uint32_t buckets[KEY_TIMING_BUCKETS];
+};
+
+static const char* const probeNames[KEY_PROBE_COUNT] = { "sample", "decode" };
+
+#if KEY_TIMING_ENABLED
+static KeyStats stats[KEY_PROBE_COUNT];
+#endif
+
+void KEY_IRAM recordKeyTiming(KeyProbe probe, uint32_t cycles) {  // Chamada a cada amostra: também na IRAM
+#if KEY_TIMING_ENABLED
+  KeyStats& s = stats[probe];
+  if (s.count == 0 || cycles < s.min) s.min = cycles;
+  if (cycles > s.max) s.max = cycles;
+  s.count++;
+  s.sum += cycles;
+  s.sumSq += (uint64_t)cycles * cycles;
+  uint8_t bucket = 0;
+  while (bucket < KEY_TIMING_BUCKETS - 1 && (cycles >> (bucket + 1)) != 0) bucket++;
+  s.buckets[bucket]++;
+#else
+  (void)probe;
+  (void)cycles;
+#endif
+}
+
+void resetKeyTiming() {
+#if KEY_TIMING_ENABLED
+  memset(stats, 0, sizeof(stats));
+#endif
+}
+
+void dumpKeyTiming(Print& out) {
+#if KEY_TIMING_ENABLED
+  unsigned long now = millis();
+  uint32_t mhz = ESP.getCpuFreqMHz();
+  out.print(now);
+  out.print(" - Tempo do caminho da tecla (KEY_PATH_IRAM = ");
+  out.print(KEY_PATH_IRAM);
+  out.print(", ");
+  out.print(mhz);
+  out.println(" MHz)");
+  for (uint8_t p = 0; p < KEY_PROBE_COUNT; p++) {
+    KeyStats& s = stats[p];
+    // Lentas: faixas inteiras acima de 2x o mínimo (recarga do cache da flash ou interrupção)
+    uint32_t slow = 0;
+    for (uint8_t b = 0; b < KEY_TIMING_BUCKETS; b++) {
+      if ((1UL << b) > 2 * s.min) slow += s.buckets[b];
+    }
+    double mean = s.count ? (double)s.sum / s.count : 0;
+    double variance = s.count ? (double)s.sumSq / s.count - mean * mean : 0;
+    out.print("keytiming:");
+    out.print(probeNames[p]);
+    out.print(" n=");
+    out.print(s.count);
+    out.print(" media=");
+    out.print(mean, 1);
+    out.print(" desvio=");
+    out.print(variance > 0 ? sqrt(variance) : 0, 1);
+    out.print(" min=");
+    out.print(s.min);
+    out.print(" max=");
+    out.print(s.max);
+    out.print(" ciclos, max=");
+    out.print(mhz ? s.max / mhz : 0);
+    out.print(" us, lentas=");
+    out.println(slow);
+    for (uint8_t b = 0; b < KEY_TIMING_BUCKETS; b++) {
+      if (s.buckets[b] == 0) continue;
+      out.print("keytiming:");
+      out.print(probeNames[p]);
+      out.print(" >=");
+      out.print(1UL << b);
+      out.print(" ");
+      out.println(s.buckets[b]);
+    }
+  }
+#else
+  out.println("Medição desabilitada (KEY_TIMING_ENABLED = 0)");
+#endif
+}
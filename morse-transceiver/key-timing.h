@@ -0,0 +1,23 @@
+#ifndef KEY_TIMING_H
+#define KEY_TIMING_H
+
+#include <Arduino.h>
+
+#define KEY_PATH_IRAM 1       // 1 = amostragem da tecla e passo do decodificador na IRAM (fora do cache da flash)
+#define KEY_TIMING_ENABLED 1  // 1 = mede ciclos do caminho da tecla (comando "keytiming")
+
+#if KEY_PATH_IRAM && defined(ARDUINO_ARCH_ESP8266)
+#define KEY_IRAM IRAM_ATTR
+#else
+#define KEY_IRAM
+#endif
+
+enum KeyProbe { KEY_PROBE_SAMPLE, KEY_PROBE_DECODE, KEY_PROBE_COUNT };
+
+void recordKeyTiming(KeyProbe probe, uint32_t cycles); // Amostra em ciclos de CPU (ESP.getCycleCount())
+
+void resetKeyTiming(); // Zera as estatísticas (para comparar antes/depois)
+
+void dumpKeyTiming(Print& out); // Média, desvio, mín/máx e histograma log2 de cada sonda
+
+#endif
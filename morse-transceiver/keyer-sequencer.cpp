@@ -0,0 +1,123 @@
+#include "keyer-sequencer.h"
+#include <string.h>
+#if defined(ARDUINO)
+#include <Arduino.h>  // IRAM_ATTR: keyerInput e keyerRun rodam dentro de ISRs
+#define KEYER_IRAM IRAM_ATTR
+#else
+#define KEYER_IRAM
+#endif
+
+// Diferença com sinal: funciona através da volta do contador de 32 bits (~71 min em µs)
+static inline bool reached(uint32_t now, uint32_t at) {
+  return (int32_t)(now - at) >= 0;
+}
+
+static inline uint32_t pttHold(const KeyerConfig& config) {
+  return config.hangUs > config.tailUs ? config.hangUs : config.tailUs;
+}
+
+void keyerBegin(KeyerSequencer& keyer, const KeyerConfig& config) {
+  memset(&keyer, 0, sizeof(keyer));
+  keyer.config = config;
+}
+
+static bool KEYER_IRAM schedule(KeyerSequencer& keyer, uint32_t at, bool down) {
+  if ((uint8_t)(keyer.head - keyer.tail) >= KEYER_QUEUE) {
+    keyer.dropped++;
+    return false;
+  }
+  keyer.queue[keyer.head % KEYER_QUEUE] = { at, down };
+  keyer.head++;
+  return true;
+}
+
+bool KEYER_IRAM keyerInput(KeyerSequencer& keyer, bool down, uint32_t nowUs) {
+  if (down == keyer.inputDown) return false;
+  if (nowUs - keyer.inputAt < keyer.config.debounceUs) return false;
+  uint32_t at = nowUs + keyer.config.leadUs;
+  if (!schedule(keyer, at, down)) return false;
+  keyer.inputDown = down;
+  keyer.inputAt = nowUs;
+  keyer.settlePending = true;  // A borda oposta dentro da janela é descartada: confere o nível no fim dela
+  keyer.settleAt = nowUs + keyer.config.debounceUs;
+  if (down) {
+    keyer.pttOffPending = false;  // Elemento dentro do hang: PTT continua
+    if (!(keyer.outputs & KEYER_OUT_PTT)) {
+      keyer.outputs |= KEYER_OUT_PTT;
+      keyer.pttOnAt = nowUs;
+    }
+  }
+  return true;
+}
+
+// Toque mais curto que o repique: a subida caiu na janela e foi descartada; sem
+// conferir o nível a chave ficaria em baixo até o limite de chave presa
+bool KEYER_IRAM keyerSettle(KeyerSequencer& keyer, bool down, uint32_t nowUs) {
+  if (!keyer.settlePending || !reached(nowUs, keyer.settleAt)) return false;
+  keyer.settlePending = false;
+  return keyerInput(keyer, down, nowUs);  // Nível igual ao aceito: nada a fazer
+}
+
+uint32_t KEYER_IRAM keyerRun(KeyerSequencer& keyer, uint32_t nowUs) {
+  while (keyer.tail != keyer.head) {
+    const KeyerEdge& edge = keyer.queue[keyer.tail % KEYER_QUEUE];
+    if (!reached(nowUs, edge.at)) break;
+    if (edge.down) {
+      // Só chaveia com PTT estabelecido; a fila atrasada garante isso, o teste protege
+      if ((keyer.outputs & KEYER_OUT_PTT) && reached(nowUs, keyer.pttOnAt + keyer.config.leadUs)) {
+        keyer.outputs |= KEYER_OUT_KEY;
+        keyer.keyDownAt = nowUs;
+      } else {
+        keyer.dropped++;
+      }
+    } else if (keyer.outputs & KEYER_OUT_KEY) {
+      keyer.outputs &= ~KEYER_OUT_KEY;
+      keyer.keyUpAt = nowUs;
+      if (keyer.tail + 1 == keyer.head && !keyer.inputDown) {
+        // Conta do instante agendado; se a ISR atrasou, tailUs vale a partir da subida real
+        uint32_t offAt = edge.at + pttHold(keyer.config);
+        keyer.pttOffPending = true;
+        keyer.pttOffAt = reached(offAt, nowUs + keyer.config.tailUs) ? offAt : nowUs + keyer.config.tailUs;
+      }
+    }
+    keyer.tail++;
+  }
+  if ((keyer.outputs & KEYER_OUT_KEY) && reached(nowUs, keyer.keyDownAt + keyer.config.maxDownUs)) {
+    // Chave presa: sobe a saída e descarta a fila; a entrada segue "descida" até soltar de fato,
+    // então o repique da soltura não vira um novo elemento
+    keyer.outputs &= ~KEYER_OUT_KEY;
+    keyer.keyUpAt = nowUs;
+    keyer.tail = keyer.head;
+    keyer.pttOffPending = true;
+    keyer.pttOffAt = nowUs + keyer.config.tailUs;
+    keyer.dropped++;
+  }
+  if (keyer.pttOffPending && !(keyer.outputs & KEYER_OUT_KEY) && keyer.tail == keyer.head &&
+      reached(nowUs, keyer.pttOffAt)) {
+    keyer.outputs &= ~KEYER_OUT_PTT;
+    keyer.pttOffPending = false;
+  }
+
+  // Próxima ação: borda da fila, queda do PTT ou limite de chave presa
+  uint32_t next = 0;
+  bool any = false;
+  if (keyer.tail != keyer.head) {
+    next = keyer.queue[keyer.tail % KEYER_QUEUE].at - nowUs;
+    any = true;
+  } else if (keyer.pttOffPending) {
+    next = keyer.pttOffAt - nowUs;
+    any = true;
+  }
+  if (keyer.settlePending) {
+    uint32_t settle = reached(nowUs, keyer.settleAt) ? 0 : keyer.settleAt - nowUs;
+    if (!any || settle < next) next = settle;
+    any = true;
+  }
+  if (keyer.outputs & KEYER_OUT_KEY) {
+    uint32_t stuck = keyer.keyDownAt + keyer.config.maxDownUs - nowUs;
+    if (!any || stuck < next) next = stuck;
+    any = true;
+  }
+  if (!any) return 0;
+  return next > 0 ? next : 1;
+}
@@ -0,0 +1,59 @@
+#ifndef KEYER_SEQUENCER_H
+#define KEYER_SEQUENCER_H
+
+// Sequenciamento de PTT e chaveamento do transmissor. Sem dependência do Arduino:
+// o firmware chama de ISRs (borda da chave, timer1) e o PC roda em tempo simulado.
+//
+// Toda a chave é atrasada de leadUs: o PTT sobe na borda de descida da chave e o
+// transmissor só é chaveado leadUs depois, então o primeiro elemento não é cortado
+// e cada elemento mantém a duração exata. O PTT cai hangUs (no mínimo tailUs) após
+// a última subida atrasada; um novo elemento dentro desse tempo cancela a queda.
+// Invariantes (QSK): chave só com PTT há leadUs; PTT nunca cai com a chave em baixo
+// nem antes de tailUs da subida.
+
+#include <stdint.h>
+
+#define KEYER_QUEUE 16  // Bordas agendadas (potência de 2)
+
+enum KeyerOutput : uint8_t { KEYER_OUT_KEY = 1, KEYER_OUT_PTT = 2 };
+
+struct KeyerConfig {
+  uint32_t leadUs;      // PTT -> primeira chave (comutação T/R do rádio)
+  uint32_t hangUs;      // PTT mantido após a última subida, esperando mais elementos
+  uint32_t tailUs;      // Mínimo entre subida da chave e queda do PTT (decaimento do RF)
+  uint32_t debounceUs;  // Bordas da chave mais próximas que isto são repique
+  uint32_t maxDownUs;   // Chave presa: força a subida (proteção do transmissor)
+};
+
+struct KeyerEdge {
+  uint32_t at;
+  bool down;
+};
+
+struct KeyerSequencer {
+  KeyerConfig config;
+  KeyerEdge queue[KEYER_QUEUE];
+  uint8_t head;
+  uint8_t tail;
+  bool inputDown;        // Último nível aceito da chave
+  uint32_t inputAt;      // Instante dessa borda
+  bool settlePending;    // Nível real a conferir quando o repique acabar
+  uint32_t settleAt;     // inputAt + debounceUs
+  uint8_t outputs;       // KeyerOutput atuais
+  uint32_t pttOnAt;
+  uint32_t keyDownAt;
+  uint32_t keyUpAt;
+  bool pttOffPending;
+  uint32_t pttOffAt;
+  uint32_t dropped;      // Bordas descartadas (fila cheia) ou forçadas (chave presa)
+};
+
+void keyerBegin(KeyerSequencer& keyer, const KeyerConfig& config); // Zera estado; saídas em repouso
+
+bool keyerInput(KeyerSequencer& keyer, bool down, uint32_t nowUs); // Borda da chave; false se ignorada (repique/nível igual)
+
+bool keyerSettle(KeyerSequencer& keyer, bool down, uint32_t nowUs); // Fim do repique: nível real do pino; agenda a borda perdida na janela (true se agendou)
+
+uint32_t keyerRun(KeyerSequencer& keyer, uint32_t nowUs); // Aplica o que venceu; devolve µs até a próxima ação (0 = nada agendado)
+
+#endif
@@ -0,0 +1,115 @@
+#include "keyer.h"
+#include "keyer-sequencer.h"
+#include "scrollback.h"
+#include "cw-transceiver.h"  // LOCAL_PIN: nível real no fim do repique
+
+#define TIMER1_TICKS_PER_US 5        // 80 MHz / TIM_DIV16
+#define TIMER1_MAX_TICKS 8388607UL   // Contador de 23 bits (~1,67 s); esperas maiores são reprogramadas
+
+#if KEYER_ENABLED
+static KeyerSequencer keyer;
+static volatile bool inhibited = false;  // Rolagem ativa: a chave pagina o histórico, não transmite
+
+static void IRAM_ATTR writeOutputs() {
+  digitalWrite(KEYER_PIN, (keyer.outputs & KEYER_OUT_KEY) ? HIGH : LOW);
+  digitalWrite(PTT_PIN, (keyer.outputs & KEYER_OUT_PTT) ? HIGH : LOW);
+}
+
+// Roda o sequenciador e rearma o one-shot para a próxima ação agendada
+static void IRAM_ATTR runAndArm() {
+  uint32_t now = micros();
+  // Fim da janela de repique: a borda descartada nela (toque curto) é agendada agora.
+  // Com a rolagem ativa nenhuma descida nova é aceita, como em keyerKeyEdge()
+  bool down = digitalRead(LOCAL_PIN) == LOW;
+  keyerSettle(keyer, down && (!inhibited || keyer.inputDown), now);
+  uint32_t wait = keyerRun(keyer, now);
+  writeOutputs();
+  if (wait == 0) return;  // Nada agendado: o timer fica parado até a próxima borda da chave
+  timer1_write(wait > TIMER1_MAX_TICKS / TIMER1_TICKS_PER_US ? TIMER1_MAX_TICKS : wait * TIMER1_TICKS_PER_US);
+}
+
+static void IRAM_ATTR onTimer() {
+  runAndArm();
+}
+#endif
+
+// Mesma borda (micros) que mede a duração na ISR da chave: o transmissor repete o
+// elemento com a duração exata, só atrasado de KEYER_LEAD_MS
+void IRAM_ATTR keyerKeyEdge(bool down) {
+#if KEYER_ENABLED
+  if (down && inhibited) return;
+  if (keyerInput(keyer, down, micros())) runAndArm();
+#else
+  (void)down;
+#endif
+}
+
+void initKeyer() {
+#if KEYER_ENABLED
+  KeyerConfig config = { KEYER_LEAD_MS * 1000UL, KEYER_HANG_MS * 1000UL, KEYER_TAIL_MS * 1000UL,
+                         KEYER_DEBOUNCE_MS * 1000UL, KEYER_MAX_DOWN_MS * 1000UL };
+  keyerBegin(keyer, config);
+  pinMode(KEYER_PIN, OUTPUT);
+  pinMode(PTT_PIN, OUTPUT);
+  writeOutputs();
+  timer1_attachInterrupt(onTimer);
+  timer1_enable(TIM_DIV16, TIM_EDGE, TIM_SINGLE);
+  Serial.print(millis());
+  Serial.println(" - Keyer inicializado (KEY D7, PTT D0)");
+#endif
+}
+
+void updateKeyer() {
+#if KEYER_ENABLED
+  inhibited = isScrollbackActive();
+#endif
+}
+
+void setKeyer(uint16_t leadMs, uint16_t hangMs) {
+#if KEYER_ENABLED
+  noInterrupts();  // A configuração é lida pelas duas ISRs
+  keyer.config.leadUs = leadMs * 1000UL;
+  keyer.config.hangUs = hangMs * 1000UL;
+  interrupts();
+  Serial.print(millis());
+  Serial.print(" - Keyer: lead ");
+  Serial.print(leadMs);
+  Serial.print(" ms, hang ");
+  Serial.print(hangMs);
+  Serial.println(" ms");
+#else
+  (void)leadMs;
+  (void)hangMs;
+#endif
+}
+
+void dumpKeyer(Print& out) {
+#if KEYER_ENABLED
+  noInterrupts();
+  KeyerConfig config = keyer.config;
+  uint8_t outputs = keyer.outputs;
+  uint8_t queued = keyer.head - keyer.tail;
+  uint32_t dropped = keyer.dropped;
+  interrupts();
+  out.print("Keyer: lead ");
+  out.print(config.leadUs / 1000);
+  out.print(" ms, hang ");
+  out.print(config.hangUs / 1000);
+  out.print(" ms, tail ");
+  out.print(config.tailUs / 1000);
+  out.print(" ms, chave presa ");
+  out.print(config.maxDownUs / 1000);
+  out.println(" ms");
+  out.print("KEY ");
+  out.print((outputs & KEYER_OUT_KEY) ? "on" : "off");
+  out.print(", PTT ");
+  out.print((outputs & KEYER_OUT_PTT) ? "on" : "off");
+  out.print(", fila ");
+  out.print(queued);
+  out.print(", descartadas ");
+  out.print(dropped);
+  out.println(inhibited ? " (inibido: rolagem)" : "");
+#else
+  out.println("Keyer desabilitado (KEYER_ENABLED = 0)");
+#endif
+}
@@ -0,0 +1,25 @@
+#ifndef KEYER_H
+#define KEYER_H
+
+#include <Arduino.h>
+
+#define KEYER_ENABLED 0        // 1 = chave local também chaveia um transmissor (saídas KEY e PTT)
+#define KEYER_PIN D7           // Saída da chave do transmissor (ativa em HIGH, via transistor/opto)
+#define PTT_PIN D0             // Saída do PTT (ativa em HIGH)
+#define KEYER_LEAD_MS 15       // PTT -> primeira chave (comutação T/R do rádio/amplificador)
+#define KEYER_HANG_MS 400      // PTT mantido após o último elemento (semi break-in)
+#define KEYER_TAIL_MS 8        // Mínimo entre a subida da chave e a queda do PTT
+#define KEYER_DEBOUNCE_MS 5    // Repique do contato da chave
+#define KEYER_MAX_DOWN_MS 1000 // Chave presa (ou pressão longa de comando): sobe a saída
+
+void initKeyer(); // Configura pinos e o timer1 (one-shot) do sequenciamento
+
+void keyerKeyEdge(bool down); // Chamada da ISR da chave local, com o nível já lido
+
+void updateKeyer(); // Inibe a saída durante a rolagem do histórico
+
+void setKeyer(uint16_t leadMs, uint16_t hangMs); // Ajuste de lead-in e hang em tempo de execução
+
+void dumpKeyer(Print& out); // Configuração, estado das saídas e bordas descartadas
+
+#endif
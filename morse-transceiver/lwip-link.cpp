@@ -0,0 +1,229 @@
+#include "lwip-link.h"
+
+#if NET_RAW_LWIP
+#include <lwip/tcp.h>
+
+// Os callbacks do lwIP rodam no contexto do SDK, entre passagens do loop (nunca o
+// interrompem), então a fila e a cadeia de pbufs não precisam de trava.
+
+#define RAW_QUEUE_SIZE 16  // Mensagens analisadas aguardando o loop (potência de 2)
+
+static tcp_pcb* listenPcb = nullptr;
+static tcp_pcb* pcb = nullptr;
+static bool accepted = false;
+static NetMessage queue[RAW_QUEUE_SIZE];
+static uint8_t queueHead = 0;  // Próxima a entregar
+static uint8_t queueTail = 0;  // Slot onde a linha atual está sendo montada
+static uint8_t lineLength = 0;
+static bool lineOverflow = false;  // Linha longa demais: descarta até o próximo '\n'
+static pbuf* held = nullptr;  // Cadeia recebida ainda não analisada (fila cheia)
+static uint16_t heldOffset = 0;  // Posição no primeiro pbuf da cadeia
+
+static void resetReceive() {
+  if (held != nullptr) pbuf_free(held);
+  held = nullptr;
+  heldOffset = 0;
+  queueHead = queueTail = 0;
+  lineLength = 0;
+  lineOverflow = false;
+}
+
+// Analisa a cadeia no lugar, direto para os slots da fila; para quando ela enche
+static void parseHeld() {
+  while (held != nullptr && (uint8_t)(queueTail - queueHead) < RAW_QUEUE_SIZE) {
+    if (heldOffset >= held->len) {
+      // Segmento consumido: libera e abre a janela TCP
+      pbuf* next = held->next;
+      uint16_t length = held->len;
+      if (next != nullptr) pbuf_ref(next);
+      pbuf_free(held);
+      held = next;
+      heldOffset = 0;
+      if (pcb != nullptr) tcp_recved(pcb, length);
+      continue;
+    }
+    NetMessage& msg = queue[queueTail % RAW_QUEUE_SIZE];
+    const char* data = static_cast<const char*>(held->payload);
+    while (heldOffset < held->len) {
+      char c = data[heldOffset++];
+      if (c == '\n') {
+        if (!lineOverflow) {
+          msg.length = lineLength;
+          parseNetMessage(msg);
+          queueTail++;
+        }
+        lineLength = 0;
+        lineOverflow = false;
+        break;  // Próxima linha vai para o próximo slot, se houver
+      } else if (lineLength < NET_MESSAGE_MAX - 1) {
+        msg.text[lineLength++] = c;
+      } else {
+        lineOverflow = true;
+      }
+    }
+  }
+}
+
+static void detach(tcp_pcb* p) {
+  tcp_arg(p, nullptr);
+  tcp_recv(p, nullptr);
+  tcp_err(p, nullptr);
+}
+
+// Solta o pcb; ERR_ABRT se foi preciso abortar (o callback deve repassar)
+static err_t releasePcb() {
+  err_t result = ERR_OK;
+  if (pcb != nullptr) {
+    detach(pcb);
+    if (tcp_close(pcb) != ERR_OK) {
+      tcp_abort(pcb);
+      result = ERR_ABRT;
+    }
+    pcb = nullptr;
+  }
+  return result;
+}
+
+static err_t closePcb() {
+  err_t result = releasePcb();
+  resetReceive();
+  return result;
+}
+
+static err_t onRecv(void*, tcp_pcb*, pbuf* p, err_t) {
+  // Peer fechou (FIN): as linhas completas já recebidas ainda vão para o loop, como no WiFiClient
+  if (p == nullptr) return releasePcb();
+  if (held == nullptr) {
+    held = p;
+    heldOffset = 0;
+  } else {
+    pbuf_cat(held, p);
+  }
+  parseHeld();
+  return ERR_OK;
+}
+
+static void onError(void*, err_t) {
+  pcb = nullptr;  // O lwIP já liberou o pcb
+  resetReceive();
+}
+
+static void attach(tcp_pcb* p) {
+  resetReceive();
+  pcb = p;
+  tcp_arg(p, nullptr);
+  tcp_recv(p, onRecv);
+  tcp_err(p, onError);
+  tcp_nagle_disable(p);  // Cada "duration:" sai na hora
+}
+
+static err_t onConnected(void*, tcp_pcb*, err_t) {
+  return ERR_OK;  // Escritas feitas em SYN_SENT já estão na fila do lwIP
+}
+
+static err_t onAccept(void*, tcp_pcb* newPcb, err_t err) {
+  if (err != ERR_OK || newPcb == nullptr) return ERR_VAL;
+  if (pcb != nullptr) {
+    tcp_abort(newPcb);  // Um peer por vez, como no WiFiServer
+    return ERR_ABRT;
+  }
+  attach(newPcb);
+  accepted = true;
+  return ERR_OK;
+}
+
+bool rawLinkListen(uint16_t port) {
+  if (listenPcb != nullptr) return true;
+  tcp_pcb* p = tcp_new();
+  if (p == nullptr) return false;
+  if (tcp_bind(p, IP_ADDR_ANY, port) != ERR_OK) {
+    tcp_close(p);
+    return false;
+  }
+  listenPcb = tcp_listen(p);
+  if (listenPcb == nullptr) {
+    tcp_close(p);
+    return false;
+  }
+  tcp_accept(listenPcb, onAccept);
+  return true;
+}
+
+bool rawLinkConnect(const IPAddress& ip, uint16_t port) {
+  closePcb();
+  tcp_pcb* p = tcp_new();
+  if (p == nullptr) return false;
+  ip_addr_t addr;
+  IP_ADDR4(&addr, ip[0], ip[1], ip[2], ip[3]);
+  attach(p);
+  if (tcp_connect(p, &addr, port, onConnected) != ERR_OK) {
+    detach(p);
+    tcp_abort(p);
+    pcb = nullptr;
+    return false;
+  }
+  return true;
+}
+
+bool rawLinkConnected() {
+  return pcb != nullptr || rawLinkPending();
+}
+
+bool rawLinkAccepted() {
+  bool result = accepted;
+  accepted = false;
+  return result;
+}
+
+void rawLinkClose() {
+  closePcb();
+}
+
+bool rawLinkSend(const char* line) {
+  if (pcb == nullptr) return false;
+  // Linha e '\n' numa escrita só: duas podiam falhar entre si (fila de segmentos cheia)
+  // e deixar a linha enfileirada sem terminador, colada no quadro seguinte
+  char out[NET_MESSAGE_MAX + 1];
+  int length = snprintf(out, sizeof(out), "%s\n", line);
+  if (length < 0 || (size_t)length >= sizeof(out)) return false;
+  if (tcp_sndbuf(pcb) < (size_t)length) return false;
+  if (tcp_write(pcb, out, length, TCP_WRITE_FLAG_COPY) != ERR_OK) return false;
+  tcp_output(pcb);
+  return true;
+}
+
+const NetMessage* rawLinkFront() {
+  if (queueHead == queueTail) parseHeld();
+  return (queueHead != queueTail) ? &queue[queueHead % RAW_QUEUE_SIZE] : nullptr;
+}
+
+void rawLinkPop() {
+  if (queueHead == queueTail) return;
+  queueHead++;
+  parseHeld();  // Slot liberado: continua a cadeia retida
+}
+
+bool rawLinkPending() {
+  return queueHead != queueTail || held != nullptr;
+}
+
+size_t rawLinkBacklog() {
+  size_t bytes = (held != nullptr) ? held->tot_len - heldOffset : 0;
+  for (uint8_t i = queueHead; i != queueTail; i++) bytes += queue[i % RAW_QUEUE_SIZE].length + 1;
+  return bytes;
+}
+
+#else
+
+bool rawLinkListen(uint16_t) { return false; }
+bool rawLinkConnect(const IPAddress&, uint16_t) { return false; }
+bool rawLinkConnected() { return false; }
+bool rawLinkAccepted() { return false; }
+void rawLinkClose() { }
+bool rawLinkSend(const char*) { return false; }
+const NetMessage* rawLinkFront() { return nullptr; }
+void rawLinkPop() { }
+bool rawLinkPending() { return false; }
+size_t rawLinkBacklog() { return 0; }
+
+#endif
@@ -0,0 +1,32 @@
+#ifndef LWIP_LINK_H
+#define LWIP_LINK_H
+
+#include <Arduino.h>
+#include <ESP8266WiFi.h>  // IPAddress
+#include "net-message.h"
+
+#ifndef NET_RAW_LWIP
+#define NET_RAW_LWIP 0  // 1 = porta 5000 pelos callbacks do lwIP (sem WiFiClient); 0 = WiFiClient/WiFiServer
+#endif
+
+bool rawLinkListen(uint16_t port); // AP: aceita um cliente por vez
+
+bool rawLinkConnect(const IPAddress& ip, uint16_t port); // STA: conexão assíncrona
+
+bool rawLinkConnected(); // Conectado, conectando ou com linhas do peer que fechou ainda por entregar
+
+bool rawLinkAccepted(); // true uma vez para cada cliente aceito (AP)
+
+void rawLinkClose();
+
+bool rawLinkSend(const char* line); // Envia linha + '\n'; false se o buffer de envio estiver cheio
+
+const NetMessage* rawLinkFront(); // Próxima mensagem recebida; nullptr se nenhuma
+
+void rawLinkPop(); // Descarta a mensagem de rawLinkFront()
+
+bool rawLinkPending(); // Há mensagens ou bytes recebidos ainda não entregues
+
+size_t rawLinkBacklog(); // Bytes recebidos ainda não entregues ao loop
+
+#endif
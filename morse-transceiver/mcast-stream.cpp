@@ -0,0 +1,242 @@
+#include "mcast-stream.h"
+#include <string.h>
+
+#define MCAST_RESYNC (MCAST_HISTORY * 4)  // Salto maior que isto = transmissor reiniciou: novo fluxo
+
+// Diferença com sinal: sequências e ms funcionam através da volta dos 32 bits
+static inline int32_t ahead(uint32_t a, uint32_t b) {
+  return (int32_t)(a - b);
+}
+
+static void put16(uint8_t* p, uint16_t v) {
+  p[0] = (uint8_t)v;
+  p[1] = (uint8_t)(v >> 8);
+}
+
+static void put32(uint8_t* p, uint32_t v) {
+  put16(p, (uint16_t)v);
+  put16(p + 2, (uint16_t)(v >> 16));
+}
+
+static uint16_t get16(const uint8_t* p) {
+  return (uint16_t)(p[0] | p[1] << 8);
+}
+
+static uint32_t get32(const uint8_t* p) {
+  return get16(p) | (uint32_t)get16(p + 2) << 16;
+}
+
+static size_t packetLength(McastType type) {
+  switch (type) {
+    case MCAST_DATA:
+    case MCAST_REPAIR: return 19;
+    case MCAST_HEARTBEAT: return 9;
+    case MCAST_NACK: return 12;
+  }
+  return 0;
+}
+
+size_t mcastEncode(const McastPacket& packet, uint8_t* out, size_t size) {
+  size_t length = packetLength(packet.type);
+  if (length == 0 || length > size) return 0;
+  out[0] = 'M';
+  out[1] = 'C';
+  out[2] = packet.type;
+  put16(out + 3, packet.node);
+  if (packet.type == MCAST_NACK) {
+    put16(out + 5, packet.target);
+    put32(out + 7, packet.seq);
+    out[11] = packet.count;
+  } else {
+    put32(out + 5, packet.seq);
+    if (packet.type != MCAST_HEARTBEAT) {
+      put16(out + 9, packet.duration);
+      put32(out + 11, (uint32_t)packet.stamp);
+      put32(out + 15, (uint32_t)(packet.stamp >> 32));
+    }
+  }
+  return length;
+}
+
+bool mcastDecode(const uint8_t* data, size_t length, McastPacket& packet) {
+  if (length < 5 || data[0] != 'M' || data[1] != 'C') return false;
+  McastType type = (McastType)data[2];
+  size_t expected = packetLength(type);
+  if (expected == 0 || length < expected) return false;
+  memset(&packet, 0, sizeof(packet));
+  packet.type = type;
+  packet.node = get16(data + 3);
+  if (type == MCAST_NACK) {
+    packet.target = get16(data + 5);
+    packet.seq = get32(data + 7);
+    packet.count = data[11];
+    return packet.count > 0 && packet.count <= MCAST_NACK_MAX;
+  }
+  packet.seq = get32(data + 5);
+  if (type != MCAST_HEARTBEAT) {
+    packet.duration = get16(data + 9);
+    packet.stamp = get32(data + 11) | (uint64_t)get32(data + 15) << 32;
+  }
+  return true;
+}
+
+void mcastSenderBegin(McastSender& sender, uint32_t firstSeq) {
+  memset(&sender, 0, sizeof(sender));
+  sender.nextSeq = firstSeq;
+}
+
+McastEvent mcastPublish(McastSender& sender, uint16_t duration, uint64_t stamp) {
+  McastEvent event = { sender.nextSeq++, duration, stamp };
+  uint8_t slot = event.seq % MCAST_HISTORY;
+  sender.history[slot] = event;
+  sender.repairedAt[slot] = 0;
+  sender.published++;
+  return event;
+}
+
+size_t mcastRepair(McastSender& sender, uint32_t first, uint8_t count, uint32_t nowMs, McastEvent* out, size_t max) {
+  size_t n = 0;
+  for (uint8_t i = 0; i < count && n < max; i++) {
+    uint32_t seq = first + i;
+    if (ahead(seq, sender.nextSeq) >= 0 || ahead(sender.nextSeq, seq) > MCAST_HISTORY) continue;  // Futura ou já sobrescrita
+    uint8_t slot = seq % MCAST_HISTORY;
+    if (sender.history[slot].seq != seq) continue;
+    if (sender.repairedAt[slot] != 0 && ahead(nowMs, sender.repairedAt[slot]) < MCAST_REPAIR_HOLDOFF) continue;
+    sender.repairedAt[slot] = nowMs | 1;  // 0 = nunca reparado
+    out[n++] = sender.history[slot];
+    sender.repaired++;
+  }
+  return n;
+}
+
+void mcastReceiverBegin(McastReceiver& receiver, uint32_t seed) {
+  memset(&receiver, 0, sizeof(receiver));
+  receiver.random = seed | 1;
+}
+
+static uint32_t nextRandom(McastReceiver& receiver) {
+  uint32_t x = receiver.random;  // xorshift32
+  x ^= x << 13;
+  x ^= x >> 17;
+  x ^= x << 5;
+  receiver.random = x;
+  return x;
+}
+
+static void pushReady(McastReceiver& receiver, const McastEvent& event) {
+  if (receiver.readyCount == MCAST_REORDER) {  // Consumidor atrasado: perde o mais velho
+    receiver.readyHead = (receiver.readyHead + 1) % MCAST_REORDER;
+    receiver.readyCount--;
+    receiver.lost++;
+  }
+  receiver.ready[(receiver.readyHead + receiver.readyCount) % MCAST_REORDER] = event;
+  receiver.readyCount++;
+  receiver.delivered++;
+}
+
+// Passa para a fila de saída o que já está em ordem e reagenda o NACK se o buraco mudou
+static void advance(McastReceiver& receiver, uint32_t nowMs) {
+  for (;;) {
+    uint8_t slot = receiver.expected % MCAST_REORDER;
+    if (!receiver.heldValid[slot] || receiver.held[slot].seq != receiver.expected) break;
+    receiver.heldValid[slot] = false;
+    pushReady(receiver, receiver.held[slot]);
+    receiver.expected++;
+  }
+  bool gap = ahead(receiver.highest, receiver.expected) >= 0;
+  if (gap && (!receiver.gapOpen || receiver.gapSeq != receiver.expected)) {
+    receiver.gapSeq = receiver.expected;
+    receiver.nacks = 0;
+    receiver.nackAt = nowMs + MCAST_NACK_DELAY + nextRandom(receiver) % MCAST_NACK_JITTER;
+  }
+  receiver.gapOpen = gap;
+}
+
+// Pula sequências em falta até seq (exclusive), entregando as guardadas no caminho
+static void skipTo(McastReceiver& receiver, uint32_t seq) {
+  while (ahead(seq, receiver.expected) > 0) {
+    uint8_t slot = receiver.expected % MCAST_REORDER;
+    if (receiver.heldValid[slot] && receiver.held[slot].seq == receiver.expected) {
+      pushReady(receiver, receiver.held[slot]);
+    } else {
+      receiver.lost++;
+    }
+    receiver.heldValid[slot] = false;
+    receiver.expected++;
+  }
+}
+
+static void resync(McastReceiver& receiver, uint32_t expected, uint32_t highest) {
+  memset(receiver.heldValid, 0, sizeof(receiver.heldValid));
+  receiver.synced = true;
+  receiver.expected = expected;
+  receiver.highest = highest;
+  receiver.gapOpen = false;
+}
+
+void mcastAccept(McastReceiver& receiver, const McastEvent& event, uint32_t nowMs) {
+  int32_t distance = ahead(event.seq, receiver.expected);
+  if (!receiver.synced || distance >= MCAST_RESYNC || distance < -MCAST_RESYNC) {
+    resync(receiver, event.seq, event.seq);  // Entra no fluxo agora: não pede o que veio antes
+    distance = 0;
+  }
+  if (distance < 0) {
+    receiver.duplicates++;
+    return;
+  }
+  if (distance >= MCAST_REORDER) skipTo(receiver, event.seq - MCAST_REORDER + 1);
+  uint8_t slot = event.seq % MCAST_REORDER;
+  if (receiver.heldValid[slot] && receiver.held[slot].seq == event.seq) {
+    receiver.duplicates++;
+    return;
+  }
+  if (receiver.nacks > 0 && receiver.gapOpen && ahead(event.seq, receiver.expected) < MCAST_NACK_MAX) receiver.recovered++;
+  receiver.held[slot] = event;
+  receiver.heldValid[slot] = true;
+  if (ahead(event.seq, receiver.highest) > 0) receiver.highest = event.seq;
+  advance(receiver, nowMs);
+}
+
+void mcastHeartbeat(McastReceiver& receiver, uint32_t lastSeq, uint32_t nowMs) {
+  int32_t distance = ahead(lastSeq, receiver.expected);
+  if (!receiver.synced || distance >= MCAST_RESYNC || distance < -MCAST_RESYNC) {
+    resync(receiver, lastSeq + 1, lastSeq);
+    return;
+  }
+  if (ahead(lastSeq, receiver.highest) > 0) receiver.highest = lastSeq;
+  advance(receiver, nowMs);
+}
+
+void mcastNackHeard(McastReceiver& receiver, uint32_t first, uint32_t nowMs) {
+  if (!receiver.gapOpen || first != receiver.expected) return;
+  receiver.nacks++;  // Outro receptor pediu a mesma faixa: o reparo vem para o grupo
+  if (ahead(receiver.nackAt, nowMs + MCAST_NACK_RETRY) < 0) receiver.nackAt = nowMs + MCAST_NACK_RETRY;
+}
+
+bool mcastNext(McastReceiver& receiver, McastEvent& event) {
+  if (receiver.readyCount == 0) return false;
+  event = receiver.ready[receiver.readyHead];
+  receiver.readyHead = (receiver.readyHead + 1) % MCAST_REORDER;
+  receiver.readyCount--;
+  return true;
+}
+
+bool mcastPoll(McastReceiver& receiver, uint32_t nowMs, uint32_t& first, uint8_t& count) {
+  if (!receiver.gapOpen || ahead(nowMs, receiver.nackAt) < 0) return false;
+  uint8_t missing = 0;
+  while (missing < MCAST_NACK_MAX && ahead(receiver.highest, receiver.expected + missing) >= 0) {
+    uint8_t slot = (receiver.expected + missing) % MCAST_REORDER;
+    if (receiver.heldValid[slot] && receiver.held[slot].seq == receiver.expected + missing) break;
+    missing++;
+  }
+  if (receiver.nacks >= MCAST_NACK_TRIES) {  // Sem reparo: desiste da faixa e segue
+    skipTo(receiver, receiver.expected + missing);
+    advance(receiver, nowMs);
+    return false;
+  }
+  first = receiver.expected;
+  count = missing;
+  receiver.nacks++;
+  receiver.nackAt = nowMs + MCAST_NACK_RETRY;
+  return true;
+}
@@ -0,0 +1,100 @@
+#ifndef MCAST_STREAM_H
+#define MCAST_STREAM_H
+
+// Fluxo de elementos por multicast UDP com número de sequência e reparo por NACK.
+// Sem dependência do Arduino: o firmware envia/recebe os pacotes, o PC testa o núcleo.
+//
+// Quem transmite publica cada elemento uma vez para o grupo (DATA) e guarda os
+// últimos MCAST_HISTORY. Enquanto ativo manda HEARTBEAT com a última sequência, para
+// que a perda do último elemento também seja vista. Quem ouve entrega os elementos em
+// ordem; ao ver um buraco espera um atraso aleatório e pede a faixa em falta (NACK,
+// também para o grupo: quem ouve o NACK de outro adia o seu). O transmissor reenvia
+// (REPAIR) ao grupo, no máximo uma vez por MCAST_REPAIR_HOLDOFF por sequência.
+// Após MCAST_NACK_TRIES sem reparo o buraco é pulado e contado como perdido.
+//
+// Pacote (little-endian): 'M' 'C' tipo node(2) e então
+//   DATA/REPAIR: seq(4) duração(2) carimbo HLC(8)   HEARTBEAT: seq(4)
+//   NACK: alvo(2) primeira seq(4) quantidade(1)
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define MCAST_MAX_PACKET 19
+#define MCAST_HISTORY 64          // Elementos guardados pelo transmissor (potência de 2)
+#define MCAST_REORDER 16          // Elementos fora de ordem guardados pelo receptor (potência de 2)
+#define MCAST_NACK_MAX 8          // Sequências por NACK
+#define MCAST_NACK_DELAY 20       // ms mínimos antes do primeiro NACK (+ até MCAST_NACK_JITTER)
+#define MCAST_NACK_JITTER 60
+#define MCAST_NACK_RETRY 200      // ms entre NACKs da mesma faixa
+#define MCAST_NACK_TRIES 5
+#define MCAST_REPAIR_HOLDOFF 100  // ms: NACKs repetidos da mesma sequência geram um reparo só
+
+enum McastType : uint8_t { MCAST_DATA = 1, MCAST_REPAIR = 2, MCAST_HEARTBEAT = 3, MCAST_NACK = 4 };
+
+struct McastPacket {
+  McastType type;
+  uint16_t node;      // Quem mandou o pacote
+  uint32_t seq;       // DATA/REPAIR: do elemento; HEARTBEAT: última publicada; NACK: primeira em falta
+  uint16_t duration;  // ms
+  uint64_t stamp;     // hlcPack() do elemento (0 = sem carimbo)
+  uint16_t target;    // NACK: transmissor a quem se pede
+  uint8_t count;      // NACK: sequências a partir de seq
+};
+
+struct McastEvent {
+  uint32_t seq;
+  uint16_t duration;
+  uint64_t stamp;
+};
+
+struct McastSender {
+  McastEvent history[MCAST_HISTORY];
+  uint32_t repairedAt[MCAST_HISTORY];  // ms do último reparo de cada vaga
+  uint32_t nextSeq;
+  uint32_t published;
+  uint32_t repaired;
+};
+
+struct McastReceiver {
+  bool synced;            // Já recebeu deste transmissor (primeiro pacote define expected)
+  uint32_t expected;      // Próxima sequência a entregar
+  uint32_t highest;       // Maior sequência que se sabe existir (DATA ou HEARTBEAT)
+  McastEvent held[MCAST_REORDER];  // Chegados adiante de um buraco (vaga = seq % MCAST_REORDER)
+  bool heldValid[MCAST_REORDER];
+  McastEvent ready[MCAST_REORDER];  // Já em ordem, aguardando mcastNext()
+  uint8_t readyHead;
+  uint8_t readyCount;
+  bool gapOpen;           // expected falta e há sequência maior conhecida
+  uint32_t gapSeq;        // expected quando o buraco atual foi agendado
+  uint32_t nackAt;        // ms do próximo NACK da faixa em falta
+  uint8_t nacks;          // NACKs (nossos ou ouvidos) para o buraco atual
+  uint32_t random;        // Estado do sorteio do atraso do NACK
+  uint32_t delivered;
+  uint32_t recovered;     // Entregues depois de um NACK
+  uint32_t lost;
+  uint32_t duplicates;
+};
+
+size_t mcastEncode(const McastPacket& packet, uint8_t* out, size_t size); // Bytes escritos; 0 se não couber
+
+bool mcastDecode(const uint8_t* data, size_t length, McastPacket& packet); // false se não for um pacote válido
+
+void mcastSenderBegin(McastSender& sender, uint32_t firstSeq); // Sequência inicial (ex.: aleatória após reset)
+
+McastEvent mcastPublish(McastSender& sender, uint16_t duration, uint64_t stamp); // Numera e guarda para reparo
+
+size_t mcastRepair(McastSender& sender, uint32_t first, uint8_t count, uint32_t nowMs, McastEvent* out, size_t max); // Elementos pedidos ainda guardados e fora do holdoff
+
+void mcastReceiverBegin(McastReceiver& receiver, uint32_t seed); // seed diferente por unidade: atrasos de NACK diferentes
+
+void mcastAccept(McastReceiver& receiver, const McastEvent& event, uint32_t nowMs); // DATA ou REPAIR recebido
+
+void mcastHeartbeat(McastReceiver& receiver, uint32_t lastSeq, uint32_t nowMs); // Última sequência publicada
+
+void mcastNackHeard(McastReceiver& receiver, uint32_t first, uint32_t nowMs); // NACK de outro receptor: adia o próprio
+
+bool mcastNext(McastReceiver& receiver, McastEvent& event); // Próximo elemento em ordem; false se nada pronto
+
+bool mcastPoll(McastReceiver& receiver, uint32_t nowMs, uint32_t& first, uint8_t& count); // true = mandar NACK agora (faixa em first/count)
+
+#endif
@@ -0,0 +1,204 @@
+#include "metrics.h"
+#include <ESP8266WiFi.h>
+#if METRICS_CHECKPOINT
+#include <LittleFS.h>
+#endif
+
+#define METRICS_SECONDS 60                     // Série de 1 s: último minuto
+#define METRICS_MINUTES 60                     // Série de 1 min: última hora
+#define METRICS_HOURS 24                       // Série de 1 h: último dia
+#define METRICS_TIERS 3
+#define METRICS_NO_DATA INT16_MIN              // Intervalo sem amostras
+#define METRICS_CHECKPOINT_INTERVAL 600000UL   // Checkpoint a cada 10 min
+#define METRICS_FILE "/metrics.bin"
+#define METRICS_MAGIC 0x4D545332UL             // "MTS2"
+
+enum Aggregation { AGG_SUM, AGG_AVG, AGG_MIN, AGG_MAX };
+
+// Nome, agregação e deslocamento (valor armazenado = valor >> shift, para caber em int16)
+static const struct {
+  const char* name;
+  Aggregation agg;
+  uint8_t shift;
+} metricInfo[METRIC_COUNT] = {
+  { "events", AGG_SUM, 0 },
+  { "decode_err", AGG_SUM, 0 },
+  { "rtt_ms", AGG_AVG, 0 },
+  { "rssi_dbm", AGG_AVG, 0 },
+  { "heap_b", AGG_MIN, 2 },
+  { "late_ms", AGG_MAX, 0 },
+  { "rx_backlog_b", AGG_MAX, 0 }
+};
+
+struct Accumulator {
+  int32_t value;
+  uint16_t count;
+};
+
+struct Tier {
+  const char* label;
+  int16_t (*ring)[METRIC_COUNT];
+  uint8_t size;
+  uint8_t head;                      // Próximo slot a escrever
+  uint8_t filled;                    // Slots válidos
+  uint8_t pending;                   // Intervalos do nível anterior já agregados
+  Accumulator acc[METRIC_COUNT];     // Intervalo em aberto
+};
+
+static int16_t secondRing[METRICS_SECONDS][METRIC_COUNT];
+static int16_t minuteRing[METRICS_MINUTES][METRIC_COUNT];
+static int16_t hourRing[METRICS_HOURS][METRIC_COUNT];
+static Tier tiers[METRICS_TIERS] = {
+  { "1s", secondRing, METRICS_SECONDS, 0, 0, 0, {} },
+  { "1min", minuteRing, METRICS_MINUTES, 0, 0, 0, {} },
+  { "1h", hourRing, METRICS_HOURS, 0, 0, 0, {} }
+};
+static unsigned long lastSecond = 0;
+static unsigned long lastCheckpoint = 0;
+
+static void accumulate(Accumulator& acc, Aggregation agg, int32_t value) {
+  if (acc.count == 0) {
+    acc.value = value;
+  } else if (agg == AGG_SUM || agg == AGG_AVG) {
+    acc.value += value;
+  } else if (agg == AGG_MIN) {
+    if (value < acc.value) acc.value = value;
+  } else if (value > acc.value) {
+    acc.value = value;
+  }
+  if (acc.count < UINT16_MAX) acc.count++;
+}
+
+// Fecha o intervalo do nível t e agrega o resultado no nível seguinte
+static void closeTier(uint8_t t) {
+  Tier& tier = tiers[t];
+  for (uint8_t m = 0; m < METRIC_COUNT; m++) {
+    Accumulator& acc = tier.acc[m];
+    Aggregation agg = metricInfo[m].agg;
+    int16_t stored = METRICS_NO_DATA;
+    if (acc.count > 0 || agg == AGG_SUM) {
+      int32_t value = (acc.count > 0 && agg == AGG_AVG) ? acc.value / acc.count : acc.value;
+      stored = (int16_t)constrain(value >> metricInfo[m].shift, (int32_t)INT16_MIN + 1, (int32_t)INT16_MAX);
+      if (t + 1 < METRICS_TIERS) accumulate(tiers[t + 1].acc[m], agg, value);
+    }
+    tier.ring[tier.head][m] = stored;
+    acc.value = 0;
+    acc.count = 0;
+  }
+  tier.head = (tier.head + 1) % tier.size;
+  if (tier.filled < tier.size) tier.filled++;
+  if (t + 1 < METRICS_TIERS && ++tiers[t + 1].pending >= 60) {
+    tiers[t + 1].pending = 0;
+    closeTier(t + 1);
+  }
+}
+
+#if METRICS_CHECKPOINT
+// Salva níveis de 1 min e 1 h (o de 1 s não sobrevive a um reboot de qualquer forma)
+static void checkpointMetrics() {
+  unsigned long now = millis();
+  File file = LittleFS.open(METRICS_FILE, "w");
+  if (!file) {
+    Serial.print(now);
+    Serial.println(" - Erro: Falha ao gravar checkpoint de metricas");
+    return;
+  }
+  uint32_t magic = METRICS_MAGIC;
+  file.write((const uint8_t*)&magic, sizeof(magic));
+  for (uint8_t t = 1; t < METRICS_TIERS; t++) {
+    file.write(&tiers[t].head, 1);
+    file.write(&tiers[t].filled, 1);
+    file.write((const uint8_t*)tiers[t].ring, tiers[t].size * sizeof(tiers[t].ring[0]));
+  }
+  file.close();
+  Serial.print(now);
+  Serial.println(" - Checkpoint de metricas gravado");
+}
+
+static void restoreMetrics() {
+  unsigned long now = millis();
+  File file = LittleFS.open(METRICS_FILE, "r");
+  if (!file) return;
+  uint32_t magic = 0;
+  file.read((uint8_t*)&magic, sizeof(magic));
+  if (magic == METRICS_MAGIC) {
+    for (uint8_t t = 1; t < METRICS_TIERS; t++) {
+      file.read(&tiers[t].head, 1);
+      file.read(&tiers[t].filled, 1);
+      file.read((uint8_t*)tiers[t].ring, tiers[t].size * sizeof(tiers[t].ring[0]));
+      tiers[t].head %= tiers[t].size;
+      if (tiers[t].filled > tiers[t].size) tiers[t].filled = tiers[t].size;
+    }
+    Serial.print(now);
+    Serial.println(" - Metricas restauradas do checkpoint");
+  }
+  file.close();
+}
+#endif
+
+void initMetrics() {
+  unsigned long now = millis();
+  for (uint8_t t = 0; t < METRICS_TIERS; t++) {
+    for (uint8_t i = 0; i < tiers[t].size; i++) {
+      for (uint8_t m = 0; m < METRIC_COUNT; m++) tiers[t].ring[i][m] = METRICS_NO_DATA;
+    }
+  }
+#if METRICS_CHECKPOINT
+  if (LittleFS.begin()) restoreMetrics();
+#endif
+  lastSecond = now;
+  lastCheckpoint = now;
+  Serial.print(now);
+  Serial.println(" - Metricas inicializadas (1s/1min/1h)");
+}
+
+void updateMetrics() {
+  unsigned long now = millis();
+  if (now - lastSecond < 1000) return;
+  recordMetric(METRIC_HEAP, ESP.getFreeHeap());
+  if (WiFi.status() == WL_CONNECTED) recordMetric(METRIC_RSSI, WiFi.RSSI());
+  // Se o loop atrasou, fecha todos os segundos perdidos
+  while (now - lastSecond >= 1000) {
+    closeTier(0);
+    lastSecond += 1000;
+  }
+#if METRICS_CHECKPOINT
+  if (now - lastCheckpoint >= METRICS_CHECKPOINT_INTERVAL) {
+    checkpointMetrics();
+    lastCheckpoint = now;
+  }
+#endif
+}
+
+void recordMetric(Metric metric, long value) {
+  accumulate(tiers[0].acc[metric], metricInfo[metric].agg, value);
+}
+
+void dumpMetrics(Print& out) {
+  for (uint8_t t = 0; t < METRICS_TIERS; t++) {
+    const Tier& tier = tiers[t];
+    out.print("metrics ");
+    out.print(tier.label);
+    out.print(": idade");
+    for (uint8_t m = 0; m < METRIC_COUNT; m++) {
+      out.print(',');
+      out.print(metricInfo[m].name);
+    }
+    out.println();
+    for (uint8_t n = tier.filled; n > 0; n--) {
+      uint8_t slot = (tier.head + tier.size - n) % tier.size;
+      out.print('-');
+      out.print(n);
+      for (uint8_t m = 0; m < METRIC_COUNT; m++) {
+        out.print(',');
+        int16_t stored = tier.ring[slot][m];
+        if (stored == METRICS_NO_DATA) {
+          out.print('-');
+        } else {
+          out.print((long)stored << metricInfo[m].shift);
+        }
+      }
+      out.println();
+    }
+  }
+}
@@ -0,0 +1,18 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <Arduino.h>
+
+#define METRICS_CHECKPOINT 0  // 1 = salva séries de 1 min e 1 h na flash (LittleFS)
+
+enum Metric { METRIC_EVENTS, METRIC_DECODE_ERRORS, METRIC_RTT, METRIC_RSSI, METRIC_HEAP, METRIC_LOOP_LATENESS, METRIC_RX_BACKLOG, METRIC_COUNT };
+
+void initMetrics(); // Zera séries e restaura checkpoint da flash, se habilitado
+
+void updateMetrics(); // Amostra heap/RSSI e fecha intervalos de 1 s, 1 min e 1 h
+
+void recordMetric(Metric metric, long value); // Registra amostra (O(1))
+
+void dumpMetrics(Print& out); // Imprime as três séries, da mais antiga para a mais recente
+
+#endif
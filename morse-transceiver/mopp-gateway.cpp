@@ -0,0 +1,148 @@
+#include "mopp-gateway.h"
+#include "mopp.h"
+#include <ESP8266WiFi.h>
+#include <WiFiUdp.h>
+#include "cw-transceiver.h"
+#include "network.h"
+#include "event-bus.h"  // Elementos recebidos passam pelo re-temporizador como os da porta 5000
+
+#if MOPP_GATEWAY_ENABLED
+static const IPAddress MOPP_PEER_IP(192, 168, 4, 2);  // Destino dos pacotes MOPP (ex.: PC com a ferramenta CW/IP)
+#define MOPP_DEFAULT_WPM 20
+#define MOPP_QUEUE_SIZE 64                          // Elementos recebidos aguardando reprodução
+#define MOPP_LETTER_PAUSE (LETTER_GAP + 100)        // Pausa após fim de caractere (decodificador local usa LETTER_GAP)
+#define MOPP_WORD_PAUSE (LETTER_GAP * 2)
+
+struct MoppElement {
+  uint16_t duration;  // Duração enviada como "duration:"
+  uint16_t gapAfter;  // Silêncio até o próximo elemento
+};
+
+static WiFiUDP udp;
+static MoppWriter writer;                 // Pacote em montagem (um caractere)
+static uint8_t packetSerial = 0;
+static uint8_t wpm = MOPP_DEFAULT_WPM;    // Estimada pelos pontos vistos
+static uint8_t packet[MOPP_MAX_PACKET];   // Pacote recebido
+static MoppElement queue[MOPP_QUEUE_SIZE];
+static uint8_t queueHead = 0;
+static uint8_t queueCount = 0;
+static unsigned long nextDispatch = 0;
+static bool injecting = false;            // Evita devolver ao MOPP o que veio dele
+
+static void enqueue(uint16_t duration, uint16_t gapAfter) {
+  if (queueCount >= MOPP_QUEUE_SIZE) return;  // Fila cheia: descarta
+  MoppElement& element = queue[(queueHead + queueCount) % MOPP_QUEUE_SIZE];
+  element.duration = duration;
+  element.gapAfter = gapAfter;
+  queueCount++;
+}
+
+// Estende a pausa após o último elemento enfileirado (fim de caractere/palavra)
+static void extendLastGap(uint16_t gap) {
+  if (queueCount == 0) return;
+  MoppElement& last = queue[(queueHead + queueCount - 1) % MOPP_QUEUE_SIZE];
+  if (last.gapAfter < gap) last.gapAfter = gap;
+}
+
+static void receivePacket() {
+  unsigned long now = millis();
+  int length = udp.parsePacket();
+  if (length <= 0) return;
+  length = udp.read(packet, sizeof(packet));
+  uint8_t serial = 0, speed = 0;
+  if (length <= 0 || !moppParseHeader(packet, length, &serial, &speed)) return;
+  if (speed < 5) speed = MOPP_DEFAULT_WPM;
+  uint16_t dit = 1200 / speed;
+  // Durações ajustadas para caírem do lado certo do limiar ponto/traço local
+  uint16_t dotDuration = constrain(dit, DEBOUNCE_TIME + 5, SHORT_PRESS);
+  uint16_t dashDuration = max((uint16_t)(3 * dit), (uint16_t)(SHORT_PRESS + 1));
+  size_t symbols = moppSymbolCount(length);
+  for (size_t i = 0; i < symbols; i++) {
+    MoppSymbol symbol = moppSymbolAt(packet, i);
+    if (symbol == MOPP_DIT) {
+      enqueue(dotDuration, dit);
+    } else if (symbol == MOPP_DAH) {
+      enqueue(dashDuration, dit);
+    } else if (symbol == MOPP_EOC) {
+      extendLastGap(MOPP_LETTER_PAUSE);  // EOCs repetidos (enchimento) não somam
+    } else {
+      extendLastGap(MOPP_WORD_PAUSE);
+    }
+  }
+  Serial.print(now);
+  Serial.print(" - MOPP recebido: serial ");
+  Serial.print(serial);
+  Serial.print(", ");
+  Serial.print(speed);
+  Serial.print(" wpm, ");
+  Serial.print(symbols);
+  Serial.println(" simbolos");
+}
+#endif
+
+void initMoppGateway() {
+#if MOPP_GATEWAY_ENABLED
+  unsigned long now = millis();
+  udp.begin(MOPP_PORT);
+  Serial.print(now);
+  Serial.print(" - Gateway MOPP ativo na porta UDP ");
+  Serial.println(MOPP_PORT);
+#endif
+}
+
+void updateMoppGateway() {
+#if MOPP_GATEWAY_ENABLED
+  unsigned long now = millis();
+  receivePacket();
+  if (queueCount == 0 || (long)(now - nextDispatch) < 0) return;
+  MoppElement element = queue[queueHead];
+  queueHead = (queueHead + 1) % MOPP_QUEUE_SIZE;
+  queueCount--;
+  postEvent(BUS_NET_ELEMENT, MOPP_STAMP_SLOT, element.duration);  // Volta em moppDeliverElement()
+  nextDispatch = now + element.duration + element.gapAfter;
+#endif
+}
+
+void moppDeliverElement(unsigned long duration) {
+#if MOPP_GATEWAY_ENABLED
+  injecting = true;
+  captureInput(REMOTE, duration);  // Decodifica/exibe localmente
+  sendDuration(duration);          // E traduz para a porta 5000, com o carimbo que o elemento acabou de ganhar
+  injecting = false;
+#else
+  (void)duration;
+#endif
+}
+
+void moppNoteElement(unsigned long duration) {
+#if MOPP_GATEWAY_ENABLED
+  if (injecting) return;
+  if (writer.bits == 0) moppBegin(writer, packetSerial, wpm);
+  moppPut(writer, duration <= SHORT_PRESS ? MOPP_DIT : MOPP_DAH);
+  if (duration <= SHORT_PRESS) {
+    uint8_t measured = constrain(1200 / max(duration, 1UL), 5UL, 60UL);
+    wpm = (wpm * 3 + measured) / 4;
+  }
+#else
+  (void)duration;
+#endif
+}
+
+void moppNoteLetterEnd() {
+#if MOPP_GATEWAY_ENABLED
+  unsigned long now = millis();
+  if (writer.bits == 0) return;
+  moppPut(writer, MOPP_EOC);
+  udp.beginPacket(MOPP_PEER_IP, MOPP_PORT);
+  udp.write(writer.data, moppLength(writer));
+  udp.endPacket();
+  Serial.print(now);
+  Serial.print(" - MOPP enviado: serial ");
+  Serial.print(packetSerial);
+  Serial.print(", ");
+  Serial.print(moppLength(writer));
+  Serial.println(" bytes");
+  packetSerial = (packetSerial + 1) & 0x3F;
+  writer.bits = 0;
+#endif
+}
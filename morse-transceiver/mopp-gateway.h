@@ -0,0 +1,19 @@
+#ifndef MOPP_GATEWAY_H
+#define MOPP_GATEWAY_H
+
+#include <Arduino.h>
+
+#define MOPP_GATEWAY_ENABLED 0  // 1 = traduz o tráfego da porta 5000 para MOPP/UDP e vice-versa
+#define MOPP_STAMP_SLOT 0xFE    // arg de BUS_NET_ELEMENT vindo do MOPP: fora das vagas de carimbo (sem carimbo, como TRANSCRIPT_NO_STAMP)
+
+void initMoppGateway(); // Abre a porta UDP do MOPP
+
+void updateMoppGateway(); // Lê pacotes MOPP e reproduz os elementos na hora certa
+
+void moppDeliverElement(unsigned long duration); // Re-temporizador/decodificador: elemento do MOPP chegou a vez (decodifica e segue para a porta 5000, sem eco)
+
+void moppNoteElement(unsigned long duration); // Elemento visto (chave local ou "duration:" recebido)
+
+void moppNoteLetterEnd(); // Fim de caractere: fecha e envia o pacote MOPP
+
+#endif
@@ -0,0 +1,56 @@
+#include "mopp.h"
+#include <string.h>
+
+static void putBits(MoppWriter& writer, uint8_t value, uint8_t count) {
+  for (int8_t i = count - 1; i >= 0; i--) {
+    uint16_t byteIndex = writer.bits / 8;
+    uint8_t mask = 0x80 >> (writer.bits % 8);
+    if (value & (1 << i)) {
+      writer.data[byteIndex] |= mask;
+    } else {
+      writer.data[byteIndex] &= ~mask;
+    }
+    writer.bits++;
+  }
+}
+
+static uint8_t getBits(const uint8_t* data, size_t bit, uint8_t count) {
+  uint8_t value = 0;
+  for (uint8_t i = 0; i < count; i++, bit++) {
+    value = (value << 1) | ((data[bit / 8] >> (7 - bit % 8)) & 1);
+  }
+  return value;
+}
+
+void moppBegin(MoppWriter& writer, uint8_t serial, uint8_t wpm) {
+  memset(writer.data, 0, sizeof(writer.data));
+  writer.bits = 0;
+  putBits(writer, 1, 2);
+  putBits(writer, serial & 0x3F, 6);
+  putBits(writer, wpm & 0x3F, 6);
+}
+
+bool moppPut(MoppWriter& writer, MoppSymbol symbol) {
+  if (writer.bits + 2 > MOPP_MAX_PACKET * 8) return false;
+  putBits(writer, (uint8_t)symbol, 2);
+  return true;
+}
+
+size_t moppLength(const MoppWriter& writer) {
+  return (writer.bits + 7) / 8;
+}
+
+bool moppParseHeader(const uint8_t* data, size_t length, uint8_t* serial, uint8_t* wpm) {
+  if (length < 2 || getBits(data, 0, 2) != 1) return false;
+  *serial = getBits(data, 2, 6);
+  *wpm = getBits(data, 8, 6);
+  return true;
+}
+
+size_t moppSymbolCount(size_t length) {
+  return (length * 8 > MOPP_HEADER_BITS) ? (length * 8 - MOPP_HEADER_BITS) / 2 : 0;
+}
+
+MoppSymbol moppSymbolAt(const uint8_t* data, size_t index) {
+  return (MoppSymbol)getBits(data, MOPP_HEADER_BITS + index * 2, 2);
+}
@@ -0,0 +1,38 @@
+#ifndef MOPP_H
+#define MOPP_H
+
+// Codec do MOPP (Morse over Packet), formato UDP usado por outras ferramentas de
+// CW sobre IP. Sem dependência do Arduino e sem alocação: compilado também no PC.
+//
+// Pacote = sequência de campos de 2 bits, do bit mais significativo para o menos:
+//   versão (01) | serial (6 bits) | velocidade em WPM (6 bits) | símbolos...
+// Símbolos: 01 = ponto, 10 = traço, 00 = fim de caractere, 11 = fim de palavra.
+// O último byte é completado com zeros.
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define MOPP_PORT 7373
+#define MOPP_MAX_PACKET 64
+#define MOPP_HEADER_BITS 14
+
+enum MoppSymbol { MOPP_EOC = 0, MOPP_DIT = 1, MOPP_DAH = 2, MOPP_EOW = 3 };
+
+struct MoppWriter {
+  uint8_t data[MOPP_MAX_PACKET];
+  uint16_t bits;  // Bits já escritos (0 = pacote vazio)
+};
+
+void moppBegin(MoppWriter& writer, uint8_t serial, uint8_t wpm); // Inicia pacote com cabeçalho
+
+bool moppPut(MoppWriter& writer, MoppSymbol symbol); // Acrescenta símbolo; false se cheio
+
+size_t moppLength(const MoppWriter& writer); // Tamanho em bytes
+
+bool moppParseHeader(const uint8_t* data, size_t length, uint8_t* serial, uint8_t* wpm); // Valida versão
+
+size_t moppSymbolCount(size_t length); // Símbolos no pacote (inclui o enchimento final)
+
+MoppSymbol moppSymbolAt(const uint8_t* data, size_t index); // Símbolo de índice index
+
+#endif
@@ -0,0 +1,136 @@
+#include "morse-table.h"
+#include <string.h>
+#if defined(__SSSE3__)
+#include <tmmintrin.h>
+#endif
+#if defined(ARDUINO)
+#include "key-timing.h"  // KEY_IRAM: o passo do decodificador roda no caminho da tecla
+#else
+#define KEY_IRAM
+#endif
+
+// Índice = caractere - 0x20 (' ' a '_')
+static const uint8_t morseEncodeTable[64] = {
+  0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x2A, 0x73, 0x61, 0x55, 0x32,
+  0x3F, 0x2F, 0x27, 0x23, 0x21, 0x20, 0x30, 0x38, 0x3C, 0x3E, 0x00, 0x6A, 0x00, 0x00, 0x00, 0x4C,
+  0x00, 0x05, 0x18, 0x1A, 0x0C, 0x02, 0x12, 0x0E, 0x10, 0x04, 0x17, 0x0D, 0x14, 0x07, 0x06, 0x0F,
+  0x16, 0x1D, 0x0A, 0x08, 0x03, 0x09, 0x11, 0x0B, 0x19, 0x1B, 0x1C, 0x00, 0x00, 0x00, 0x00, 0x00,
+};
+
+// Índice = código compactado
+static const char morseDecodeTable[128] = {
+  0, ' ', 'E', 'T', 'I', 'A', 'N', 'M', 'S', 'U', 'R', 'W', 'D', 'K', 'G', 'O',
+  'H', 'V', 'F', 0, 'L', 0, 'P', 'J', 'B', 'X', 'C', 'Y', 'Z', 'Q', 0, 0,
+  '5', '4', 0, '3', 0, 0, 0, '2', 0, 0, '+', 0, 0, 0, 0, '1',
+  '6', 0, '/', 0, 0, 0, 0, 0, '7', 0, 0, 0, '8', 0, '9', '0',
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, '?', 0, 0, 0,
+  0, 0, 0, 0, 0, '.', 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+  0, '-', 0, 0, 0, 0, 0, 0, 0, 0, ';', 0, 0, 0, 0, 0,
+  0, 0, 0, ',', 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+};
+
+uint8_t encodeMorse(char c) {
+  if (c >= 'a' && c <= 'z') c -= 'a' - 'A';
+  if (c < 0x20 || c >= 0x60) return MORSE_CODE_NONE;
+  return morseEncodeTable[c - 0x20];
+}
+
+char KEY_IRAM decodeMorse(uint8_t code) {
+  return (code < 128) ? morseDecodeTable[code] : '\0';
+}
+
+uint8_t KEY_IRAM morseCodeFromString(const char* symbol) {
+  uint8_t code = 1;
+  size_t length = 0;
+  for (; symbol[length] != '\0'; length++) {
+    if (length >= MORSE_MAX_ELEMENTS) return MORSE_CODE_NONE;
+    if (symbol[length] == '.') {
+      code = code << 1;
+    } else if (symbol[length] == '-') {
+      code = (code << 1) | 1;
+    } else {
+      return MORSE_CODE_NONE;
+    }
+  }
+  return (length > 0) ? code : MORSE_CODE_NONE;
+}
+
+void morseCodeToString(uint8_t code, char* symbol) {
+  symbol[0] = '\0';
+  if (code < 2 || code >= 128) return;
+  int bits = 7;
+  while (!(code & (1 << (bits - 1)))) bits--;  // Posição do sentinela
+  int length = bits - 1;
+  for (int i = 0; i < length; i++) {
+    symbol[i] = (code & (1 << (length - 1 - i))) ? '-' : '.';
+  }
+  symbol[length] = '\0';
+}
+
+#if defined(__SSSE3__)
+// 16 consultas por instrução de shuffle: cada tabela de 16 entradas é um registrador,
+// selecionado pelo nibble alto do índice
+static inline __m128i lookup16(const uint8_t* table, int tables, __m128i index, __m128i valid) {
+  __m128i low = _mm_and_si128(index, _mm_set1_epi8(0x0F));
+  __m128i high = _mm_and_si128(_mm_srli_epi16(index, 4), _mm_set1_epi8(0x0F));
+  __m128i result = _mm_setzero_si128();
+  for (int k = 0; k < tables; k++) {
+    __m128i entries = _mm_loadu_si128((const __m128i*)(table + 16 * k));
+    __m128i hit = _mm_cmpeq_epi8(high, _mm_set1_epi8((char)k));
+    result = _mm_or_si128(result, _mm_and_si128(hit, _mm_shuffle_epi8(entries, low)));
+  }
+  return _mm_and_si128(result, valid);
+}
+#endif
+
+void encodeMorseBatch(const char* text, uint8_t* codes, size_t count) {
+  size_t i = 0;
+#if defined(__SSSE3__)
+  for (; i + 16 <= count; i += 16) {
+    __m128i c = _mm_loadu_si128((const __m128i*)(text + i));
+    __m128i lower = _mm_and_si128(_mm_cmpgt_epi8(c, _mm_set1_epi8('a' - 1)), _mm_cmplt_epi8(c, _mm_set1_epi8('z' + 1)));
+    c = _mm_sub_epi8(c, _mm_and_si128(lower, _mm_set1_epi8('a' - 'A')));
+    // Bytes >= 0x80 são negativos na comparação com sinal e ficam fora da faixa
+    __m128i valid = _mm_and_si128(_mm_cmpgt_epi8(c, _mm_set1_epi8(0x1F)), _mm_cmplt_epi8(c, _mm_set1_epi8(0x60)));
+    __m128i index = _mm_sub_epi8(c, _mm_set1_epi8(0x20));
+    _mm_storeu_si128((__m128i*)(codes + i), lookup16(morseEncodeTable, 4, index, valid));
+  }
+#endif
+  for (; i + 4 <= count; i += 4) {
+    codes[i] = encodeMorse(text[i]);
+    codes[i + 1] = encodeMorse(text[i + 1]);
+    codes[i + 2] = encodeMorse(text[i + 2]);
+    codes[i + 3] = encodeMorse(text[i + 3]);
+  }
+  for (; i < count; i++) codes[i] = encodeMorse(text[i]);
+}
+
+// Sem caminho SSSE3: a tabela de 128 entradas precisaria de 8 shuffles por bloco e
+// medimos que não ganha da consulta direta desenrolada
+void decodeMorseBatch(const uint8_t* codes, char* text, size_t count) {
+  size_t i = 0;
+  for (; i + 4 <= count; i += 4) {
+    text[i] = decodeMorse(codes[i]);
+    text[i + 1] = decodeMorse(codes[i + 1]);
+    text[i + 2] = decodeMorse(codes[i + 2]);
+    text[i + 3] = decodeMorse(codes[i + 3]);
+  }
+  for (; i < count; i++) text[i] = decodeMorse(codes[i]);
+}
+
+bool verifyMorseBatch() {
+  uint8_t bytes[256];
+  uint8_t codes[256];
+  char text[256];
+  for (int i = 0; i < 256; i++) bytes[i] = (uint8_t)i;
+  encodeMorseBatch((const char*)bytes, codes, sizeof(bytes));
+  decodeMorseBatch(bytes, text, sizeof(bytes));
+  for (int i = 0; i < 256; i++) {
+    if (codes[i] != encodeMorse((char)bytes[i])) return false;
+    if (text[i] != decodeMorse(bytes[i])) return false;
+    // Ida e volta: todo caractere codificável decodifica para sua forma maiúscula
+    char c = (char)i;
+    if (codes[i] != MORSE_CODE_NONE && decodeMorse(codes[i]) != ((c >= 'a' && c <= 'z') ? c - ('a' - 'A') : c)) return false;
+  }
+  return true;
+}
@@ -0,0 +1,31 @@
+#ifndef MORSE_TABLE_H
+#define MORSE_TABLE_H
+
+// Tabela Morse única (firmware e ferramentas no PC): sem dependência do Arduino.
+//
+// Código compactado em um byte: bit sentinela 1 seguido dos elementos, do primeiro
+// ao último (0 = ponto, 1 = traço). Ex.: "A" = ".-" = 0b101 = 0x05.
+// 0 = inválido, 1 = separador de palavra (' '). Máximo de 6 elementos (< 128).
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define MORSE_CODE_NONE 0x00
+#define MORSE_CODE_SPACE 0x01
+#define MORSE_MAX_ELEMENTS 6
+
+uint8_t encodeMorse(char c); // Caractere -> código (minúsculas aceitas); 0 se não houver
+
+char decodeMorse(uint8_t code); // Código -> caractere; '\0' se não houver
+
+uint8_t morseCodeFromString(const char* symbol); // ".-" -> código; 0 se inválido
+
+void morseCodeToString(uint8_t code, char* symbol); // Código -> ".-" (buffer de 7 bytes)
+
+void encodeMorseBatch(const char* text, uint8_t* codes, size_t count); // Em lote (SSSE3 no PC, se disponível)
+
+void decodeMorseBatch(const uint8_t* codes, char* text, size_t count); // Em lote (consulta direta desenrolada)
+
+bool verifyMorseBatch(); // Confere os kernels em lote contra a busca escalar (todos os 256 bytes)
+
+#endif
@@ -3,25 +3,141 @@
 #include "display.h"
 #include "blinker.h"
 #include "network.h"
+#include "metrics.h"
+#include "capture.h"
+#include "tx-power.h"
+#include "scrollback.h"
+#include "catch-up.h"
+#include "mopp-gateway.h"
+#include "key-timing.h"
+#include "retimer.h"
+#include "warm-restart.h"
+#include "event-bus.h"
+#include "exchange.h"
+#include "qso-index.h"
+#include "energy.h"
+#include "keyer.h"
+#include "transcript.h"
+#include "multicast.h"
+
+enum ConsoleCommand { CMD_METRICS, CMD_PCAP, CMD_TXPOWER, CMD_KEYTIMING, CMD_KEYTIMING_RESET, CMD_RETIME, CMD_RETIME_SET, CMD_EXCHANGE, CMD_EXCHANGE_RESET, CMD_QSO, CMD_QSO_SHOW, CMD_KEYER, CMD_KEYER_SET, CMD_TRANSCRIPT, CMD_MULTICAST, CMD_ENERGY, CMD_ENERGY_SHOW };
+
+// Executa o comando na prioridade mais baixa do barramento, depois de elementos e caracteres
+static void onConsoleCommand(const BusEvent& event) {
+  switch (event.arg) {
+    case CMD_METRICS: dumpMetrics(Serial); break;
+    case CMD_PCAP: dumpCapturePcap(Serial); break;
+    case CMD_TXPOWER: dumpTxPower(Serial); break;
+    case CMD_KEYTIMING: dumpKeyTiming(Serial); break;
+    case CMD_KEYTIMING_RESET: resetKeyTiming(); break;
+    case CMD_RETIME: dumpRetime(Serial); break;
+    case CMD_RETIME_SET: setRetime(event.value >> 8, event.value & 0xFF); break;  // wpm << 8 | wpm efetiva
+    case CMD_EXCHANGE: dumpExchange(Serial); break;
+    case CMD_EXCHANGE_RESET: resetExchange(); break;
+    case CMD_QSO: dumpQsoIndex(Serial); break;
+    case CMD_QSO_SHOW: showQso(event.value); break;  // Rolagem do display no início do QSO
+    case CMD_KEYER: dumpKeyer(Serial); break;
+    case CMD_KEYER_SET: setKeyer(event.value >> 16, event.value & 0xFFFF); break;  // lead << 16 | hang (ms)
+    case CMD_TRANSCRIPT: dumpTranscript(Serial); break;
+    case CMD_MULTICAST: dumpMulticast(Serial); break;
+    case CMD_ENERGY: dumpEnergy(Serial); break;
+    case CMD_ENERGY_SHOW: showEnergy(); break;  // Página de consumo no display
+  }
+}
+
+// Lê comandos simples da Serial (ex.: "metrics", "pcap", "txpower", "keytiming", "retime 18 8", "keyer 15 400")
+static void handleSerialCommand() {
+  static char command[16];
+  static size_t length = 0;
+  while (Serial.available()) {
+    char c = Serial.read();
+    if (c == '\n' || c == '\r') {
+      command[length] = '\0';
+      if (strcmp(command, "metrics") == 0) postEvent(BUS_CONSOLE, CMD_METRICS, 0);
+      else if (strcmp(command, "pcap") == 0) postEvent(BUS_CONSOLE, CMD_PCAP, 0);
+      else if (strcmp(command, "txpower") == 0) postEvent(BUS_CONSOLE, CMD_TXPOWER, 0);
+      else if (strcmp(command, "keytiming") == 0) postEvent(BUS_CONSOLE, CMD_KEYTIMING, 0);
+      else if (strcmp(command, "keytiming reset") == 0) postEvent(BUS_CONSOLE, CMD_KEYTIMING_RESET, 0);
+      else if (strcmp(command, "exchange") == 0) postEvent(BUS_CONSOLE, CMD_EXCHANGE, 0);
+      else if (strcmp(command, "exchange reset") == 0) postEvent(BUS_CONSOLE, CMD_EXCHANGE_RESET, 0);
+      else if (strcmp(command, "qso") == 0) postEvent(BUS_CONSOLE, CMD_QSO, 0);
+      else if (strncmp(command, "qso ", 4) == 0) postEvent(BUS_CONSOLE, CMD_QSO_SHOW, constrain(atoi(command + 4), 0, 255));
+      else if (strcmp(command, "keyer") == 0) postEvent(BUS_CONSOLE, CMD_KEYER, 0);
+      else if (strncmp(command, "keyer ", 6) == 0) {
+        char* rest;
+        long leadMs = constrain(strtol(command + 6, &rest, 10), 0, 255);
+        long hangMs = constrain(strtol(rest, nullptr, 10), 0, 9999);
+        postEvent(BUS_CONSOLE, CMD_KEYER_SET, leadMs << 16 | hangMs);
+      }
+      else if (strcmp(command, "transcript") == 0) postEvent(BUS_CONSOLE, CMD_TRANSCRIPT, 0);
+      else if (strcmp(command, "multicast") == 0) postEvent(BUS_CONSOLE, CMD_MULTICAST, 0);
+      else if (strcmp(command, "energy") == 0) postEvent(BUS_CONSOLE, CMD_ENERGY, 0);
+      else if (strcmp(command, "energy show") == 0) postEvent(BUS_CONSOLE, CMD_ENERGY_SHOW, 0);
+      else if (strcmp(command, "retime") == 0) postEvent(BUS_CONSOLE, CMD_RETIME, 0);
+      else if (strcmp(command, "retime off") == 0) postEvent(BUS_CONSOLE, CMD_RETIME_SET, 0);
+      else if (strncmp(command, "retime ", 7) == 0) {
+        char* rest;
+        long charWpm = constrain(strtol(command + 7, &rest, 10), 0, 255);
+        long effectiveWpm = constrain(strtol(rest, nullptr, 10), 0, 255);  // Sem segundo número = sem Farnsworth
+        postEvent(BUS_CONSOLE, CMD_RETIME_SET, charWpm << 8 | effectiveWpm);
+      }
+      length = 0;
+    } else if (length < sizeof(command) - 1) {
+      command[length++] = c;
+    }
+  }
+}
 
 // Configura inicialização do sistema
 void setup() {
   Serial.begin(115200); // Inicia comunicação serial (115200 baud)
   while (!Serial) { } // Aguarda serial pronta
   for (int i = 0; i < 100 && Serial.available(); i++) Serial.read(); // Descarta dados residuais
-  initNetwork();      // Inicializa Wi-Fi async (scans durante splash)
-  initDisplay();      // Inicializa display OLED (delay 3s para splash)
+  bool warm = loadSnapshot(); // Reset com snapshot válido na RTC: retoma sem splash nem scan
+  if (warm) resumeNetwork(getSnapshotNetwork()); // Volta ao papel anterior (STA/AP) direto
+  else initNetwork(); // Inicializa Wi-Fi async (scans durante splash)
+  initTxPower();      // Potência TX adaptativa (começa no máximo)
+  initMoppGateway();  // Gateway MOPP/UDP (se MOPP_GATEWAY_ENABLED)
+  initMulticast();    // Grupo multicast da turma (se MULTICAST_ENABLED)
+  initDisplay(!warm); // Inicializa display OLED (delay 3s para splash no boot frio)
   initCWTransceiver(); // Configura botão e buzzer
+  initKeyer();        // Saídas KEY/PTT do transmissor (se KEYER_ENABLED)
+  if (warm) applySnapshot(); // Histórico, modo, estado e re-temporização de antes do reset
+  initScrollback();   // Log do histórico na flash (rolagem paginada)
+  initCatchUp();      // Anel de caracteres recentes para clientes que entram depois
+  initRetimer();      // Elementos recebidos: direto ao decodificador ou re-temporizados
+  initExchange();     // Indicativos, RST e trocas extraídos dos caracteres decodificados
+  initTranscript();   // Carimbos HLC e log do histórico na ordem da transcrição (antes do índice de QSOs)
+  initQsoIndex();     // Segmentos de QSO ao lado do log do histórico
+  subscribeEvent(BUS_CONSOLE, onConsoleCommand);
   initBlinker();      // Configura LED para Morse
+  initMetrics();      // Séries temporais de métricas (1s/1min/1h)
+  initEnergy();       // Consumo estimado por subsistema (rádio, CPU, OLED, buzzer, LED)
 }
 
 // Executa loop principal
 void loop() {
-  static unsigned long lastButton = 0, lastDisplay = 0, lastBlinker = 0, lastNetwork = 0; // Temporização de atualizações
+  static unsigned long lastButton = 0, lastDisplay = 0, lastMetrics = 0, lastTxPower = 0, lastSnapshot = 0, lastExchange = 0; // Temporização de atualizações
   unsigned long now = millis(); // Tempo atual
-  if (now - lastButton >= 5) { updateCWTransceiver(); lastButton = now; } // Atualiza Morse a cada 5ms para fluidez
-  if (now - lastDisplay >= 500) { updateDisplay(); lastDisplay = now; } // Atualiza display a cada 500ms
-  if (now - lastBlinker >= 100) { updateBlinker(); lastBlinker = now; } // Atualiza LED a cada 100ms
-  if (now - lastNetwork >= 100) { updateNetwork(); lastNetwork = now; } // Atualiza rede a cada 100ms (non-blocking)
+  unsigned long workStart = micros(); // Atividade da CPU para a contabilidade de energia
+  if (now - lastButton >= 5) { // Atualiza Morse a cada 5ms para fluidez
+    if (lastButton != 0) recordMetric(METRIC_LOOP_LATENESS, now - lastButton - 5); // Atraso do loop além do período
+    updateCWTransceiver();
+    lastButton = now;
+  }
+  if (now - lastDisplay >= 500) { updateScrollback(); updateDisplay(); lastDisplay = now; } // Atualiza display a cada 500ms
+  updateBlinker();    // Tarefa do LED: retoma no fim de cada ponto/traço/intervalo
+  updateRetimer();    // Tarefa de re-temporização: toca os elementos recebidos na velocidade do aluno
+  updateKeyer();      // Transmissor inibido durante a rolagem do histórico
+  runNetworkTask();   // Tarefa de rede: a cada 100ms ou ao chegar dado no socket (non-blocking)
+  updateMoppGateway(); // Traduz MOPP <-> porta 5000 (sem custo se desabilitado)
+  updateMulticast();  // Grupo multicast: recebe, repara por NACK, HEARTBEAT (sem custo se desabilitado)
+  dispatchEvents();   // Entrega elementos, caracteres e comandos publicados nesta volta
+  if (now - lastTxPower >= 1000) { updateTxPower(); updateEnergy(); updateCapture(); lastTxPower = now; } // Ajusta potência TX pelo RSSI no peer, integra o consumo e segue as voltas de micros()
+  if (now - lastExchange >= 100) { updateExchange(); updateTranscript(); updateQsoIndex(); lastExchange = now; } // Fecha palavras, grava caracteres assentados, fecha QSOs após pausa
+  if (now - lastMetrics >= 100) { updateMetrics(); lastMetrics = now; } // Fecha intervalos de métricas
+  if (now - lastSnapshot >= 1000) { updateSnapshot(); lastSnapshot = now; } // Estado na RTC (grava só se mudou)
+  handleSerialCommand(); // Comandos de diagnóstico via Serial
+  noteLoopWork(micros() - workStart);
   yield(); // Permite multitarefa do ESP8266
 }
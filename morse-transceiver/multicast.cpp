@@ -0,0 +1,240 @@
+#include "multicast.h"
+#include <ESP8266WiFi.h>
+#include <WiFiUdp.h>
+#include "mcast-stream.h"
+#include "network.h"
+#include "event-bus.h"
+#include "transcript.h"
+
+#define MULTICAST_JOIN_CHECK 1000  // ms entre verificações do IP da interface
+
+#if MULTICAST_ENABLED
+// Transmissor ouvido no grupo e o estado de reordenação/reparo do fluxo dele
+struct GroupSender {
+  bool used;
+  uint16_t node;
+  unsigned long lastHeard;
+  McastReceiver stream;
+};
+
+static const IPAddress GROUP(239, 77, 67, MULTICAST_CHANNEL);
+static WiFiUDP udp;
+static uint32_t joinedOn = 0;  // IP da interface no grupo (0 = fora)
+static uint16_t node = 0;
+static McastSender sender;
+static GroupSender senders[MULTICAST_SENDERS];
+static unsigned long lastJoinCheck = 0;
+static unsigned long lastPublish = 0;
+static unsigned long lastHeartbeat = 0;
+static uint32_t packetsSent = 0;
+static uint32_t packetsReceived = 0;
+static uint32_t nacksSent = 0;
+static uint32_t skippedConnected = 0;  // Elementos já entregues pelo peer TCP
+
+static void sendPacket(const McastPacket& packet) {
+  uint8_t data[MCAST_MAX_PACKET];
+  size_t length = mcastEncode(packet, data, sizeof(data));
+  if (length == 0 || joinedOn == 0) return;
+  udp.beginPacketMulticast(GROUP, MULTICAST_PORT, IPAddress(joinedOn), 1);
+  udp.write(data, length);
+  udp.endPacket();
+  packetsSent++;
+}
+
+// IP da interface onde o grupo está: STA conectada ou o AP da própria unidade
+static uint32_t groupInterface() {
+  if (WiFi.status() == WL_CONNECTED) return (uint32_t)WiFi.localIP();
+  if (WiFi.getMode() & WIFI_AP) return (uint32_t)WiFi.softAPIP();
+  return 0;
+}
+
+static void checkJoin(unsigned long now) {
+  uint32_t address = groupInterface();
+  if (address == joinedOn) return;
+  if (joinedOn != 0) udp.stop();
+  joinedOn = 0;
+  if (address != 0 && udp.beginMulticast(IPAddress(address), GROUP, MULTICAST_PORT)) joinedOn = address;
+  Serial.print(now);
+  if (joinedOn != 0) {
+    Serial.print(" - Multicast: no grupo ");
+    Serial.print(GROUP);
+    Serial.print(" via ");
+    Serial.println(IPAddress(joinedOn));
+  } else {
+    Serial.println(" - Multicast: fora do grupo (sem IP)");
+  }
+}
+
+// Estado do transmissor node; reaproveita o ouvido há mais tempo
+static GroupSender& senderFor(uint16_t from, unsigned long now) {
+  GroupSender* oldest = &senders[0];
+  for (GroupSender& s : senders) {
+    if (s.used && s.node == from) return s;
+    if (!s.used || (oldest->used && now - s.lastHeard > now - oldest->lastHeard)) oldest = &s;
+  }
+  oldest->used = true;
+  oldest->node = from;
+  oldest->lastHeard = now;
+  mcastReceiverBegin(oldest->stream, (uint32_t)node << 16 ^ from ^ micros());
+  return *oldest;
+}
+
+static void answerNack(const McastPacket& nack, unsigned long now) {
+  McastEvent events[MCAST_NACK_MAX];
+  size_t count = mcastRepair(sender, nack.seq, nack.count, now, events, MCAST_NACK_MAX);
+  for (size_t i = 0; i < count; i++) {
+    McastPacket repair = { MCAST_REPAIR, node, events[i].seq, events[i].duration, events[i].stamp, 0, 0 };
+    sendPacket(repair);  // Para o grupo: serve a todos que perderam a mesma sequência
+  }
+}
+
+static void receivePackets(unsigned long now) {
+  uint8_t data[MCAST_MAX_PACKET + 1];
+  for (uint8_t budget = 0; budget < MULTICAST_READ_BUDGET; budget++) {
+    if (udp.parsePacket() <= 0) return;
+    int length = udp.read(data, sizeof(data));
+    McastPacket packet;
+    if (length <= 0 || !mcastDecode(data, length, packet) || packet.node == node) continue;
+    packetsReceived++;
+    if (packet.type == MCAST_NACK) {
+      if (packet.target == node) {
+        answerNack(packet, now);
+      } else {
+        for (GroupSender& s : senders) {
+          if (s.used && s.node == packet.target) mcastNackHeard(s.stream, packet.seq, now);
+        }
+      }
+      continue;
+    }
+    GroupSender& s = senderFor(packet.node, now);
+    s.lastHeard = now;
+    if (packet.type == MCAST_HEARTBEAT) {
+      mcastHeartbeat(s.stream, packet.seq, now);
+    } else {
+      McastEvent event = { packet.seq, packet.duration, packet.stamp };
+      mcastAccept(s.stream, event, now);
+    }
+  }
+}
+
+// Pede reparos vencidos e entrega ao decodificador o que já está em ordem
+static void serviceStreams(unsigned long now) {
+  uint16_t peer = 0;
+  bool peerKnown = getPeerNode(&peer);
+  for (GroupSender& s : senders) {
+    if (!s.used) continue;
+    // Só o fluxo do peer TCP chega em dobro; sem o node dele ainda, descarta todos por precaução
+    bool viaTcp = isConnected() && (!peerKnown || s.node == peer);
+    uint32_t first;
+    uint8_t count;
+    if (mcastPoll(s.stream, now, first, count)) {
+      McastPacket nack = { MCAST_NACK, node, first, 0, 0, s.node, count };
+      sendPacket(nack);
+      nacksSent++;
+    }
+    McastEvent event;
+    while (mcastNext(s.stream, event)) {
+      if (viaTcp) {  // O peer TCP já entrega os elementos: o grupo só mantém o fluxo em dia
+        skippedConnected++;
+      } else if (event.duration >= 25) {
+        postEvent(BUS_NET_ELEMENT, queueStamp(event.stamp, now), event.duration);
+      }
+    }
+  }
+}
+#endif
+
+void initMulticast() {
+#if MULTICAST_ENABLED
+  uint8_t mac[6];
+  WiFi.macAddress(mac);
+  node = (uint16_t)(mac[4] << 8 | mac[5]);  // Mesmo node do carimbo HLC
+  mcastSenderBegin(sender, ESP.random());  // Sequência aleatória (RNG do hardware): ouvintes veem o reinício como fluxo novo
+  Serial.print(millis());
+  Serial.print(" - Multicast habilitado (canal ");
+  Serial.print(MULTICAST_CHANNEL);
+  Serial.print(", node ");
+  Serial.print(node);
+  Serial.println(")");
+#endif
+}
+
+void updateMulticast() {
+#if MULTICAST_ENABLED
+  unsigned long now = millis();
+  if (now - lastJoinCheck >= MULTICAST_JOIN_CHECK) {
+    checkJoin(now);
+    lastJoinCheck = now;
+  }
+  if (joinedOn == 0) return;
+  receivePackets(now);
+  serviceStreams(now);
+  if (lastPublish != 0 && now - lastPublish < MULTICAST_ACTIVE && now - lastHeartbeat >= MULTICAST_HEARTBEAT) {
+    McastPacket heartbeat = { MCAST_HEARTBEAT, node, sender.nextSeq - 1, 0, 0, 0, 0 };
+    sendPacket(heartbeat);
+    lastHeartbeat = now;
+  }
+#endif
+}
+
+bool multicastReady() {
+#if MULTICAST_ENABLED
+  return joinedOn != 0;
+#else
+  return false;
+#endif
+}
+
+void publishMulticast(unsigned long duration) {
+#if MULTICAST_ENABLED
+  if (joinedOn == 0) return;
+  McastEvent event = mcastPublish(sender, min(duration, 65535UL), getElementStamp());
+  McastPacket data = { MCAST_DATA, node, event.seq, event.duration, event.stamp, 0, 0 };
+  sendPacket(data);
+  lastPublish = millis();
+#else
+  (void)duration;
+#endif
+}
+
+void dumpMulticast(Print& out) {
+#if MULTICAST_ENABLED
+  unsigned long now = millis();
+  out.print(now);
+  out.print(" - Multicast: grupo ");
+  out.print(GROUP);
+  out.print(joinedOn != 0 ? " (dentro)" : " (fora)");
+  out.print(", node ");
+  out.print(node);
+  out.print("; publicados ");
+  out.print(sender.published);
+  out.print(", reparados ");
+  out.print(sender.repaired);
+  out.print(", pacotes enviados ");
+  out.print(packetsSent);
+  out.print(", recebidos ");
+  out.print(packetsReceived);
+  out.print(", NACKs ");
+  out.print(nacksSent);
+  out.print(", ignorados (peer TCP) ");
+  out.println(skippedConnected);
+  for (const GroupSender& s : senders) {
+    if (!s.used) continue;
+    out.print("  node ");
+    out.print(s.node);
+    out.print(": entregues ");
+    out.print(s.stream.delivered);
+    out.print(", recuperados ");
+    out.print(s.stream.recovered);
+    out.print(", perdidos ");
+    out.print(s.stream.lost);
+    out.print(", duplicados ");
+    out.print(s.stream.duplicates);
+    out.print(", ouvido há ");
+    out.print((now - s.lastHeard) / 1000);
+    out.println(" s");
+  }
+#else
+  out.println("Multicast desabilitado (MULTICAST_ENABLED = 0)");
+#endif
+}
@@ -0,0 +1,24 @@
+#ifndef MULTICAST_H
+#define MULTICAST_H
+
+#include <Arduino.h>
+
+#define MULTICAST_ENABLED 0         // 1 = elementos também publicados uma vez num grupo UDP multicast (turma na mesma rede)
+#define MULTICAST_CHANNEL 1         // Canal da turma: grupo 239.77.67.<canal>
+#define MULTICAST_PORT 7374
+#define MULTICAST_HEARTBEAT 1000    // ms entre HEARTBEATs de quem transmite
+#define MULTICAST_ACTIVE 10000      // ms após o último elemento em que ainda manda HEARTBEAT
+#define MULTICAST_SENDERS 4         // Transmissores acompanhados ao mesmo tempo
+#define MULTICAST_READ_BUDGET 4     // Pacotes lidos por chamada de updateMulticast()
+
+void initMulticast(); // Node id do MAC; entra no grupo quando houver IP
+
+void updateMulticast(); // Entra/sai do grupo, lê pacotes, pede e atende reparos, HEARTBEAT
+
+bool multicastReady(); // No grupo: a chave local pode transmitir mesmo sem peer TCP
+
+void publishMulticast(unsigned long duration); // Elemento local (chamada por sendDuration)
+
+void dumpMulticast(Print& out); // Grupo, contadores de envio e recepção por transmissor
+
+#endif
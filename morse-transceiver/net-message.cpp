@@ -0,0 +1,44 @@
+#include "net-message.h"
+
+static const struct {
+  const char* prefix;
+  uint8_t length;
+  NetMessageType type;
+  bool numeric;
+} messagePrefixes[] = {
+  { "ping:", 5, MSG_PING, true },
+  { "pong:", 5, MSG_PONG, true },
+  { "duration:", 9, MSG_DURATION, true },
+  { "txpower:", 8, MSG_TXPOWER, true },
+  { "rssi:", 5, MSG_RSSI, true },
+  { "catchup:", 8, MSG_CATCHUP, false },
+  { "mac:", 4, MSG_MAC, false }
+};
+
+void parseNetMessage(NetMessage& msg) {
+  uint8_t length = msg.length;
+  while (length > 0 && isspace((unsigned char)msg.text[length - 1])) length--;
+  uint8_t start = 0;
+  while (start < length && isspace((unsigned char)msg.text[start])) start++;
+  if (start > 0) memmove(msg.text, msg.text + start, length - start);
+  msg.length = length - start;
+  msg.text[msg.length] = '\0';
+  msg.payload = msg.length;
+  msg.value = 0;
+  msg.type = MSG_UNKNOWN;
+  if (strcmp(msg.text, "alive") == 0) msg.type = MSG_ALIVE;
+  else if (strcmp(msg.text, "request_tx") == 0) msg.type = MSG_REQUEST_TX;
+  else if (strcmp(msg.text, "ok") == 0) msg.type = MSG_OK;
+  else if (strcmp(msg.text, "busy") == 0) msg.type = MSG_BUSY;
+  else if (strcmp(msg.text, "listen") == 0) msg.type = MSG_LISTEN;
+  else {
+    for (const auto& p : messagePrefixes) {
+      if (strncmp(msg.text, p.prefix, p.length) == 0) {
+        msg.type = p.type;
+        msg.payload = p.length;
+        if (p.numeric) msg.value = (long)strtoul(msg.text + p.length, nullptr, 10);  // Aceita millis() > LONG_MAX e negativos
+        break;
+      }
+    }
+  }
+}
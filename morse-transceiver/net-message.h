@@ -0,0 +1,24 @@
+#ifndef NET_MESSAGE_H
+#define NET_MESSAGE_H
+
+#include <Arduino.h>
+
+#define NET_MESSAGE_MAX 48  // Maior linha do protocolo + '\0' (catch-up usa até 47)
+
+enum NetMessageType {
+  MSG_UNKNOWN, MSG_ALIVE, MSG_PING, MSG_PONG, MSG_DURATION, MSG_REQUEST_TX, MSG_OK, MSG_BUSY,
+  MSG_TXPOWER, MSG_RSSI, MSG_CATCHUP, MSG_MAC, MSG_LISTEN
+};
+
+// Linha recebida já classificada: tamanho fixo, sem alocação
+struct NetMessage {
+  NetMessageType type;
+  uint8_t length;   // Bytes em text (sem o '\0')
+  uint8_t payload;  // Início do conteúdo após "tipo:" em text
+  long value;       // Campo numérico (ping/pong/duration/txpower/rssi)
+  char text[NET_MESSAGE_MAX];  // Linha original (para captura e payloads de texto)
+};
+
+void parseNetMessage(NetMessage& msg); // Classifica msg.text/msg.length (remove espaços das pontas)
+
+#endif
@@ -1,9 +1,21 @@
 #include "network.h"
-#include "cw-transceiver.h"  // Para captureInput(REMOTE, duration)
+#include "cw-transceiver.h"  // Para getConnectionState()
+#include "catch-up.h"  // Histórico recente para clientes que entram no meio do QSO
+#include "metrics.h"  // RTT medido por ping/pong
+#include "capture.h"  // Captura de quadros do protocolo (pcap)
+#include "task.h"  // Tarefa cooperativa que acorda com dados no socket
+#include "tx-power.h"  // Controle de potência pelo RSSI no peer
+#include "net-message.h"  // Linhas recebidas classificadas em registros fixos
+#include "lwip-link.h"  // Transporte alternativo pelos callbacks do lwIP (NET_RAW_LWIP)
+#include "event-bus.h"  // Elementos recebidos seguem para o decodificador pelo barramento
+#include "transcript.h"  // Carimbo HLC no sufixo de "duration:"
+#include "multicast.h"  // Publicação dos elementos no grupo da turma
+#include "hlc.h"  // Node do peer no carimbo dos elementos dele
 
 static ESP8266WiFiMulti wifiMulti;  // Não usado; mantido para compatibilidade
 static WiFiServer server(5000);
 static WiFiClient client;
+static WiFiClient listener;  // Observador passivo (gravador): recebe cópia do tráfego, nunca é o peer
 static const char* SSID = "morse-transceiver";
 static const char* PASS = "";  // Sem senha para simplicidade
 static const IPAddress AP_IP(192, 168, 4, 1);
@@ -11,25 +23,228 @@ static const unsigned long SCAN_TIMEOUT = 5000;  // Timeout per scan attempt
 static const unsigned long SCAN_INTERVAL = 500;  // Intervalo para verificar scan
 static const unsigned long CONNECT_TIMEOUT = 5000;  // 5s for connect
 static const unsigned long RETRY_INTERVAL_BASE = 10000;  // Retry STA base 10s
-static const unsigned long STATUS_CHECK_INTERVAL = 5000;  // Check WiFi.status() a cada 5s
+static const unsigned long RETRY_INTERVAL_MAX = 60000;  // Backoff para de crescer em 60s
 static const unsigned long HEARTBEAT_INTERVAL = 1000;  // Send "alive" every 1s when connected
 static const unsigned long HEARTBEAT_TIMEOUT = 3000;  // Timeout if no heartbeat
+static const unsigned long NETWORK_TICK = 100;  // Período máximo entre execuções do FSM
+static const int RX_BYTE_BUDGET = 128;  // Máximo de bytes lidos do socket por execução
+static const int RX_LINE_BUDGET = 4;  // Máximo de mensagens tratadas por execução
+static const uint8_t EVENT_QUEUE_SIZE = 8;  // Eventos de Wi-Fi pendentes (potência de 2)
 static unsigned long lastHeartbeatSent = 0;
+#if !NET_RAW_LWIP
+static unsigned long lastListenerAlive = 0;
+static unsigned long listenerSince = 0;  // Aceito com o peer ocupado: precisa se anunciar com "listen"
+static bool listenerReady = false;
+static unsigned long mirrorDropped = 0;  // Cópias descartadas com o buffer de envio do observador cheio
+#endif
 static unsigned long lastHeartbeatReceived = 0;
-static unsigned long lastStatusCheck = 0;
 static unsigned long lastScan = 0;
 static unsigned long connectStart = 0;
 static unsigned long lastRetry = 0;
 static unsigned long retryDelay = RETRY_INTERVAL_BASE;  // Backoff inicia 10s
 static int scanAttempts = 0;
 static bool scanInProgress = false;
-static bool scanPollingPrinted = false;  // To avoid repetition
-static int lastScanResult = -2;  // Último resultado de scanComplete para evitar prints repetidos
 static int asyncFailCount = 0;  // Contador de falhas de scan assíncrono
+static NetMessage rxMessage;  // Linha parcial (WiFiClient); sobra de uma execução continua na próxima
+static bool rxOverflow = false;  // Linha longa demais: descarta até o próximo '\n'
+static bool staLinkUp = false;  // STA associada e com IP (mantido pelos eventos)
+static volatile uint8_t eventHead = 0;  // Escrito só pelos handlers do core / shim
+static volatile uint8_t eventTail = 0;  // Escrito só pelo FSM
+static NetworkEvent eventQueue[EVENT_QUEUE_SIZE];
+static unsigned long eventsDropped = 0;
+static uint16_t peerNode = 0;  // MAC baixo do peer TCP (mesmo node do HLC e do multicast)
+static bool peerNodeKnown = false;
+static WiFiEventHandler gotIpHandler;  // O core só mantém o handler enquanto houver referência
+static WiFiEventHandler disconnectedHandler;
+static WiFiEventHandler stationConnectedHandler;
+static WiFiEventHandler stationDisconnectedHandler;
+static bool resumedStaticIp = false;  // Retomada com o IP anterior fixo: volta ao DHCP se falhar
 NetworkState netState = SCANNING;  // Definido como extern no header
 
+// Transporte da porta 5000: WiFiClient/WiFiServer ou callbacks do lwIP (NET_RAW_LWIP)
+static bool linkConnected() {
+#if NET_RAW_LWIP
+  return rawLinkConnected();
+#else
+  return client.connected();
+#endif
+}
+
+static bool linkDataPending() {
+#if NET_RAW_LWIP
+  return rawLinkPending();
+#else
+  return client.available() > 0;
+#endif
+}
+
+static void linkStop() {
+#if NET_RAW_LWIP
+  rawLinkClose();
+#else
+  client.stop();
+#endif
+}
+
+static bool linkConnect() {
+  rxMessage.length = 0;
+  rxOverflow = false;
+  peerNodeKnown = false;
+#if NET_RAW_LWIP
+  return rawLinkConnect(AP_IP, 5000);
+#else
+  return client.connect(AP_IP, 5000);
+#endif
+}
+
+static void linkListen() {
+#if NET_RAW_LWIP
+  rawLinkListen(5000);
+#else
+  server.begin();
+#endif
+}
+
+// true quando um cliente novo foi aceito (AP)
+static bool linkAccept() {
+#if NET_RAW_LWIP
+  return rawLinkAccepted();
+#else
+  WiFiClient newClient = server.available();
+  if (!newClient) return false;
+  if (client.connected()) {
+    // Peer ocupado: só um observador por vez, e ele tem HEARTBEAT_TIMEOUT para dizer "listen"
+    if (listener.connected()) return false;
+    listener = newClient;
+    listenerReady = false;
+    listenerSince = millis();
+    return false;
+  }
+  client = newClient;
+  rxMessage.length = 0;
+  rxOverflow = false;
+  return true;
+#endif
+}
+
+// Envia uma linha do protocolo (terminada em '\n') e registra na captura
+static void sendLine(const char* line) {
+#if NET_RAW_LWIP
+  if (!rawLinkSend(line)) return;  // Buffer de envio cheio: descarta como um quadro perdido
+#else
+  client.print(line);
+  client.print("\n");
+  client.flush();
+#endif
+  captureFrame(CAPTURE_TX, line, strlen(line));
+  noteTxFrame();
+}
+
+// Cópia para o observador: "duration:" local, "peer:duration:" recebido, "mac:"; sem captura.
+// Observador lento não segura o loop: sem espaço no buffer de envio a linha é descartada
+static void mirrorLine(const char* prefix, const char* line) {
+#if !NET_RAW_LWIP
+  if (!listenerReady || !listener.connected()) return;
+  char out[NET_MESSAGE_MAX + 8];
+  int length = snprintf(out, sizeof(out), "%s%s\n", prefix, line);
+  if (length <= 0 || length >= (int)sizeof(out)) return;
+  if (listener.availableForWrite() < length) {
+    mirrorDropped++;
+    return;
+  }
+  listener.write(reinterpret_cast<const uint8_t*>(out), length);
+#else
+  (void)prefix;
+  (void)line;
+#endif
+}
+
+#if !NET_RAW_LWIP
+// Conexão que se anunciou com "listen" vira observador; a vaga de peer fica livre
+static void promoteListener(WiFiClient& from, unsigned long now) {
+  if (&from != &listener) {
+    if (listener.connected()) listener.stop();
+    listener = from;
+    from = WiFiClient();
+  }
+  listenerReady = true;
+  lastListenerAlive = 0;  // Heartbeat próprio já no próximo tick
+  mirrorLine("mac:", WiFi.macAddress().c_str());
+  Serial.print(now);
+  Serial.println(" - Observador conectado (listen); recebe cópia dos elementos");
+}
+#endif
+
+// Observador: descarta o que ele mandar (só "alive"), mantém heartbeat e expira quem não se anunciou
+static void serviceListener(unsigned long now) {
+#if !NET_RAW_LWIP
+  if (!listener.connected()) {
+    if (listenerReady) {
+      listenerReady = false;
+      Serial.print(now);
+      Serial.print(" - Observador desconectado (");
+      Serial.print(mirrorDropped);
+      Serial.println(" linhas descartadas com o buffer cheio)");
+      mirrorDropped = 0;
+    }
+    return;
+  }
+  static char line[8];
+  static size_t length = 0;
+  int bytes = 0;
+  while (bytes < RX_BYTE_BUDGET && listener.available() > 0) {  // Mesmo orçamento do peer: o resto fica para a próxima execução
+    int c = listener.read();
+    bytes++;
+    if (c == '\n') {
+      line[length] = '\0';
+      if (!listenerReady && strncmp(line, "listen", 6) == 0) promoteListener(listener, now);
+      length = 0;
+    } else if (c >= 0 && length < sizeof(line) - 1) {
+      line[length++] = (char)c;
+    }
+  }
+  if (!listenerReady) {
+    if (now - listenerSince > HEARTBEAT_TIMEOUT) listener.stop();
+  } else if (now - lastListenerAlive > HEARTBEAT_INTERVAL) {
+    mirrorLine("", "alive");
+    lastListenerAlive = now;
+  }
+#else
+  (void)now;
+#endif
+}
+
+void injectNetworkEvent(NetworkEvent event) {
+  uint8_t head = eventHead;
+  if ((uint8_t)(head - eventTail) >= EVENT_QUEUE_SIZE) {
+    eventsDropped++;
+    return;
+  }
+  eventQueue[head % EVENT_QUEUE_SIZE] = event;
+  eventHead = head + 1;
+}
+
+bool networkEventPending() {
+  return eventHead != eventTail;
+}
+
+// Mudanças de enlace chegam como eventos do core; o FSM os consome no próximo tick
+// Toda (re)associação passa por aqui: staLinkUp só volta com o got-IP desta tentativa
+static void beginStation(int32_t channel = 0, const uint8_t* bssid = nullptr) {
+  staLinkUp = false;
+  WiFi.begin(SSID, PASS, channel, bssid);
+}
+
+static void registerEventHandlers() {
+  gotIpHandler = WiFi.onStationModeGotIP([](const WiFiEventStationModeGotIP&) { injectNetworkEvent(NET_EVENT_GOT_IP); });
+  disconnectedHandler = WiFi.onStationModeDisconnected([](const WiFiEventStationModeDisconnected&) { injectNetworkEvent(NET_EVENT_STA_DISCONNECTED); });
+  stationConnectedHandler = WiFi.onSoftAPModeStationConnected([](const WiFiEventSoftAPModeStationConnected&) { injectNetworkEvent(NET_EVENT_AP_STATION_CONNECTED); });
+  stationDisconnectedHandler = WiFi.onSoftAPModeStationDisconnected([](const WiFiEventSoftAPModeStationDisconnected&) { injectNetworkEvent(NET_EVENT_AP_STATION_DISCONNECTED); });
+}
+
 void initNetwork() {
   unsigned long now = millis();
+  registerEventHandlers();
   randomSeed(analogRead(0));  // Seed for random
   delay(random(0, 2000));  // Random delay to desincronizar starts
   Serial.print(now);
@@ -40,7 +255,6 @@ void initNetwork() {
   WiFi.setPhyMode(WIFI_PHY_MODE_11G);  // For stability
   WiFi.scanNetworks(true, true);  // Async scan, mostrar ocultas
   scanInProgress = true;
-  scanPollingPrinted = false;
   lastScan = now;
   scanAttempts = 1;
   asyncFailCount = 0;
@@ -48,401 +262,571 @@ void initNetwork() {
   Serial.println(" - Iniciando busca async por SSID: morse-transceiver (STA primeiro during splash)");
 }
 
-// Atualização não bloqueante
-void updateNetwork() {
+void resumeNetwork(const NetworkResume& resume) {
   unsigned long now = millis();
-  WiFiClient newClient;  // Evita cruzamento em switch
-  // Check WiFi.status() periodicamente
-  if (now - lastStatusCheck > STATUS_CHECK_INTERVAL) {
+  if (resume.role != CONNECTED && resume.role != AP_MODE) {
+    initNetwork();
+    return;
+  }
+  registerEventHandlers();
+  WiFi.setPhyMode(WIFI_PHY_MODE_11G);
+  if (resume.role == CONNECTED) {
+    // Canal e BSSID conhecidos dispensam o scan; IP fixo dispensa o DHCP
+    WiFi.mode(WIFI_STA);
+    WiFi.config(IPAddress(resume.localIp), AP_IP, IPAddress(255, 255, 255, 0));
+    beginStation(resume.channel, resume.bssid);
+    resumedStaticIp = true;
+    netState = CONNECTING;
+    connectStart = now;
     Serial.print(now);
-    Serial.print(" - WiFi status: ");
-    uint8_t status = WiFi.status();
-    Serial.print(status);
-    Serial.print(" (");
-    switch (status) {
-      case WL_IDLE_STATUS: Serial.print("IDLE"); break;
-      case WL_NO_SSID_AVAIL: Serial.print("NO SSID"); break;
-      case WL_SCAN_COMPLETED: Serial.print("SCAN COMPLETED"); break;
-      case WL_CONNECTED: Serial.print("CONNECTED"); break;
-      case WL_CONNECT_FAILED: Serial.print("CONNECT FAILED"); break;
-      case WL_CONNECTION_LOST: Serial.print("CONNECTION LOST"); break;
-      case WL_DISCONNECTED: Serial.print("DISCONNECTED"); break;
-      default: Serial.print("UNKNOWN"); break;
-    }
-    Serial.println(")");
-    lastStatusCheck = now;
+    Serial.print(" - Retomando como STA no canal ");
+    Serial.print(resume.channel);
+    Serial.print(" com IP ");
+    Serial.println(IPAddress(resume.localIp));
+  } else {
+    WiFi.mode(WIFI_AP_STA);
+    WiFi.softAP(SSID, PASS, resume.channel);
+    linkListen();
+    netState = AP_MODE;
+    lastRetry = now;
+    Serial.print(now);
+    Serial.print(" - Retomando como AP no canal ");
+    Serial.println(resume.channel);
   }
+}
 
-  switch (netState) {
-    case SCANNING: {
-      if (now - lastScan < SCAN_INTERVAL) break;  // Verifica a cada 500ms
-      int n = WiFi.scanComplete();
-      if (n != lastScanResult) {
-        Serial.print(now);
-        Serial.print(" - scanComplete returned: ");
-        Serial.println(n);
-        lastScanResult = n;
+void getNetworkResume(NetworkResume& out) {
+  memset(&out, 0, sizeof(out));
+  out.role = netState;
+  if (netState == CONNECTED) {
+    out.channel = WiFi.channel();
+    memcpy(out.bssid, WiFi.BSSID(), sizeof(out.bssid));
+    out.localIp = (uint32_t)WiFi.localIP();
+  } else if (netState == AP_MODE) {
+    out.channel = WiFi.channel();
+  }
+}
+
+// Trata uma mensagem recebida (mesmo protocolo nos papéis STA e AP)
+static void handleMessage(const NetMessage& msg, unsigned long now) {
+  captureFrame(CAPTURE_RX, msg.text, msg.length);
+  switch (msg.type) {
+    case MSG_ALIVE:
+      lastHeartbeatReceived = now;
+      Serial.print(now);
+      Serial.println(" - Recebido heartbeat 'alive'");
+      break;
+    case MSG_PING: {
+      char pong[16];
+      snprintf(pong, sizeof(pong), "pong:%s", msg.text + msg.payload);
+      sendLine(pong);
+      break;
+    }
+    case MSG_PONG:
+      recordMetric(METRIC_RTT, now - (unsigned long)msg.value);
+      break;
+    case MSG_TXPOWER:
+      if (netState == CONNECTED) reportPeerTxPower(msg.value);
+      break;
+    case MSG_RSSI:
+      if (netState == AP_MODE) reportPeerRssi(msg.value);
+      break;
+    case MSG_DURATION: {
+      mirrorLine("peer:", msg.text);
+      // Elemento local do peer: o node do carimbo é o dele (o AP não recebe "mac:" do cliente)
+      Hlc stamp;
+      if (!peerNodeKnown && hlcParse(msg.text, stamp)) {
+        peerNode = stamp.node;
+        peerNodeKnown = true;
       }
-      if (n == WIFI_SCAN_RUNNING) {
-        if (!scanPollingPrinted) {
-          Serial.print(now);
-          Serial.println(" - Scan em andamento...");
-          scanPollingPrinted = true;
-        }
-        if (now - lastScan > SCAN_TIMEOUT) {
-          Serial.print(now);
-          Serial.println(" - Scan timeout; assumindo falha, incrementando tentativa");
-          WiFi.scanDelete();  // Limpa scan travado
-          scanInProgress = false;
-          scanPollingPrinted = false;
-          lastScanResult = -2;
-          scanAttempts++;
-          asyncFailCount++;
-        }
-      } else if (n == WIFI_SCAN_FAILED) {
+      if (msg.value >= 25) {
         Serial.print(now);
-        Serial.println(" - Scan falhou; tentando novamente");
-        asyncFailCount++;
-        WiFi.scanDelete();
-        scanInProgress = false;
-        scanPollingPrinted = false;
-        lastScanResult = -2;
-        scanAttempts++;
-      } else if (n >= 0 && scanAttempts <= 3) {
-        scanInProgress = false;
-        scanPollingPrinted = false;
-        lastScanResult = -2;
-        Serial.print(now);
-        Serial.print(" - Redes encontradas na tentativa ");
-        Serial.print(scanAttempts);
-        Serial.println(":");
-        bool found = false;
-        int targetChannel = 1;  // Default channel
-        String targetBSSID = "";  // Para eleição
-        int bestRSSI = -200;  // Para escolher melhor
-        int numSameSSID = 0;
-        for (int i = 0; i < n; ++i) {
-          Serial.print(now);
-          Serial.print(" - SSID: ");
-          Serial.print(WiFi.SSID(i));
-          Serial.print(", RSSI: ");
-          Serial.print(WiFi.RSSI(i));
-          Serial.print(" dBm, Canal: ");
-          Serial.print(WiFi.channel(i));
-          Serial.print(", Encryption: ");
-          Serial.print(WiFi.encryptionType(i));
-          Serial.print(", BSSID: ");
-          Serial.println(WiFi.BSSIDstr(i));
-          if (strcmp(WiFi.SSID(i).c_str(), SSID) == 0) {
-            numSameSSID++;
-            if (WiFi.RSSI(i) > bestRSSI) {
-              bestRSSI = WiFi.RSSI(i);
-              targetChannel = WiFi.channel(i);
-              targetBSSID = WiFi.BSSIDstr(i);
-            }
-          }
-        }
-        WiFi.scanDelete();  // Limpa resultados após processar
-        if (numSameSSID > 1) {
-          Serial.print(now);
-          Serial.println(" - Múltiplos APs com mesmo SSID; iniciando negociação");
-          WiFi.begin(SSID, PASS, targetChannel);  // Conecta ao melhor canal
-          netState = CONNECTING;
-          connectStart = now;
-        } else if (numSameSSID == 1) {
-          found = true;
-          Serial.print(now);
-          Serial.println(" - SSID alvo encontrado, iniciando conexão como STA");
-          WiFi.begin(SSID, PASS, targetChannel);
-          netState = CONNECTING;
-          connectStart = now;
-          WiFi.printDiag(Serial);  // Diagnóstico: modo, status, etc.
-        } else {
-          Serial.print(now);
-          Serial.print(" - Tentativa ");
-          Serial.print(scanAttempts);
-          Serial.println(" sem SSID alvo; proximo scan");
-          WiFi.scanNetworks(true);
-          scanInProgress = true;
-          scanPollingPrinted = false;
-          lastScan = now;
-          scanAttempts++;
-        }
+        Serial.print(netState == AP_MODE ? " - Recebido duration remoto (AP): " : " - Recebido duration remoto: ");
+        Serial.println(msg.value);
+        postEvent(BUS_NET_ELEMENT, queueRemoteStamp(msg.text, now), msg.value);  // Decodificação fora da leitura do socket
       }
-      if (scanAttempts > 3 && !scanInProgress) {
-        Serial.print(now);
-        Serial.println(" - Nenhum SSID alvo encontrado após tentativas ou falhas; iniciando AP e mantendo STA retry (dual mode)");
-        WiFi.mode(WIFI_AP_STA);
-        WiFi.softAP(SSID, PASS, 1);  // Inicia AP no canal 1
-        Serial.print(now);
-        Serial.print(" - AP iniciado com SSID: ");
-        Serial.print(SSID);
-        Serial.print(", IP: ");
-        Serial.print(WiFi.softAPIP());
-        Serial.print(", MAC: ");
-        Serial.print(WiFi.softAPmacAddress());
-        Serial.print(", Clientes conectados: ");
-        Serial.println(WiFi.softAPgetStationNum());
-        WiFi.printDiag(Serial);  // Diagnóstico AP+STA
-        server.begin();
-        netState = AP_MODE;
-        lastRetry = now;
-        asyncFailCount = 0;
-        // Tentar scan síncrono como fallback
-        Serial.print(now);
-        Serial.println(" - Tentando scan síncrono como fallback");
-        int n = WiFi.scanNetworks(false, true);  // Scan síncrono
+      break;
+    }
+    case MSG_REQUEST_TX:
+      if (getConnectionState() == FREE) {
+        sendLine("ok");
         Serial.print(now);
-        Serial.print(" - Scan síncrono retornou: ");
-        Serial.println(n);
-        if (n > 0) {
-          for (int i = 0; i < n; ++i) {
-            Serial.print(now);
-            Serial.print(" - SSID: ");
-            Serial.print(WiFi.SSID(i));
-            Serial.print(", RSSI: ");
-            Serial.print(WiFi.RSSI(i));
-            Serial.print(" dBm, Canal: ");
-            Serial.print(WiFi.channel(i));
-            Serial.print(", Encryption: ");
-            Serial.print(WiFi.encryptionType(i));
-            Serial.print(", BSSID: ");
-            Serial.println(WiFi.BSSIDstr(i));
-            if (strcmp(WiFi.SSID(i).c_str(), SSID) == 0) {
-              Serial.print(now);
-              Serial.println(" - SSID alvo encontrado em scan síncrono, iniciando conexão");
-              WiFi.begin(SSID, PASS, WiFi.channel(i));
-              netState = CONNECTING;
-              connectStart = now;
-              break;
-            }
-          }
-          WiFi.scanDelete();
-        }
-      } else if (!scanInProgress) {
-        // Iniciar próximo scan
-        WiFi.scanNetworks(true, true);
+        Serial.println(" - Enviado 'ok' para request_tx");
+      } else {
+        sendLine("busy");
         Serial.print(now);
-        Serial.println(" - Iniciando novo scan assíncrono");
-        scanInProgress = true;
-        scanPollingPrinted = false;
-        lastScan = now;
-        lastScanResult = -2;
+        Serial.println(" - Enviado 'busy' para request_tx");
       }
       break;
-    }
-    case CONNECTING:
-      if (WiFi.status() == WL_CONNECTED) {
+    case MSG_CATCHUP:
+      if (netState == CONNECTED) applyCatchUpLine(msg.text + msg.payload);
+      break;
+    case MSG_MAC: {
+      unsigned int high, low;
+      if (sscanf(msg.text + msg.payload, "%*x:%*x:%*x:%*x:%x:%x", &high, &low) == 2) {
+        peerNode = (uint16_t)(high << 8 | low);  // Mesma conta do node em initMulticast()
+        peerNodeKnown = true;
+      }
+      String myMac = WiFi.macAddress();
+      if (strcmp(myMac.c_str(), msg.text + msg.payload) > 0 && (netState == AP_MODE || WiFi.getMode() == WIFI_AP_STA)) {
         Serial.print(now);
-        Serial.println(" - Conectado como STA; conectando TCP ao servidor");
-        WiFi.printDiag(Serial);  // Diagnóstico STA
-        if (client.connect(AP_IP, 5000)) {
-          netState = CONNECTED;
-          Serial.print(now);
-          Serial.println(" - TCP cliente conectado");
-          // Iniciar negotiation if needed (ex.: send MAC)
-        } else {
-          Serial.print(now);
-          Serial.println(" - Falha TCP cliente (verifique se AP está ativo no peer); retry em 5s");
-          connectStart = now;
-          WiFi.printDiag(Serial);  // Diagnóstico falha
-        }
-      } else if (now - connectStart > CONNECT_TIMEOUT) {
+        Serial.println(" - Meu MAC é maior; revertendo para STA");
+        WiFi.softAPdisconnect(true);
+        WiFi.mode(WIFI_STA);
+        beginStation();
+        netState = CONNECTING;
+        connectStart = now;
+      } else {
         Serial.print(now);
-        Serial.println(" - Timeout conexão STA; indo para DISCONNECTED");
-        netState = DISCONNECTED;
-        lastRetry = now;
-        WiFi.printDiag(Serial);  // Diagnóstico falha
+        Serial.println(" - Meu MAC é menor; permanecendo como AP");
       }
       break;
-    case CONNECTED:
-      if (!client.connected()) {
-        netState = DISCONNECTED;
+    }
+    case MSG_LISTEN:
+#if !NET_RAW_LWIP
+      if (netState == AP_MODE) promoteListener(client, now);  // Gravador entrou com a vaga livre: não é peer
+#endif
+      break;
+    default:
+      break;
+  }
+}
+
+// Lê o socket dentro do orçamento da execução; o que sobrar fica no buffer do
+// lwIP para a próxima, e a tecla é amostrada entre uma fatia e outra
+static void receiveLines(unsigned long now) {
+  NetworkState state = netState;
+  int lines = 0;
+#if NET_RAW_LWIP
+  // Já analisadas nos callbacks do lwIP: só entrega os registros
+  const NetMessage* msg;
+  while (lines < RX_LINE_BUDGET && netState == state && (msg = rawLinkFront()) != nullptr) {
+    handleMessage(*msg, now);
+    rawLinkPop();
+    lines++;
+  }
+  recordMetric(METRIC_RX_BACKLOG, rawLinkBacklog());
+#else
+  int bytes = 0;
+  while (bytes < RX_BYTE_BUDGET && lines < RX_LINE_BUDGET && netState == state && client.available() > 0) {
+    int c = client.read();
+    if (c < 0) break;
+    bytes++;
+    if (c == '\n') {
+      if (!rxOverflow) {
+        parseNetMessage(rxMessage);
+        handleMessage(rxMessage, now);
+        lines++;
+      }
+      rxMessage.length = 0;
+      rxOverflow = false;
+    } else if (rxMessage.length < NET_MESSAGE_MAX - 1) {
+      rxMessage.text[rxMessage.length++] = (char)c;
+    } else {
+      rxOverflow = true;
+    }
+  }
+  recordMetric(METRIC_RX_BACKLOG, client.available());
+#endif
+}
+
+// Aplica os eventos de Wi-Fi enfileirados (substitui o polling de WiFi.status())
+static void handleNetworkEvents(unsigned long now) {
+  while (eventTail != eventHead) {
+    NetworkEvent event = eventQueue[eventTail % EVENT_QUEUE_SIZE];
+    eventTail = eventTail + 1;
+    switch (event) {
+      case NET_EVENT_GOT_IP:
+        staLinkUp = true;
         Serial.print(now);
-        Serial.println(" - TCP desconectado; indo para DISCONNECTED");
-        lastRetry = now;
-      } else {
-        // Heartbeat
-        if (now - lastHeartbeatSent > HEARTBEAT_INTERVAL) {
-          client.print("alive\n");
-          client.flush();
-          lastHeartbeatSent = now;
-          Serial.print(now);
-          Serial.println(" - Enviado heartbeat 'alive'");
-        }
-        if (now - lastHeartbeatReceived > HEARTBEAT_TIMEOUT) {
-          Serial.print(now);
-          Serial.println(" - Heartbeat timeout; indo para DISCONNECTED");
-          client.stop();
+        Serial.print(" - Evento: STA com IP ");
+        Serial.println(WiFi.localIP());
+        break;
+      case NET_EVENT_STA_DISCONNECTED:
+        if (!staLinkUp) break;  // O core repete o evento a cada tentativa de associação
+        staLinkUp = false;
+        Serial.print(now);
+        Serial.println(" - Evento: STA desassociada");
+        if (netState == CONNECTED) {
+          linkStop();
+          txPowerLinkLost();
           netState = DISCONNECTED;
           lastRetry = now;
+          Serial.print(now);
+          Serial.println(" - Enlace perdido; indo para DISCONNECTED");
         }
-        // Receber pacotes
-        while (client.available()) {
-          String line = client.readStringUntil('\n');
-          line.trim();
-          if (line == "alive") {
-            lastHeartbeatReceived = now;
-            Serial.print(now);
-            Serial.println(" - Recebido heartbeat 'alive'");
-          } else if (line.startsWith("duration:")) {
-            unsigned long dur = line.substring(9).toInt();
-            if (dur >= 25) {
-              Serial.print(now);
-              Serial.print(" - Recebido duration remoto: ");
-              Serial.println(dur);
-              captureInput(REMOTE, dur);
-            }
-          } else if (line == "request_tx") {
-            if (getConnectionState() == FREE) {
-              client.print("ok\n");
-              client.flush();
-              Serial.print(now);
-              Serial.println(" - Enviado 'ok' para request_tx");
-            } else {
-              client.print("busy\n");
-              client.flush();
-              Serial.print(now);
-              Serial.println(" - Enviado 'busy' para request_tx");
-            }
-          } else if (line.startsWith("mac:")) {
-            String remoteMac = line.substring(4);
-            String myMac = WiFi.macAddress();
-            if (myMac > remoteMac && WiFi.getMode() == WIFI_AP_STA) {
-              Serial.print(now);
-              Serial.println(" - Meu MAC é maior; revertendo para STA");
-              WiFi.softAPdisconnect(true);
-              WiFi.mode(WIFI_STA);
-              WiFi.begin(SSID, PASS);
-              netState = CONNECTING;
-              connectStart = now;
-            } else {
-              Serial.print(now);
-              Serial.println(" - Meu MAC é menor; permanecendo como AP");
-            }
-          }
-        }
-      }
-      break;
-    case AP_MODE:
-      newClient = server.available();
-      if (newClient && !client.connected()) {
-        client = newClient;
-        Serial.print(now);
-        Serial.println(" - Cliente TCP conectado ao AP");
+        break;
+      case NET_EVENT_AP_STATION_CONNECTED:
         Serial.print(now);
-        Serial.print(" - Clientes conectados: ");
+        Serial.print(" - Evento: estação entrou no AP; clientes: ");
         Serial.println(WiFi.softAPgetStationNum());
-        // Enviar MAC para negociação
-        String myMac = WiFi.macAddress();
-        client.print("mac:" + myMac + "\n");
-        client.flush();
+        break;
+      case NET_EVENT_AP_STATION_DISCONNECTED:
         Serial.print(now);
-        Serial.print(" - Enviado MAC para negociação: ");
-        Serial.println(myMac);
-      }
-      if (client.connected()) {
-        // Heartbeat
-        if (now - lastHeartbeatSent > HEARTBEAT_INTERVAL) {
-          client.print("alive\n");
-          client.flush();
-          lastHeartbeatSent = now;
-          Serial.print(now);
-          Serial.println(" - Enviado heartbeat 'alive'");
-        }
-        if (now - lastHeartbeatReceived > HEARTBEAT_TIMEOUT) {
+        Serial.print(" - Evento: estação saiu do AP; clientes: ");
+        Serial.println(WiFi.softAPgetStationNum());
+        if (netState == AP_MODE && linkConnected() && WiFi.softAPgetStationNum() == 0) {
+          linkStop();  // Sem estação não há peer: não espera o timeout de heartbeat
+          txPowerLinkLost();
           Serial.print(now);
-          Serial.println(" - Heartbeat timeout; indo para DISCONNECTED");
-          client.stop();
-          netState = DISCONNECTED;
-          lastRetry = now;
-        }
-        // Receber pacotes
-        while (client.available()) {
-          String line = client.readStringUntil('\n');
-          line.trim();
-          if (line == "alive") {
-            lastHeartbeatReceived = now;
-            Serial.print(now);
-            Serial.println(" - Recebido heartbeat 'alive'");
-          } else if (line.startsWith("duration:")) {
-            unsigned long dur = line.substring(9).toInt();
-            if (dur >= 25) {
-              Serial.print(now);
-              Serial.print(" - Recebido duration remoto (AP): ");
-              Serial.println(dur);
-              captureInput(REMOTE, dur);
-            }
-          } else if (line == "request_tx") {
-            if (getConnectionState() == FREE) {
-              client.print("ok\n");
-              client.flush();
-              Serial.print(now);
-              Serial.println(" - Enviado 'ok' para request_tx");
-            } else {
-              client.print("busy\n");
-              client.flush();
-              Serial.print(now);
-              Serial.println(" - Enviado 'busy' para request_tx");
-            }
-          } else if (line.startsWith("mac:")) {
-            String remoteMac = line.substring(4);
-            String myMac = WiFi.macAddress();
-            if (myMac > remoteMac) {
-              Serial.print(now);
-              Serial.println(" - Meu MAC é maior; revertendo para STA");
-              WiFi.softAPdisconnect(true);
-              WiFi.mode(WIFI_STA);
-              WiFi.begin(SSID, PASS);
-              netState = CONNECTING;
-              connectStart = now;
-            } else {
-              Serial.print(now);
-              Serial.println(" - Meu MAC é menor; permanecendo como AP");
-            }
-          }
+          Serial.println(" - Peer saiu do AP; aguardando novo cliente");
         }
+        break;
+    }
+  }
+  if (eventsDropped > 0) {
+    Serial.print(now);
+    Serial.print(" - Eventos de Wi-Fi descartados (fila cheia): ");
+    Serial.println(eventsDropped);
+    eventsDropped = 0;
+  }
+}
+
+// Tempo que falta de interval contado desde since (0 se já passou)
+static unsigned long remaining(unsigned long since, unsigned long interval) {
+  unsigned long elapsed = millis() - since;
+  return elapsed < interval ? interval - elapsed : 0;
+}
+
+static void printNetworks(int n, unsigned long now) {
+  for (int i = 0; i < n; ++i) {
+    Serial.print(now);
+    Serial.print(" - SSID: ");
+    Serial.print(WiFi.SSID(i));
+    Serial.print(", RSSI: ");
+    Serial.print(WiFi.RSSI(i));
+    Serial.print(" dBm, Canal: ");
+    Serial.print(WiFi.channel(i));
+    Serial.print(", Encryption: ");
+    Serial.print(WiFi.encryptionType(i));
+    Serial.print(", BSSID: ");
+    Serial.println(WiFi.BSSIDstr(i));
+  }
+}
+
+static void startScan(unsigned long now) {
+  WiFi.scanNetworks(true, true);  // Assíncrono, mostrando ocultas
+  Serial.print(now);
+  Serial.println(" - Iniciando novo scan assíncrono");
+  scanInProgress = true;
+  lastScan = now;
+}
+
+// Fim de um scan (ou timeout dele): associa ao melhor AP com o SSID alvo ou conta a tentativa
+static void finishScan(int n, unsigned long now) {
+  Serial.print(now);
+  Serial.print(" - scanComplete returned: ");
+  Serial.println(n);
+  scanInProgress = false;
+  if (n == WIFI_SCAN_RUNNING) {
+    Serial.print(now);
+    Serial.println(" - Scan timeout; assumindo falha, incrementando tentativa");
+    WiFi.scanDelete();  // Limpa scan travado
+    scanAttempts++;
+    asyncFailCount++;
+    return;
+  }
+  if (n < 0) {
+    Serial.print(now);
+    Serial.println(" - Scan falhou; tentando novamente");
+    WiFi.scanDelete();
+    scanAttempts++;
+    asyncFailCount++;
+    return;
+  }
+  Serial.print(now);
+  Serial.print(" - Redes encontradas na tentativa ");
+  Serial.print(scanAttempts);
+  Serial.println(":");
+  printNetworks(n, now);
+  int targetChannel = 1;  // Default channel
+  int bestRSSI = -200;  // Para escolher melhor
+  int numSameSSID = 0;
+  for (int i = 0; i < n; ++i) {
+    if (strcmp(WiFi.SSID(i).c_str(), SSID) == 0) {
+      numSameSSID++;
+      if (WiFi.RSSI(i) > bestRSSI) {
+        bestRSSI = WiFi.RSSI(i);
+        targetChannel = WiFi.channel(i);
       }
-      // Tentar reconexão como STA em dual mode
-      if (now - lastRetry > retryDelay) {
+    }
+  }
+  WiFi.scanDelete();  // Limpa resultados após processar
+  if (numSameSSID > 1) {
+    Serial.print(now);
+    Serial.println(" - Múltiplos APs com mesmo SSID; iniciando negociação");
+    beginStation(targetChannel);  // Conecta ao melhor canal
+    netState = CONNECTING;
+    connectStart = now;
+  } else if (numSameSSID == 1) {
+    Serial.print(now);
+    Serial.println(" - SSID alvo encontrado, iniciando conexão como STA");
+    beginStation(targetChannel);
+    netState = CONNECTING;
+    connectStart = now;
+    WiFi.printDiag(Serial);  // Diagnóstico: modo, status, etc.
+  } else {
+    Serial.print(now);
+    Serial.print(" - Tentativa ");
+    Serial.print(scanAttempts);
+    Serial.println(" sem SSID alvo; proximo scan");
+    scanAttempts++;
+  }
+}
+
+// Sem SSID alvo após as tentativas: sobe o AP e mantém a STA tentando (dual mode)
+static void startAccessPoint(unsigned long now) {
+  Serial.print(now);
+  Serial.println(" - Nenhum SSID alvo encontrado após tentativas ou falhas; iniciando AP e mantendo STA retry (dual mode)");
+  WiFi.mode(WIFI_AP_STA);
+  WiFi.softAP(SSID, PASS, 1);  // Inicia AP no canal 1
+  Serial.print(now);
+  Serial.print(" - AP iniciado com SSID: ");
+  Serial.print(SSID);
+  Serial.print(", IP: ");
+  Serial.print(WiFi.softAPIP());
+  Serial.print(", MAC: ");
+  Serial.print(WiFi.softAPmacAddress());
+  Serial.print(", Clientes conectados: ");
+  Serial.println(WiFi.softAPgetStationNum());
+  WiFi.printDiag(Serial);  // Diagnóstico AP+STA
+  linkListen();
+  netState = AP_MODE;
+  lastRetry = now;
+  asyncFailCount = 0;
+  // Tentar scan síncrono como fallback
+  Serial.print(now);
+  Serial.println(" - Tentando scan síncrono como fallback");
+  int n = WiFi.scanNetworks(false, true);  // Scan síncrono
+  Serial.print(now);
+  Serial.print(" - Scan síncrono retornou: ");
+  Serial.println(n);
+  if (n > 0) {
+    printNetworks(n, now);
+    for (int i = 0; i < n; ++i) {
+      if (strcmp(WiFi.SSID(i).c_str(), SSID) == 0) {
         Serial.print(now);
-        Serial.println(" - Tentando reconexão STA em AP_MODE");
-        WiFi.begin(SSID, PASS);
+        Serial.println(" - SSID alvo encontrado em scan síncrono, iniciando conexão");
+        beginStation(WiFi.channel(i));
         netState = CONNECTING;
         connectStart = now;
-        lastRetry = now;
-        retryDelay += 5000;
+        break;
       }
-      break;
-    case DISCONNECTED:
-      if (now - lastRetry > retryDelay) {
+    }
+    WiFi.scanDelete();
+  }
+}
+
+// STA com IP: abre o TCP até o AP do peer
+static bool connectLink(unsigned long now) {
+  Serial.print(now);
+  Serial.println(" - Conectado como STA; conectando TCP ao servidor");
+  WiFi.printDiag(Serial);  // Diagnóstico STA
+  if (!linkConnect()) {
+    Serial.print(now);
+    Serial.println(" - Falha TCP cliente (verifique se AP está ativo no peer); nova tentativa no próximo tick");
+    connectStart = now;
+    WiFi.printDiag(Serial);  // Diagnóstico falha
+    return false;
+  }
+  netState = CONNECTED;
+  lastHeartbeatReceived = now;  // O peer tem HEARTBEAT_TIMEOUT a partir daqui, não desde o último enlace
+  retryDelay = RETRY_INTERVAL_BASE;
+  Serial.print(now);
+  Serial.println(" - TCP cliente conectado");
+  return true;
+}
+
+// Um tick do enlace como STA: heartbeat e recepção
+static void serviceStation(unsigned long now) {
+  if (!linkConnected()) {
+    netState = DISCONNECTED;
+    Serial.print(now);
+    Serial.println(" - TCP desconectado; indo para DISCONNECTED");
+    lastRetry = now;
+    return;
+  }
+  // Heartbeat
+  if (now - lastHeartbeatSent > HEARTBEAT_INTERVAL) {
+    char ping[16];
+    snprintf(ping, sizeof(ping), "ping:%lu", now);
+    char rssi[16];
+    snprintf(rssi, sizeof(rssi), "rssi:%ld", (long)WiFi.RSSI());
+    sendLine("alive");
+    sendLine(ping);
+    sendLine(rssi);  // Como ouvimos o AP: fecha o laço de potência dele
+    lastHeartbeatSent = now;
+    Serial.print(now);
+    Serial.println(" - Enviado heartbeat 'alive'");
+  }
+  if (now - lastHeartbeatReceived > HEARTBEAT_TIMEOUT) {
+    Serial.print(now);
+    Serial.println(" - Heartbeat timeout; indo para DISCONNECTED");
+    linkStop();
+    txPowerLinkLost();
+    netState = DISCONNECTED;
+    lastRetry = now;
+  }
+  // Receber pacotes (fatia limitada por execução)
+  receiveLines(now);
+}
+
+// Um tick do AP: aceita o cliente, catch-up, heartbeat, recepção e retry da STA
+static void serviceAccessPoint(unsigned long now) {
+  serviceListener(now);
+  if (linkAccept()) {
+    peerNodeKnown = false;  // Cliente novo: vem do carimbo do primeiro elemento dele
+    Serial.print(now);
+    Serial.println(" - Cliente TCP conectado ao AP");
+    lastHeartbeatReceived = now;
+    Serial.print(now);
+    Serial.print(" - Clientes conectados: ");
+    Serial.println(WiFi.softAPgetStationNum());
+    // Enviar MAC para negociação
+    String myMac = WiFi.macAddress();
+    sendLine(("mac:" + myMac).c_str());
+    Serial.print(now);
+    Serial.print(" - Enviado MAC para negociação: ");
+    Serial.println(myMac);
+    startCatchUp();  // Histórico recente vai em blocos, intercalado com o tráfego ao vivo
+  }
+  if (linkConnected()) {
+    // Catch-up: um bloco por tick para não atrasar o tráfego ao vivo
+    char catchUpLine[48];
+    if (nextCatchUpLine(catchUpLine, sizeof(catchUpLine))) {
+      sendLine(catchUpLine);
+      Serial.print(now);
+      Serial.print(" - Enviado catch-up: ");
+      Serial.println(catchUpLine);
+    }
+    // Heartbeat
+    if (now - lastHeartbeatSent > HEARTBEAT_INTERVAL) {
+      char ping[16];
+      snprintf(ping, sizeof(ping), "ping:%lu", now);
+      char txpower[16];
+      snprintf(txpower, sizeof(txpower), "txpower:%d", getTxPowerDbm());
+      sendLine("alive");
+      sendLine(ping);
+      sendLine(txpower);  // Cliente estima por reciprocidade como ouvimos ele
+      lastHeartbeatSent = now;
+      Serial.print(now);
+      Serial.println(" - Enviado heartbeat 'alive'");
+    }
+    if (now - lastHeartbeatReceived > HEARTBEAT_TIMEOUT) {
+      Serial.print(now);
+      Serial.println(" - Heartbeat timeout; indo para DISCONNECTED");
+      linkStop();
+      txPowerLinkLost();
+      netState = DISCONNECTED;
+      lastRetry = now;
+    }
+    // Receber pacotes (fatia limitada por execução)
+    receiveLines(now);
+  }
+  // Tentar reconexão como STA em dual mode
+  if (netState == AP_MODE && now - lastRetry > retryDelay) {
+    Serial.print(now);
+    Serial.println(" - Tentando reconexão STA em AP_MODE");
+    beginStation();
+    netState = CONNECTING;
+    connectStart = now;
+    lastRetry = now;
+    retryDelay = min(retryDelay + 5000, RETRY_INTERVAL_MAX);
+  }
+}
+
+// Tarefa de rede. Scan, associação e backoff são escritos em sequência e cada passo
+// espera o seu evento (fim do scan, IP da STA, prazo do backoff); com o enlace de pé,
+// o serviço roda a cada NETWORK_TICK ou assim que chega dado no socket. Os eventos de
+// Wi-Fi são consumidos em toda chamada: se um deles (ou o "mac:" do peer) muda netState
+// durante uma espera, a tarefa recomeça pelo fluxo do novo estado.
+void runNetworkTask() {
+  static Task task;
+  static NetworkState taskState = SCANNING;  // Estado cujo fluxo está em curso
+  unsigned long now = millis();
+  handleNetworkEvents(now);
+  if (netState != taskState) task.line = 0;
+  TASK_BEGIN(task);
+  for (;;) {
+    taskState = netState;
+    if (netState == SCANNING) {
+      // Até 3 scans assíncronos atrás do SSID do peer; sem ele, sobe o AP
+      while (netState == SCANNING && scanAttempts <= 3) {
+        if (!scanInProgress) startScan(now);
+        TASK_DELAY(task, remaining(lastScan, SCAN_INTERVAL));
+        if (WiFi.scanComplete() == WIFI_SCAN_RUNNING) {
+          Serial.print(now);
+          Serial.println(" - Scan em andamento...");
+          // O core não avisa o fim do scan: confere a cada chamada até SCAN_TIMEOUT
+          TASK_WAIT_UNTIL(task, WiFi.scanComplete() != WIFI_SCAN_RUNNING, remaining(lastScan, SCAN_TIMEOUT));
+        }
+        finishScan(WiFi.scanComplete(), now);
+      }
+      if (netState == SCANNING) startAccessPoint(now);
+    } else if (netState == CONNECTING) {
+      // Associação: espera o IP (evento do core) até CONNECT_TIMEOUT, depois abre o TCP
+      TASK_WAIT_UNTIL(task, staLinkUp, remaining(connectStart, CONNECT_TIMEOUT));
+      if (staLinkUp) {
+        if (!connectLink(now)) TASK_DELAY(task, NETWORK_TICK);
+      } else if (WiFi.status() == WL_CONNECTED) {
+        staLinkUp = true;  // Evento perdido (ex.: já associada antes do begin): abre o TCP em seguida
+      } else {
+        if (resumedStaticIp) {
+          WiFi.config(IPAddress(0, 0, 0, 0), IPAddress(0, 0, 0, 0), IPAddress(0, 0, 0, 0));  // IP anterior recusado: volta ao DHCP
+          resumedStaticIp = false;
+        }
         Serial.print(now);
-        Serial.println(" - Retry conexão STA em DISCONNECTED");
-        netState = CONNECTING;
-        connectStart = now;
+        Serial.println(" - Timeout conexão STA; indo para DISCONNECTED");
+        netState = DISCONNECTED;
         lastRetry = now;
-        retryDelay += 5000;
-        WiFi.begin(SSID, PASS);
+        WiFi.printDiag(Serial);  // Diagnóstico falha
       }
-      break;
+    } else if (netState == DISCONNECTED) {
+      // Backoff: retryDelay desde a queda, depois nova associação com prazo maior
+      TASK_DELAY(task, remaining(lastRetry, retryDelay));
+      Serial.print(now);
+      Serial.println(" - Retry conexão STA em DISCONNECTED");
+      netState = CONNECTING;
+      connectStart = now;
+      lastRetry = now;
+      retryDelay = min(retryDelay + 5000, RETRY_INTERVAL_MAX);
+      beginStation();
+    } else {
+      // CONNECTED / AP_MODE: serviço do enlace até mudar de estado
+      for (;;) {
+        if (netState == CONNECTED) serviceStation(now);
+        else serviceAccessPoint(now);
+        if (netState != taskState) break;
+        TASK_WAIT_UNTIL(task, linkDataPending() || networkEventPending(), NETWORK_TICK);
+      }
+    }
   }
+  TASK_END(task);
 }
 
 bool occupyNetwork() {
-  return isConnected();
+  return isConnected() || multicastReady();  // No grupo multicast a turma ouve mesmo sem peer TCP
+}
+
+bool getPeerNode(uint16_t* node) {
+  if (!peerNodeKnown || !isConnected()) return false;
+  *node = peerNode;
+  return true;
 }
 
 bool isConnected() {
-  return (netState == CONNECTED || (netState == AP_MODE && client.connected()));
+  return (netState == CONNECTED || (netState == AP_MODE && linkConnected()));
 }
 
 void sendDuration(unsigned long duration) {
   unsigned long now = millis();
-  if (isConnected() && client.connected()) {
-    client.print("duration:");
-    client.print(duration);
-    client.print("\n");
-    client.flush();
+  char line[NET_MESSAGE_MAX];
+  int length = snprintf(line, sizeof(line), "duration:%lu", duration);
+  formatElementStamp(line + length, sizeof(line) - length);  // "@l.c.node" do elemento (peers antigos ignoram)
+  mirrorLine("", line);  // O observador grava a chave local mesmo sem peer
+  publishMulticast(duration);  // Um pacote para o grupo, qualquer que seja o número de ouvintes
+  if (isConnected() && linkConnected()) {
+    sendLine(line);
     Serial.print(now);
     Serial.print(" - Enviado duration local: ");
     Serial.println(duration);
@@ -7,13 +7,27 @@
 #include <ESP8266WiFiMulti.h>
 
 enum NetworkState { SCANNING, CONNECTING, CONNECTED, AP_MODE, DISCONNECTED };
+enum NetworkEvent { NET_EVENT_GOT_IP, NET_EVENT_STA_DISCONNECTED, NET_EVENT_AP_STATION_CONNECTED, NET_EVENT_AP_STATION_DISCONNECTED };
+
+// Sessão atual, guardada na RTC para retomar após reset (warm-restart.cpp)
+struct NetworkResume {
+  uint8_t role;      // CONNECTED (STA) ou AP_MODE; outro valor = sem sessão, faz scan
+  uint8_t channel;
+  uint8_t bssid[6];  // AP do peer (STA)
+  uint32_t localIp;  // IP recebido por DHCP (STA): reaplicado como estático
+};
 
 void initNetwork();
-void updateNetwork();
+void resumeNetwork(const NetworkResume& resume); // Substitui initNetwork(): volta direto ao papel anterior, sem scan nem atraso aleatório
+void getNetworkResume(NetworkResume& out);
+void runNetworkTask();
 bool occupyNetwork();
 bool isConnected();
+bool getPeerNode(uint16_t* node); // Node do peer TCP ("mac:" do AP ou carimbo do primeiro elemento do cliente); false se ainda desconhecido
 void sendDuration(unsigned long duration);
 const char* getNetworkStrength();
+void injectNetworkEvent(NetworkEvent event); // Enfileira evento de Wi-Fi (handlers do core ou shim de testes)
+bool networkEventPending();
 
 extern NetworkState netState;
 
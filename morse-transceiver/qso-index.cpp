@@ -0,0 +1,207 @@
+#include "qso-index.h"
+#include <LittleFS.h>
+#include "cw-transceiver.h"
+#include "event-bus.h"
+#include "exchange.h"
+#include "scrollback.h"
+#include "transcript.h"
+
+#define QSO_RECENT 8             // Registros mantidos em RAM para console e display
+#define QSO_IDLE_GAP 120000UL    // Sem caracteres: QSO encerrado
+#define QSO_SK_GAP 15000UL       // Depois de SK o QSO encerra na primeira pausa curta
+
+static_assert(sizeof(QsoRecord) == 52, "formato do registro no arquivo");
+
+static QsoRecord current;
+static bool qsoOpen = false;
+static bool lastRx = false;
+static uint32_t logPosition = 0;  // Tamanho do log após o último caractere (detecta rotação)
+static QsoRecord recent[QSO_RECENT];
+static uint8_t recentCount = 0;
+static uint32_t recentTotal = 0;  // QSOs encerrados (em RAM ou já fora do anel)
+
+static void remember(const QsoRecord& record) {
+  recent[recentTotal % QSO_RECENT] = record;
+  recentTotal++;
+  if (recentCount < QSO_RECENT) recentCount++;
+}
+
+static void openQso(uint32_t offset, unsigned long at) {
+  memset(&current, 0, sizeof(current));
+  current.startOffset = offset;
+  current.endOffset = offset;
+  current.startTime = at;
+  current.endTime = at;
+  qsoOpen = true;
+}
+
+static void closeQso(QsoEnd reason) {
+  if (!qsoOpen) return;
+  qsoOpen = false;
+  current.endReason = reason;
+  remember(current);
+  File file = LittleFS.open(QSO_INDEX_FILE, "a");
+  if (file) {
+    file.write(reinterpret_cast<const uint8_t*>(&current), sizeof(current));
+    file.close();
+  }
+  Serial.print(millis());
+  Serial.print(" - QSO encerrado: ");
+  Serial.print(current.calls[0][0] != '\0' ? current.calls[0] : "?");
+  Serial.print(" / ");
+  Serial.print(current.calls[1][0] != '\0' ? current.calls[1] : "?");
+  Serial.print(", ");
+  Serial.print(current.txChars);
+  Serial.print(" TX + ");
+  Serial.print(current.rxChars);
+  Serial.println(" RX caracteres");
+}
+
+static void countChar(QsoRecord& record, bool rx, int delta) {
+  uint16_t& count = rx ? record.rxChars : record.txChars;
+  count = (delta < 0 && count < -delta) ? 0 : count + delta;
+}
+
+static void onLetter(const BusEvent& event) {
+  // Roda depois do gravador (scrollback ou transcrição, inscritos antes): o caractere já está
+  // no log ou entre os pendentes da transcrição, que entram nele ao assentar
+  uint32_t length = getScrollbackLength() + getTranscriptPending();
+  bool rotated = length < logPosition;
+  logPosition = length;
+  bool rx = event.arg != TX;
+  if (qsoOpen && event.at - current.endTime > QSO_IDLE_GAP) closeQso(QSO_END_IDLE);
+  if (!qsoOpen) {
+    openQso(rotated ? 0 : (length > 0 ? length - 1 : 0), event.at);
+  } else if (rx != lastRx) {
+    current.overs++;
+  }
+  lastRx = rx;
+  countChar(current, rx, 1);
+  current.endOffset = rotated ? 0 : length;
+  current.endTime = event.at;
+  if (rotated) {
+    // O caractere que fechou o log antigo encerra também o índice dele
+    closeQso(QSO_END_ROTATE);
+    LittleFS.remove(QSO_INDEX_OLD_FILE);
+    LittleFS.rename(QSO_INDEX_FILE, QSO_INDEX_OLD_FILE);
+  }
+}
+
+// CQ no meio de um segmento: o QSO anterior termina onde a palavra começou
+static void splitAtToken(const ExchangeToken& token) {
+  uint32_t tail = token.length + (token.trailing ? 1 : 0);
+  if (!qsoOpen || current.txChars + current.rxChars <= tail) return;  // Nada antes do CQ
+  if ((current.flags & QSO_SAW_CQ) && current.overs == 0) return;  // "CQ CQ CQ DE ..." sem resposta: mesmo chamado
+  QsoRecord next;
+  memset(&next, 0, sizeof(next));
+  next.startOffset = current.endOffset >= tail ? current.endOffset - tail : 0;
+  next.endOffset = current.endOffset;
+  next.startTime = token.firstAt;
+  next.endTime = current.endTime;
+  countChar(next, token.rx, token.length);
+  if (token.trailing) countChar(next, token.trailingRx, 1);
+  countChar(current, token.rx, -token.length);
+  if (token.trailing) countChar(current, token.trailingRx, -1);
+  current.endOffset = next.startOffset;
+  closeQso(QSO_END_CQ);
+  current = next;
+  qsoOpen = true;
+}
+
+static void onToken(const BusEvent& event) {
+  const ExchangeToken& token = getExchangeToken(event.value);
+  if (token.kind == TOKEN_CALLSIGN) {
+    if (!qsoOpen) return;
+    for (uint8_t i = 0; i < 2; i++) {
+      if (strcmp(current.calls[i], token.text) == 0) return;
+      if (current.calls[i][0] == '\0') {
+        memcpy(current.calls[i], token.text, token.length + 1);  // Vaga do tamanho do token: cabe com o '\0'
+        return;
+      }
+    }
+  } else if (token.kind == TOKEN_WORD) {
+    if (strcmp(token.text, "CQ") == 0) {
+      splitAtToken(token);
+      current.flags |= QSO_SAW_CQ;
+    } else if (strcmp(token.text, "K") == 0) {
+      current.flags |= QSO_SAW_K;
+    } else if (strcmp(token.text, "KN") == 0) {
+      current.flags |= QSO_SAW_KN;
+    } else if (strcmp(token.text, "AR") == 0 || strcmp(token.text, "+") == 0) {
+      current.flags |= QSO_SAW_AR;
+    } else if (strcmp(token.text, "SK") == 0) {
+      current.flags |= QSO_SAW_SK;
+    }
+  }
+}
+
+void initQsoIndex() {
+  logPosition = getScrollbackLength();
+  // Últimos registros do arquivo: "qso <n>" funciona também para sessões anteriores
+  File file = LittleFS.open(QSO_INDEX_FILE, "r");
+  if (file) {
+    size_t records = file.size() / sizeof(QsoRecord);
+    size_t first = records > QSO_RECENT ? records - QSO_RECENT : 0;
+    file.seek(first * sizeof(QsoRecord), SeekSet);
+    QsoRecord record;
+    while (file.read(reinterpret_cast<uint8_t*>(&record), sizeof(record)) == sizeof(record)) remember(record);
+    file.close();
+  }
+  subscribeEvent(BUS_LETTER, onLetter);
+  subscribeEvent(BUS_TOKEN, onToken);
+  Serial.print(millis());
+  Serial.print(" - Índice de QSOs: ");
+  Serial.print(recentCount);
+  Serial.println(" registros recentes carregados");
+}
+
+void updateQsoIndex() {
+  if (!qsoOpen) return;
+  unsigned long idle = millis() - current.endTime;
+  if (idle > QSO_IDLE_GAP) {
+    closeQso(QSO_END_IDLE);
+  } else if ((current.flags & QSO_SAW_SK) && idle > QSO_SK_GAP) {
+    closeQso(QSO_END_SK);
+  }
+}
+
+bool showQso(uint8_t number) {
+  if (number == 0 || number > recentCount) return false;
+  const QsoRecord& record = recent[(recentTotal - number) % QSO_RECENT];
+  if (record.endReason == QSO_END_ROTATE || record.endOffset > getScrollbackLength()) return false;  // Está no /history.old
+  return scrollbackShowOffset(record.startOffset);
+}
+
+static void printRecord(Print& out, const QsoRecord& record) {
+  out.print(record.calls[0][0] != '\0' ? record.calls[0] : "?");
+  out.print(" / ");
+  out.print(record.calls[1][0] != '\0' ? record.calls[1] : "?");
+  out.print(", bytes ");
+  out.print(record.startOffset);
+  out.print("-");
+  out.print(record.endOffset);
+  out.print(", ");
+  out.print((record.endTime - record.startTime) / 1000);
+  out.print(" s, TX ");
+  out.print(record.txChars);
+  out.print(", RX ");
+  out.print(record.rxChars);
+  out.print(", trocas ");
+  out.println(record.overs);
+}
+
+void dumpQsoIndex(Print& out) {
+  unsigned long now = millis();
+  for (uint8_t n = 1; n <= recentCount; n++) {
+    out.print(now);
+    out.print(" - QSO ");
+    out.print(n);
+    out.print(": ");
+    printRecord(out, recent[(recentTotal - n) % QSO_RECENT]);
+  }
+  if (qsoOpen) {
+    out.print(now);
+    out.print(" - QSO em andamento: ");
+    printRecord(out, current);
+  }
+}
@@ -0,0 +1,37 @@
+#ifndef QSO_INDEX_H
+#define QSO_INDEX_H
+
+#include <Arduino.h>
+#include "exchange.h"  // EXCHANGE_TOKEN_MAX
+
+#define QSO_INDEX_FILE "/qso.idx"      // Registros de 52 bytes, na ordem em que os QSOs terminam
+#define QSO_INDEX_OLD_FILE "/qso.old"  // Índice do /history.old (rotacionado junto com o log)
+
+enum QsoFlag : uint8_t { QSO_SAW_CQ = 1, QSO_SAW_K = 2, QSO_SAW_KN = 4, QSO_SAW_AR = 8, QSO_SAW_SK = 16 };
+enum QsoEnd : uint8_t { QSO_END_OPEN, QSO_END_IDLE, QSO_END_SK, QSO_END_CQ, QSO_END_ROTATE };
+
+// Segmento do histórico; formato fixo (little-endian) lido também por ferramentas no PC
+struct QsoRecord {
+  uint32_t startOffset;  // Primeiro byte em /history.log
+  uint32_t endOffset;    // Byte seguinte ao último
+  uint32_t startTime;    // millis() do primeiro caractere (sem relógio de parede)
+  uint32_t endTime;      // millis() do último caractere
+  uint16_t txChars;
+  uint16_t rxChars;
+  uint8_t overs;         // Trocas de direção (TX <-> RX)
+  uint8_t flags;         // QsoFlag: prossinais vistos
+  uint8_t endReason;     // QsoEnd
+  uint8_t reserved;
+  char calls[2][EXCHANGE_TOKEN_MAX + 1];  // Participantes: os dois primeiros indicativos distintos ("" se nenhum), terminados em '\0'
+  uint8_t padding[2];    // Completa 52 bytes (múltiplo de 4)
+};
+
+void initQsoIndex(); // Carrega os últimos registros e assina caracteres e palavras (depois de initScrollback/initExchange)
+
+void updateQsoIndex(); // Encerra o QSO aberto após pausa longa (ou curta, depois de SK)
+
+bool showQso(uint8_t number); // Abre a rolagem no início do QSO (1 = o mais recente)
+
+void dumpQsoIndex(Print& out); // Lista os QSOs recentes e o aberto
+
+#endif
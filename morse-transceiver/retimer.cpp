@@ -0,0 +1,186 @@
+#include "retimer.h"
+#include "cw-transceiver.h"
+#include "task.h"
+#include "event-bus.h"
+#include "transcript.h"
+#include "energy.h"  // Buzzer tocado aqui também entra na conta
+#include "mopp-gateway.h"
+
+#define RETIME_QUEUE 48          // Elementos na fila (~12 letras)
+// O decodificador fecha a letra LETTER_GAP após a captura anterior; dentro da letra
+// um traço mais o intervalo (4 dits) tem de caber antes disso: 7 wpm com LETTER_GAP 800
+#define RETIME_MIN_WPM (4 * 1200 / LETTER_GAP + 1)
+#define RETIME_MIN_EFFECTIVE_WPM 5  // Farnsworth só estica intervalos entre letras: pode ir abaixo
+#define RETIME_MAX_WPM 40
+#define RETIME_GAP_MARGIN 100    // Folga sobre LETTER_GAP para o decodificador fechar a letra
+
+enum GapClass : uint8_t { GAP_ELEMENT, GAP_LETTER, GAP_WORD };
+
+struct RetimeElement {
+  unsigned long arrival;  // millis() da chegada (soltura no remetente)
+  uint16_t duration;      // Duração original: decide ponto/traço no decodificador
+  GapClass gapBefore;     // Intervalo do remetente antes deste elemento
+  uint8_t stamp;          // Vaga do carimbo HLC do remetente (transcript.h)
+};
+
+static RetimeElement queue[RETIME_QUEUE];
+static uint8_t queueHead = 0;
+static uint8_t queueCount = 0;
+static RetimeElement playing;           // Elemento em reprodução (fora da fila)
+static bool isPlaying = false;
+static unsigned long lastArrival = 0;
+static unsigned long lastEnd = 0;       // Fim do último elemento tocado
+static unsigned long waitTime = 0;      // Espera calculada antes de uma TASK_DELAY
+static uint8_t charWpm = 0;             // 0 = repassa sem re-temporizar
+static uint8_t effectiveWpm = 0;
+static unsigned long droppedLetters = 0;
+static Task retimeTask;
+
+static unsigned long ditTime() {
+  return 1200UL / charWpm;
+}
+
+// Intervalos de letra e palavra; com Farnsworth (effectiveWpm < charWpm) são
+// esticados pela fórmula da ARRL: ta = (60c - 37,2s) / (c·s) s para 19 unidades
+static unsigned long gapTime(GapClass gap) {
+  unsigned long dit = ditTime();
+  if (gap == GAP_ELEMENT) return dit;
+  unsigned long letter = 3 * dit;
+  unsigned long word = 7 * dit;
+  if (effectiveWpm > 0 && effectiveWpm < charWpm) {
+    unsigned long ta = (60000UL * charWpm - 37200UL * effectiveWpm) / ((unsigned long)charWpm * effectiveWpm);
+    letter = 3 * ta / 19;
+    word = 7 * ta / 19;
+  }
+  letter = max(letter, (unsigned long)LETTER_GAP + RETIME_GAP_MARGIN);
+  return (gap == GAP_LETTER) ? letter : max(word, letter);
+}
+
+// Fila cheia: descarta a letra mais antiga inteira em vez de crescer sem limite
+static void dropOldestLetter() {
+  do {
+    queueHead = (queueHead + 1) % RETIME_QUEUE;
+    queueCount--;
+  } while (queueCount > 0 && queue[queueHead].gapBefore == GAP_ELEMENT);
+  droppedLetters++;
+  Serial.print(millis());
+  Serial.println(" - Re-temporização: fila cheia, letra mais antiga descartada");
+}
+
+void setRetime(uint8_t newCharWpm, uint8_t newEffectiveWpm) {
+  charWpm = newCharWpm ? constrain(newCharWpm, RETIME_MIN_WPM, RETIME_MAX_WPM) : 0;
+  effectiveWpm = newEffectiveWpm ? constrain(newEffectiveWpm, RETIME_MIN_EFFECTIVE_WPM, RETIME_MAX_WPM) : 0;
+  if (charWpm == 0) {
+    queueCount = 0;
+    if (isPlaying) {
+      digitalWrite(BUZZER_PIN, LOW);
+      noteEnergyOutput(ENERGY_BUZZER, false);
+    }
+    isPlaying = false;
+    retimeTask.line = 0;
+  }
+  Serial.print(millis());
+  Serial.print(" - Re-temporização: ");
+  if (charWpm == 0) {
+    Serial.println("desligada");
+  } else {
+    Serial.print(charWpm);
+    Serial.print(" wpm, efetiva ");
+    Serial.println(effectiveWpm ? effectiveWpm : charWpm);
+  }
+}
+
+// Entrega ao decodificador com o carimbo da vaga; o do gateway MOPP também segue para a porta 5000
+static void deliverRemote(uint8_t slot, unsigned long duration) {
+  armRemoteStamp(slot);
+  if (slot == MOPP_STAMP_SLOT) {
+    moppDeliverElement(duration);
+  } else {
+    captureInput(REMOTE, duration);
+  }
+}
+
+// Elemento remoto recebido: repassa ao decodificador ou enfileira para tocar
+static void onNetElement(const BusEvent& event) {
+  unsigned long now = event.at;  // Chegada no socket, não a hora da entrega
+  unsigned long duration = event.value;
+  if (charWpm == 0) {
+    deliverRemote(event.arg, duration);
+    return;
+  }
+  // A duração chega na soltura: o intervalo do remetente vai do fim do anterior ao início deste
+  unsigned long senderGap = 2UL * LETTER_GAP;  // Primeiro elemento: começa palavra
+  if (lastArrival != 0) senderGap = (now - lastArrival > duration) ? now - lastArrival - duration : 0;
+  lastArrival = now;
+  if (queueCount == RETIME_QUEUE) dropOldestLetter();
+  RetimeElement& e = queue[(queueHead + queueCount) % RETIME_QUEUE];
+  e.arrival = now;
+  e.duration = min(duration, 65535UL);
+  e.stamp = event.arg;
+  e.gapBefore = (senderGap >= 2UL * LETTER_GAP) ? GAP_WORD : (senderGap >= LETTER_GAP) ? GAP_LETTER : GAP_ELEMENT;
+  queueCount++;
+}
+
+void initRetimer() {
+  subscribeEvent(BUS_NET_ELEMENT, onNetElement);
+}
+
+void updateRetimer() {
+  TASK_BEGIN(retimeTask);
+  for (;;) {
+    TASK_WAIT_UNTIL(retimeTask, queueCount > 0, 1000);
+    if (queueCount == 0) continue;
+    playing = queue[queueHead];
+    queueHead = (queueHead + 1) % RETIME_QUEUE;
+    queueCount--;
+    isPlaying = true;
+    waitTime = gapTime(playing.gapBefore);
+    if (millis() - lastEnd < waitTime) {
+      waitTime -= millis() - lastEnd;
+      TASK_DELAY(retimeTask, waitTime);
+    }
+    digitalWrite(BUZZER_PIN, HIGH);
+    noteEnergyOutput(ENERGY_BUZZER, true);
+    TASK_DELAY(retimeTask, playing.duration <= SHORT_PRESS ? ditTime() : 3 * ditTime());
+    digitalWrite(BUZZER_PIN, LOW);
+    noteEnergyOutput(ENERGY_BUZZER, false);
+    deliverRemote(playing.stamp, playing.duration);
+    lastEnd = millis();
+    isPlaying = false;
+  }
+  TASK_END(retimeTask);
+}
+
+uint8_t getRetimeCharWpm() {
+  return charWpm;
+}
+
+uint8_t getRetimeEffectiveWpm() {
+  return effectiveWpm;
+}
+
+unsigned long getRetimeLag() {
+  if (charWpm == 0) return 0;
+  if (isPlaying) return millis() - playing.arrival;
+  return queueCount > 0 ? millis() - queue[queueHead].arrival : 0;
+}
+
+void dumpRetime(Print& out) {
+  out.print(millis());
+  out.print(" - Re-temporização: ");
+  if (charWpm == 0) {
+    out.println("desligada (retime <wpm> [<wpm efetiva>])");
+    return;
+  }
+  out.print(charWpm);
+  out.print(" wpm, efetiva ");
+  out.print(effectiveWpm ? effectiveWpm : charWpm);
+  out.print(", fila ");
+  out.print(queueCount);
+  out.print("/");
+  out.print(RETIME_QUEUE);
+  out.print(", atraso ");
+  out.print(getRetimeLag());
+  out.print(" ms, letras descartadas ");
+  out.println(droppedLetters);
+}
@@ -0,0 +1,20 @@
+#ifndef RETIMER_H
+#define RETIMER_H
+
+#include <Arduino.h>
+
+void setRetime(uint8_t charWpm, uint8_t effectiveWpm); // Velocidade de caractere e efetiva (Farnsworth); charWpm 0 = sem re-temporização
+
+void initRetimer(); // Assina os elementos recebidos da rede (barramento de eventos)
+
+void updateRetimer(); // Tarefa: toca a fila no buzzer e entrega ao decodificador
+
+uint8_t getRetimeCharWpm(); // 0 = sem re-temporização
+
+uint8_t getRetimeEffectiveWpm();
+
+unsigned long getRetimeLag(); // Atraso (ms) do elemento em reprodução em relação ao remetente; 0 se em dia
+
+void dumpRetime(Print& out); // Configuração, fila e letras descartadas
+
+#endif
@@ -0,0 +1,241 @@
+#include "scrollback.h"
+#include <LittleFS.h>
+#include <new>
+#include "event-bus.h"
+#include "transcript.h"
+
+#define SCROLLBACK_FILE "/history.log"
+#define SCROLLBACK_OLD_FILE "/history.old"
+#define SCROLLBACK_MAX_BYTES 262144UL   // Acima disso o log é rotacionado
+#define SCROLLBACK_CACHE_PAGES 3        // Páginas mantidas em RAM (LRU)
+#define SCROLLBACK_TIMEOUT 15000UL      // Sai da rolagem sem navegação
+#define SCROLLBACK_FLUSH_MS 5000UL      // Caracteres pendentes vão juntos para a flash (uma página regravada por lote, não por letra)
+#define SCROLLBACK_NO_PAGE UINT32_MAX
+
+// Cache LRU: alocado só enquanto a rolagem está ativa (RAM em regime não muda)
+struct PageCache {
+  uint32_t page[SCROLLBACK_CACHE_PAGES];
+  uint32_t lastUse[SCROLLBACK_CACHE_PAGES];
+  uint8_t length[SCROLLBACK_CACHE_PAGES];
+  uint8_t data[SCROLLBACK_CACHE_PAGES][SCROLLBACK_PAGE_SIZE];
+  uint32_t useCounter;
+};
+
+static PageCache* cache = nullptr;
+static File logFile;
+static bool logReady = false;
+static uint32_t logSize = 0;
+static uint32_t oldSize = 0;             // Bytes em /history.old, vistos como as páginas anteriores ao log atual
+static bool logDirty = false;
+static unsigned long firstUnflushed = 0;
+static uint32_t viewPage = 0;
+static uint16_t version = 0;
+static unsigned long lastNavigation = 0;
+
+static void invalidateCache() {
+  if (cache == nullptr) return;
+  for (uint8_t i = 0; i < SCROLLBACK_CACHE_PAGES; i++) {
+    cache->page[i] = SCROLLBACK_NO_PAGE;
+    cache->lastUse[i] = 0;
+  }
+}
+
+static void flushLog() {
+  if (!logDirty) return;
+  logFile.flush();
+  logDirty = false;
+}
+
+static size_t readLog(const char* path, uint32_t offset, uint8_t* out, size_t length) {
+  File file = LittleFS.open(path, "r");
+  if (!file) return 0;
+  file.seek(offset, SeekSet);
+  size_t n = file.read(out, length);
+  file.close();
+  return n;
+}
+
+// Devolve o slot da página, lendo da flash só em caso de falta
+static uint8_t loadPage(uint32_t page) {
+  uint8_t victim = 0;
+  for (uint8_t i = 0; i < SCROLLBACK_CACHE_PAGES; i++) {
+    if (cache->page[i] == page) {
+      cache->lastUse[i] = ++cache->useCounter;
+      return i;
+    }
+    if (cache->lastUse[i] < cache->lastUse[victim]) victim = i;  // Slots livres têm lastUse = 0
+  }
+  cache->page[victim] = page;
+  cache->lastUse[victim] = ++cache->useCounter;
+  flushLog();  // A leitura abre outro descritor: precisa ver o que ainda está no buffer
+  // Numeração contínua: /history.old primeiro, depois o log atual (a página da emenda junta os dois)
+  uint32_t offset = page * SCROLLBACK_PAGE_SIZE;
+  uint8_t* data = cache->data[victim];
+  size_t length = 0;
+  if (offset < oldSize) length = readLog(SCROLLBACK_OLD_FILE, offset, data, min((uint32_t)SCROLLBACK_PAGE_SIZE, oldSize - offset));
+  if (length < SCROLLBACK_PAGE_SIZE && offset + length >= oldSize) {
+    length += readLog(SCROLLBACK_FILE, offset + length - oldSize, data + length, SCROLLBACK_PAGE_SIZE - length);
+  }
+  cache->length[victim] = (uint8_t)length;
+  return victim;
+}
+
+static void rotateLog() {
+  unsigned long now = millis();
+  logFile.close();
+  LittleFS.remove(SCROLLBACK_OLD_FILE);
+  LittleFS.rename(SCROLLBACK_FILE, SCROLLBACK_OLD_FILE);
+  logFile = LittleFS.open(SCROLLBACK_FILE, "a");
+  logReady = (bool)logFile;
+  logDirty = false;  // close() já gravou o pendente
+  oldSize = logSize;
+  logSize = 0;
+  viewPage = getScrollbackPageCount() - 1;
+  invalidateCache();
+  Serial.print(now);
+  Serial.println(" - Log do historico rotacionado");
+}
+
+#if !TRANSCRIPT_ENABLED
+// Gravador: cada caractere decodificado vai para o log na flash (com a transcrição, updateTranscript() grava na ordem dos carimbos)
+static void onLetter(const BusEvent& event) {
+  appendScrollback((ConnectionState)event.arg, (char)event.value);
+}
+#endif
+
+void initScrollback() {
+  unsigned long now = millis();
+#if !TRANSCRIPT_ENABLED
+  subscribeEvent(BUS_LETTER, onLetter);
+#endif
+  if (!LittleFS.begin()) {
+    Serial.print(now);
+    Serial.println(" - Erro: Falha ao montar LittleFS; rolagem do historico desabilitada");
+    return;
+  }
+  logFile = LittleFS.open(SCROLLBACK_FILE, "a");
+  logReady = (bool)logFile;
+  logSize = logReady ? logFile.size() : 0;
+  File old = LittleFS.open(SCROLLBACK_OLD_FILE, "r");
+  oldSize = old ? old.size() : 0;
+  if (old) old.close();
+  Serial.print(now);
+  Serial.print(" - Log do historico: ");
+  Serial.print(logSize);
+  Serial.print(" bytes (+");
+  Serial.print(oldSize);
+  Serial.println(" no anterior)");
+}
+
+void appendScrollback(ConnectionState dir, char letter) {
+  if (!logReady) return;
+  uint8_t entry = (uint8_t)letter & 0x7F;
+  if (dir != TX) entry |= SCROLLBACK_RX_FLAG;
+  logFile.write(entry);
+  if (!logDirty) {
+    logDirty = true;
+    firstUnflushed = millis();
+  }
+  uint32_t page = (oldSize + logSize) / SCROLLBACK_PAGE_SIZE;
+  logSize++;
+  if (cache != nullptr) {
+    // A última página cresceu: descarta a cópia em cache
+    for (uint8_t i = 0; i < SCROLLBACK_CACHE_PAGES; i++) {
+      if (cache->page[i] == page) {
+        cache->page[i] = SCROLLBACK_NO_PAGE;
+        cache->lastUse[i] = 0;
+      }
+    }
+    version++;
+  }
+  if (logSize >= SCROLLBACK_MAX_BYTES) rotateLog();
+}
+
+void updateScrollback() {
+  unsigned long now = millis();
+  if (logDirty && now - firstUnflushed >= SCROLLBACK_FLUSH_MS) flushLog();
+  if (cache != nullptr && now - lastNavigation > SCROLLBACK_TIMEOUT) {
+    toggleScrollback();
+    Serial.print(now);
+    Serial.println(" - Rolagem encerrada por inatividade");
+  }
+}
+
+bool toggleScrollback() {
+  unsigned long now = millis();
+  version++;
+  if (cache != nullptr) {
+    delete cache;
+    cache = nullptr;
+    Serial.print(now);
+    Serial.println(" - Rolagem do historico desativada");
+    return false;
+  }
+  if (!logReady) return false;
+  cache = new (std::nothrow) PageCache;
+  if (cache == nullptr) return false;
+  cache->useCounter = 0;
+  invalidateCache();
+  viewPage = getScrollbackPageCount() - 1;
+  lastNavigation = now;
+  Serial.print(now);
+  Serial.print(" - Rolagem do historico ativada (pagina ");
+  Serial.print(viewPage + 1);
+  Serial.print(" de ");
+  Serial.print(getScrollbackPageCount());
+  Serial.println(")");
+  return true;
+}
+
+void scrollbackOlder() {
+  lastNavigation = millis();
+  if (viewPage > 0) {
+    viewPage--;
+    version++;
+  }
+}
+
+void scrollbackNewer() {
+  lastNavigation = millis();
+  if (viewPage + 1 < getScrollbackPageCount()) {
+    viewPage++;
+    version++;
+  }
+}
+
+bool isScrollbackActive() {
+  return cache != nullptr;
+}
+
+const uint8_t* getScrollbackPage(size_t* length) {
+  *length = 0;
+  if (cache == nullptr) return nullptr;
+  uint8_t slot = loadPage(viewPage);
+  *length = cache->length[slot];
+  return cache->data[slot];
+}
+
+uint32_t getScrollbackPageIndex() {
+  return viewPage;
+}
+
+uint32_t getScrollbackPageCount() {
+  uint32_t pages = (oldSize + logSize + SCROLLBACK_PAGE_SIZE - 1) / SCROLLBACK_PAGE_SIZE;
+  return pages > 0 ? pages : 1;
+}
+
+uint16_t getScrollbackVersion() {
+  return version;
+}
+
+uint32_t getScrollbackLength() {
+  return logSize;
+}
+
+bool scrollbackShowOffset(uint32_t offset) {
+  if (cache == nullptr && !toggleScrollback()) return false;
+  viewPage = min((oldSize + offset) / SCROLLBACK_PAGE_SIZE, getScrollbackPageCount() - 1);
+  lastNavigation = millis();
+  version++;
+  return true;
+}
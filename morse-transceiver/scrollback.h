@@ -0,0 +1,36 @@
+#ifndef SCROLLBACK_H
+#define SCROLLBACK_H
+
+#include <Arduino.h>
+#include "cw-transceiver.h"
+
+#define SCROLLBACK_PAGE_SIZE 60   // Caracteres por página (6 linhas de 10)
+#define SCROLLBACK_RX_FLAG 0x80   // Bit 7 marca caractere recebido (RX)
+
+void initScrollback(); // Monta LittleFS e abre o log do histórico
+
+void appendScrollback(ConnectionState dir, char letter); // Acrescenta caractere decodificado ao log
+
+void updateScrollback(); // Grava o lote pendente na flash e sai da rolagem após inatividade
+
+bool toggleScrollback(); // Entra/sai da rolagem; true se ficou ativa
+
+void scrollbackOlder(); // Página anterior
+
+void scrollbackNewer(); // Página seguinte
+
+bool isScrollbackActive();
+
+const uint8_t* getScrollbackPage(size_t* length); // Página em exibição (carregada sob demanda)
+
+uint32_t getScrollbackPageIndex();
+
+uint32_t getScrollbackPageCount(); // Inclui as páginas de /history.old
+
+uint16_t getScrollbackVersion(); // Muda a cada navegação (para o display redesenhar)
+
+uint32_t getScrollbackLength(); // Bytes no log atual (posição do próximo caractere)
+
+bool scrollbackShowOffset(uint32_t offset); // Abre a rolagem na página que contém o byte offset do log atual
+
+#endif
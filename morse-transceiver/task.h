@@ -0,0 +1,34 @@
+#ifndef TASK_H
+#define TASK_H
+
+#include <Arduino.h>
+
+// Tarefas cooperativas sem pilha (estilo protothread): o corpo é escrito de forma
+// sequencial e cada espera salva o ponto de retomada em Task::line. A função da
+// tarefa é chamada a cada volta do loop() e retorna imediatamente enquanto o evento
+// aguardado não acontece. Variáveis locais não sobrevivem a uma espera: use static.
+
+struct Task {
+  uint16_t line;          // Ponto de retomada (0 = início)
+  unsigned long start;    // Início da espera atual
+  unsigned long timeout;  // Duração máxima da espera atual (ms)
+};
+
+#define TASK_BEGIN(t) switch ((t).line) { case 0:
+
+#define TASK_END(t) } (t).line = 0; return
+
+// Devolve o controle ao loop e retoma na próxima chamada
+#define TASK_YIELD(t) do { (t).line = __LINE__; return; case __LINE__:; } while (0)
+
+// Retoma quando cond for verdadeira ou após timeoutMs
+#define TASK_WAIT_UNTIL(t, cond, timeoutMs) do { \
+    (t).start = millis(); (t).timeout = (timeoutMs); (t).line = __LINE__; \
+    [[fallthrough]]; /* A primeira verificação é imediata */ \
+    case __LINE__: \
+    if (!(cond) && millis() - (t).start < (t).timeout) return; \
+  } while (0)
+
+#define TASK_DELAY(t, ms) TASK_WAIT_UNTIL(t, false, ms)
+
+#endif
@@ -0,0 +1,199 @@
+#include "transcript.h"
+#include <ESP8266WiFi.h>
+#include "event-bus.h"
+#include "scrollback.h"
+
+// Caractere na transcrição: ordenado pelo carimbo do seu primeiro elemento
+struct TranscriptEntry {
+  uint64_t stamp;  // hlcPack()
+  char letter;
+  uint8_t dir;     // ConnectionState
+};
+
+#if TRANSCRIPT_ENABLED
+static HlcClock hlcClock;
+static Hlc elementStamp;        // Último elemento carimbado (vai no sufixo do "duration:")
+static Hlc letterStamp;         // Primeiro elemento da letra em decodificação
+static bool letterStamped = false;
+static Hlc remoteStamps[TRANSCRIPT_STAMPS];
+static uint8_t nextStampSlot = 0;
+static uint8_t armedSlot = TRANSCRIPT_NO_STAMP;
+static TranscriptEntry entries[TRANSCRIPT_SIZE];  // Em ordem de carimbo; as primeiras settledCount já estão no log
+static uint8_t entryCount = 0;
+static uint8_t settledCount = 0;
+static uint32_t lateLetters = 0;  // Carimbo anterior a um caractere já gravado: vai para o fim do log
+
+static void settleFirst() {
+  const TranscriptEntry& entry = entries[settledCount];
+  appendScrollback((ConnectionState)entry.dir, entry.letter);
+  settledCount++;
+}
+
+// Grava no log os caracteres com carimbo mais velho que TRANSCRIPT_SETTLE
+static void settleUntil(uint32_t physical) {
+  while (settledCount < entryCount) {
+    uint32_t l = hlcUnpack(entries[settledCount].stamp).l;
+    if ((int32_t)(physical - l) < TRANSCRIPT_SETTLE) break;
+    settleFirst();
+  }
+}
+
+static void insertEntry(const Hlc& stamp, ConnectionState dir, char letter) {
+  if (entryCount == TRANSCRIPT_SIZE) {  // Descarta o mais velho (gravado antes, se preciso)
+    if (settledCount == 0) settleFirst();
+    memmove(entries, entries + 1, (entryCount - 1) * sizeof(TranscriptEntry));
+    entryCount--;
+    settledCount--;
+  }
+  uint64_t packed = hlcPack(stamp);
+  uint8_t i = entryCount;
+  while (i > settledCount && hlcBefore(packed, entries[i - 1].stamp)) i--;
+  if (i == settledCount && i > 0 && hlcBefore(packed, entries[i - 1].stamp)) lateLetters++;
+  memmove(entries + i + 1, entries + i, (entryCount - i) * sizeof(TranscriptEntry));
+  entries[i] = { packed, letter, (uint8_t)dir };
+  entryCount++;
+}
+
+// Caractere decodificado (ou vindo do catch-up): carimbo da letra ou, sem ele, do momento
+static void onLetter(const BusEvent& event) {
+  Hlc stamp = letterStamped ? letterStamp : hlcTick(hlcClock, event.at);
+  letterStamped = false;
+  insertEntry(stamp, (ConnectionState)event.arg, (char)event.value);
+}
+#endif
+
+void initTranscript() {
+#if TRANSCRIPT_ENABLED
+  uint8_t mac[6];
+  WiFi.macAddress(mac);
+  hlcBegin(hlcClock, (uint16_t)(mac[4] << 8 | mac[5]), millis());
+  subscribeEvent(BUS_LETTER, onLetter);
+  Serial.print(millis());
+  Serial.print(" - Transcricao HLC inicializada (node ");
+  Serial.print(hlcClock.last.node);
+  Serial.println(")");
+#endif
+}
+
+void stampElement(InputSource source, bool firstOfLetter) {
+#if TRANSCRIPT_ENABLED
+  if (source == REMOTE && armedSlot != TRANSCRIPT_NO_STAMP) {
+    elementStamp = remoteStamps[armedSlot];  // Carimbo do remetente: o mesmo nas duas pontas
+  } else {
+    elementStamp = hlcTick(hlcClock, millis());  // Chave local, ou elemento sem sufixo (peer antigo, MOPP)
+  }
+  armedSlot = TRANSCRIPT_NO_STAMP;
+  if (firstOfLetter) {
+    letterStamp = elementStamp;
+    letterStamped = true;
+  }
+#else
+  (void)source;
+  (void)firstOfLetter;
+#endif
+}
+
+#if TRANSCRIPT_ENABLED
+static uint8_t keepRemoteStamp(const Hlc& remote, unsigned long now) {
+  hlcReceive(hlcClock, remote, now);
+  uint8_t slot = nextStampSlot;
+  nextStampSlot = (nextStampSlot + 1) % TRANSCRIPT_STAMPS;
+  remoteStamps[slot] = remote;
+  return slot;
+}
+#endif
+
+uint8_t queueRemoteStamp(const char* line, unsigned long now) {
+#if TRANSCRIPT_ENABLED
+  Hlc remote;
+  if (!hlcParse(line, remote)) return TRANSCRIPT_NO_STAMP;
+  return keepRemoteStamp(remote, now);
+#else
+  (void)line;
+  (void)now;
+  return TRANSCRIPT_NO_STAMP;
+#endif
+}
+
+uint8_t queueStamp(uint64_t packed, unsigned long now) {
+#if TRANSCRIPT_ENABLED
+  if (packed == 0) return TRANSCRIPT_NO_STAMP;
+  return keepRemoteStamp(hlcUnpack(packed), now);
+#else
+  (void)packed;
+  (void)now;
+  return TRANSCRIPT_NO_STAMP;
+#endif
+}
+
+void armRemoteStamp(uint8_t slot) {
+#if TRANSCRIPT_ENABLED
+  armedSlot = slot < TRANSCRIPT_STAMPS ? slot : TRANSCRIPT_NO_STAMP;
+#else
+  (void)slot;
+#endif
+}
+
+size_t formatElementStamp(char* out, size_t size) {
+#if TRANSCRIPT_ENABLED
+  return hlcFormat(elementStamp, out, size);
+#else
+  if (size > 0) out[0] = '\0';
+  return 0;
+#endif
+}
+
+uint64_t getElementStamp() {
+#if TRANSCRIPT_ENABLED
+  return hlcPack(elementStamp);
+#else
+  return 0;
+#endif
+}
+
+void updateTranscript() {
+#if TRANSCRIPT_ENABLED
+  settleUntil(hlcPhysical(hlcClock, millis()));
+#endif
+}
+
+uint32_t getTranscriptPending() {
+#if TRANSCRIPT_ENABLED
+  return entryCount - settledCount;
+#else
+  return 0;
+#endif
+}
+
+void dumpTranscript(Print& out) {
+#if TRANSCRIPT_ENABLED
+  out.print(millis());
+  out.print(" - Transcricao: node ");
+  out.print(hlcClock.last.node);
+  out.print(", HLC ");
+  out.print(hlcClock.last.l);
+  out.print(".");
+  out.print(hlcClock.last.c);
+  out.print(", offset +");
+  out.print(hlcClock.offset);
+  out.print(" ms (");
+  out.print(hlcClock.jumps);
+  out.print(" saltos), pendentes ");
+  out.print(entryCount - settledCount);
+  out.print(", tardios ");
+  out.println(lateLetters);
+  for (uint8_t i = 0; i < entryCount; i++) {
+    Hlc stamp = hlcUnpack(entries[i].stamp);
+    out.print(stamp.l);
+    out.print(".");
+    out.print(stamp.c);
+    out.print(".");
+    out.print(stamp.node);
+    out.print(entries[i].dir == TX ? " TX " : " RX ");
+    out.print(entries[i].letter);
+    out.println(i < settledCount ? "" : " *");  // * = ainda fora do log
+  }
+#else
+  out.println("Transcricao desabilitada (TRANSCRIPT_ENABLED = 0)");
+#endif
+}
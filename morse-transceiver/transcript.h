@@ -0,0 +1,34 @@
+#ifndef TRANSCRIPT_H
+#define TRANSCRIPT_H
+
+#include <Arduino.h>
+#include "cw-transceiver.h"
+#include "hlc.h"
+
+#define TRANSCRIPT_ENABLED 1    // 1 = carimbo HLC no protocolo e log do histórico na ordem dos carimbos
+#define TRANSCRIPT_SIZE 32      // Caracteres mantidos na transcrição ordenada (RAM)
+#define TRANSCRIPT_STAMPS 64    // Carimbos recebidos aguardando o decodificador (> fila do re-temporizador)
+#define TRANSCRIPT_SETTLE 2000  // ms de carimbo antes de gravar o caractere no log (chegadas atrasadas)
+#define TRANSCRIPT_NO_STAMP 0xFF
+
+void initTranscript(); // Node id do MAC e assinatura de caracteres (antes de initQsoIndex)
+
+void stampElement(InputSource source, bool firstOfLetter); // Chamada por captureInput(): carimba o elemento (e a letra no primeiro)
+
+uint8_t queueRemoteStamp(const char* line, unsigned long now); // "duration:...@l.c.node" recebido: absorve no relógio; devolve vaga (TRANSCRIPT_NO_STAMP se sem sufixo)
+
+uint8_t queueStamp(uint64_t packed, unsigned long now); // Igual, para carimbo já binário (multicast); 0 = sem carimbo
+
+void armRemoteStamp(uint8_t slot); // Re-temporizador: o próximo elemento REMOTE usa o carimbo da vaga
+
+size_t formatElementStamp(char* out, size_t size); // Sufixo "@l.c.node" do último elemento carimbado ("" se desabilitado)
+
+uint64_t getElementStamp(); // hlcPack() do último elemento carimbado (0 se desabilitado)
+
+void updateTranscript(); // Grava no log os caracteres assentados, na ordem dos carimbos
+
+uint32_t getTranscriptPending(); // Caracteres ainda fora do log (posição do próximo = getScrollbackLength() + isto)
+
+void dumpTranscript(Print& out); // Relógio e transcrição com carimbos
+
+#endif
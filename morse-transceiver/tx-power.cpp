@@ -0,0 +1,151 @@
+#include "tx-power.h"
+#include <ESP8266WiFi.h>
+#include "network.h"
+
+#define TXPOWER_MAX_DBM 20
+#define TXPOWER_MIN_DBM 0
+#define TXPOWER_STEP_DBM 2
+#define TXPOWER_TARGET_LOW -72           // RSSI no peer abaixo disso: sobe potência
+#define TXPOWER_TARGET_HIGH -62          // Acima disso: desce (janela = histerese)
+#define TXPOWER_ADJUST_INTERVAL 5000     // Intervalo entre ajustes
+#define TXPOWER_REPORT_TIMEOUT 10000     // AP sem "rssi:" do cliente: sobe potência
+#define TXPOWER_CURRENT_BASE_MA 80.0f    // Corrente em TX ~ base + slope * dBm
+#define TXPOWER_CURRENT_SLOPE_MA 4.5f
+#define TXPOWER_FRAME_AIRTIME_US 400     // Tempo no ar por quadro enviado (com preâmbulo e ACK)
+#define TXPOWER_BEACON_PERIOD_US 102400  // Beacons do soft-AP
+#define TXPOWER_BEACON_AIRTIME_US 300
+
+static int txPowerDbm = TXPOWER_MAX_DBM;
+static int peerTxPowerDbm = TXPOWER_MAX_DBM;  // Potência do AP informada via "txpower:"
+static int peerRssi16 = 0;                    // RSSI estimado no peer (média móvel, dBm x 16)
+static bool havePeerRssi = false;
+static unsigned long lastPeerReport = 0;
+static unsigned long lastAdjust = 0;
+static unsigned long lastEnergyUpdate = 0;
+static uint32_t framesSinceUpdate = 0;
+static double savedMilliampSeconds = 0;       // Economia acumulada vs. potência máxima
+static double txSeconds = 0;                  // Tempo no ar estimado (double: parcelas de µs somadas por semanas)
+static double txMilliampSeconds = 0;          // Carga gasta no ar na potência usada
+
+// Ponto fixo x16: com a média em dBm inteiros a divisão por 4 truncava e a
+// estimativa parava até 3 dB longe de uma entrada constante
+static void feedPeerRssi(int rssi) {
+  if (!havePeerRssi) {
+    peerRssi16 = rssi * 16;
+    havePeerRssi = true;
+  } else {
+    peerRssi16 += (rssi * 16 - peerRssi16) / 4;
+  }
+}
+
+static int peerRssiDbm() {
+  return (peerRssi16 + (peerRssi16 < 0 ? -8 : 8)) / 16;  // Arredonda para o dBm mais próximo
+}
+
+static void applyTxPower(int dbm, const char* reason) {
+  unsigned long now = millis();
+  dbm = constrain(dbm, TXPOWER_MIN_DBM, TXPOWER_MAX_DBM);
+  if (dbm == txPowerDbm) return;
+  txPowerDbm = dbm;
+  WiFi.setOutputPower(txPowerDbm);
+  havePeerRssi = false;  // Próxima decisão só com medidas na nova potência
+  Serial.print(now);
+  Serial.print(" - Potencia TX: ");
+  Serial.print(txPowerDbm);
+  Serial.print(" dBm (");
+  Serial.print(reason);
+  Serial.println(")");
+}
+
+static float txCurrentMilliamps(int dbm) {
+  return TXPOWER_CURRENT_BASE_MA + TXPOWER_CURRENT_SLOPE_MA * dbm;
+}
+
+void initTxPower() {
+  unsigned long now = millis();
+  txPowerDbm = TXPOWER_MAX_DBM;
+  WiFi.setOutputPower(txPowerDbm);
+  lastAdjust = now;
+  lastEnergyUpdate = now;
+  Serial.print(now);
+  Serial.print(" - Controle de potencia TX iniciado em ");
+  Serial.print(txPowerDbm);
+  Serial.println(" dBm");
+}
+
+void updateTxPower() {
+  unsigned long now = millis();
+
+  // Energia: tempo no ar estimado x diferença de corrente para a potência máxima
+  float elapsedUs = (float)(now - lastEnergyUpdate) * 1000.0f;
+  float airtimeUs = (float)framesSinceUpdate * TXPOWER_FRAME_AIRTIME_US;
+  if (netState == AP_MODE) airtimeUs += elapsedUs / TXPOWER_BEACON_PERIOD_US * TXPOWER_BEACON_AIRTIME_US;
+  txSeconds += airtimeUs / 1000000.0;
+  txMilliampSeconds += txCurrentMilliamps(txPowerDbm) * airtimeUs / 1000000.0;
+  savedMilliampSeconds += (txCurrentMilliamps(TXPOWER_MAX_DBM) - txCurrentMilliamps(txPowerDbm)) * airtimeUs / 1000000.0;
+  framesSinceUpdate = 0;
+  lastEnergyUpdate = now;
+
+  // Cliente: reciprocidade do enlace; RSSI no AP ~ RSSI medido + (minha potência - potência do AP)
+  if (netState == CONNECTED && WiFi.status() == WL_CONNECTED) {
+    feedPeerRssi(WiFi.RSSI() + (txPowerDbm - peerTxPowerDbm));
+    lastPeerReport = now;
+  }
+
+  if (now - lastAdjust < TXPOWER_ADJUST_INTERVAL) return;
+  lastAdjust = now;
+  if (!isConnected() || now - lastPeerReport > TXPOWER_REPORT_TIMEOUT) {
+    applyTxPower(txPowerDbm + TXPOWER_STEP_DBM, "sem medida do peer");
+  } else if (havePeerRssi && peerRssiDbm() > TXPOWER_TARGET_HIGH) {
+    applyTxPower(txPowerDbm - TXPOWER_STEP_DBM, "peer proximo");
+  } else if (havePeerRssi && peerRssiDbm() < TXPOWER_TARGET_LOW) {
+    applyTxPower(txPowerDbm + TXPOWER_STEP_DBM, "peer distante");
+  }
+}
+
+void reportPeerRssi(int rssi) {
+  if (rssi >= 0 || rssi < -120) return;  // Valor inválido
+  feedPeerRssi(rssi);
+  lastPeerReport = millis();
+}
+
+void reportPeerTxPower(int dbm) {
+  peerTxPowerDbm = constrain(dbm, TXPOWER_MIN_DBM, TXPOWER_MAX_DBM);
+}
+
+void noteTxFrame() {
+  framesSinceUpdate++;
+}
+
+void txPowerLinkLost() {
+  applyTxPower(TXPOWER_MAX_DBM, "perda de enlace");
+}
+
+int getTxPowerDbm() {
+  return txPowerDbm;
+}
+
+double getTxSeconds() {
+  return txSeconds;
+}
+
+double getTxMilliampSeconds() {
+  return txMilliampSeconds;
+}
+
+void dumpTxPower(Print& out) {
+  out.print("txpower: ");
+  out.print(txPowerDbm);
+  out.print(" dBm, RSSI estimado no peer: ");
+  if (havePeerRssi) {
+    out.print(peerRssiDbm());
+    out.print(" dBm");
+  } else {
+    out.print("-");
+  }
+  out.print(", tempo em TX: ");
+  out.print(txSeconds, 1);
+  out.print(" s, economia estimada: ");
+  out.print(savedMilliampSeconds / 3600.0, 4);
+  out.println(" mAh");
+}
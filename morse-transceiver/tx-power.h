@@ -0,0 +1,26 @@
+#ifndef TX_POWER_H
+#define TX_POWER_H
+
+#include <Arduino.h>
+
+void initTxPower(); // Começa na potência máxima
+
+void updateTxPower(); // Estima RSSI no peer, ajusta potência com histerese e integra energia economizada
+
+void reportPeerRssi(int rssi); // AP: RSSI com que o cliente nos ouve (mensagem "rssi:")
+
+void reportPeerTxPower(int dbm); // Cliente: potência atual do AP (mensagem "txpower:")
+
+void noteTxFrame(); // Conta quadro enviado (tempo no ar)
+
+void txPowerLinkLost(); // Perda de enlace: volta à potência máxima
+
+int getTxPowerDbm();
+
+double getTxSeconds(); // Tempo no ar estimado desde o boot
+
+double getTxMilliampSeconds(); // Carga gasta no ar (mA.s) na potência de cada momento
+
+void dumpTxPower(Print& out); // Potência, RSSI estimado e energia economizada
+
+#endif
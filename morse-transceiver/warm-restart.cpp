@@ -0,0 +1,116 @@
+#include "warm-restart.h"
+#include "cw-transceiver.h"
+#include "retimer.h"
+
+#define SNAPSHOT_MAGIC 0x314D5257UL  // "WRM1"
+#define SNAPSHOT_OFFSET 32           // Blocos de 4 bytes; os 128 bytes iniciais ficam para o comando do eboot (OTA)
+#define SNAPSHOT_MAX_STREAK 3        // Retomadas seguidas sem rodar SNAPSHOT_STABLE_TIME: estado suspeito, boot frio
+#define SNAPSHOT_STABLE_TIME 30000
+
+// Estado compacto gravado na memória RTC (sobrevive a resets, não a falta de energia)
+struct Snapshot {
+  uint32_t magic;
+  uint32_t crc;           // CRC-32 de tudo a partir de mode
+  uint8_t mode;
+  uint8_t state;
+  uint8_t charWpm;
+  uint8_t effectiveWpm;
+  uint8_t streak;         // Retomadas seguidas
+  uint8_t reserved;
+  uint16_t warmRestarts;  // Retomadas desde o último boot frio
+  NetworkResume network;
+  char historyTX[30];
+  char historyRX[30];
+};
+static_assert(sizeof(Snapshot) % 4 == 0, "a memória RTC é acessada em blocos de 4 bytes");
+
+static Snapshot snapshot;
+static uint32_t lastWrittenCrc = 0;
+static bool streakCleared = false;
+
+static uint32_t snapshotCrc(const Snapshot& s) {
+  const uint8_t* data = reinterpret_cast<const uint8_t*>(&s.mode);
+  size_t length = sizeof(Snapshot) - offsetof(Snapshot, mode);
+  uint32_t crc = 0xFFFFFFFF;
+  while (length--) {
+    crc ^= *data++;
+    for (uint8_t bit = 0; bit < 8; bit++) crc = (crc >> 1) ^ (0xEDB88320 & (0 - (crc & 1)));
+  }
+  return ~crc;
+}
+
+static void writeSnapshot() {
+  snapshot.magic = SNAPSHOT_MAGIC;
+  snapshot.crc = snapshotCrc(snapshot);
+  ESP.rtcUserMemoryWrite(SNAPSHOT_OFFSET, reinterpret_cast<uint32_t*>(&snapshot), sizeof(snapshot));
+  lastWrittenCrc = snapshot.crc;
+}
+
+bool loadSnapshot() {
+  unsigned long now = millis();
+#if WARM_RESTART_ENABLED
+  uint32_t reason = ESP.getResetInfoPtr()->reason;
+  // Boot frio (energia ligada sem queda parcial) deixa lixo na RTC: o CRC descarta
+  bool resetReason = reason == REASON_WDT_RST || reason == REASON_EXCEPTION_RST ||
+                     reason == REASON_SOFT_WDT_RST || reason == REASON_SOFT_RESTART ||
+                     reason == REASON_DEFAULT_RST;
+  bool valid = resetReason && ESP.rtcUserMemoryRead(SNAPSHOT_OFFSET, reinterpret_cast<uint32_t*>(&snapshot), sizeof(snapshot)) &&
+               snapshot.magic == SNAPSHOT_MAGIC && snapshot.crc == snapshotCrc(snapshot) &&
+               snapshot.historyTX[sizeof(snapshot.historyTX) - 1] == '\0' &&
+               snapshot.historyRX[sizeof(snapshot.historyRX) - 1] == '\0';
+  if (valid && snapshot.streak >= SNAPSHOT_MAX_STREAK) {
+    Serial.print(now);
+    Serial.println(" - Snapshot RTC ignorado: resets seguidos após retomada");
+    valid = false;
+  }
+  if (valid) {
+    snapshot.streak++;
+    snapshot.warmRestarts++;
+    writeSnapshot();  // Conta a retomada antes de qualquer coisa que possa travar de novo
+    Serial.print(now);
+    Serial.print(" - Snapshot RTC válido (reset ");
+    Serial.print(reason);
+    Serial.print("); retomada ");
+    Serial.println(snapshot.warmRestarts);
+    return true;
+  }
+#endif
+  memset(&snapshot, 0, sizeof(snapshot));
+  Serial.print(now);
+  Serial.println(" - Sem snapshot RTC; boot frio");
+  return false;
+}
+
+const NetworkResume& getSnapshotNetwork() {
+  return snapshot.network;
+}
+
+void applySnapshot() {
+  restoreTransceiver((Mode)snapshot.mode, (ConnectionState)snapshot.state, snapshot.historyTX, snapshot.historyRX);
+  if (snapshot.charWpm > 0) setRetime(snapshot.charWpm, snapshot.effectiveWpm);
+  Serial.print(millis());
+  Serial.print(" - Estado restaurado: TX \"");
+  Serial.print(snapshot.historyTX);
+  Serial.print("\", RX \"");
+  Serial.print(snapshot.historyRX);
+  Serial.println("\"");
+}
+
+void updateSnapshot() {
+#if WARM_RESTART_ENABLED
+  snapshot.mode = getMode();
+  snapshot.state = getConnectionState();
+  snapshot.charWpm = getRetimeCharWpm();
+  snapshot.effectiveWpm = getRetimeEffectiveWpm();
+  if (!streakCleared && millis() >= SNAPSHOT_STABLE_TIME) {
+    snapshot.streak = 0;  // Rodou estável: próximo reset pode retomar de novo
+    streakCleared = true;
+  }
+  getNetworkResume(snapshot.network);
+  strncpy(snapshot.historyTX, getHistoryTX(), sizeof(snapshot.historyTX) - 1);
+  snapshot.historyTX[sizeof(snapshot.historyTX) - 1] = '\0';
+  strncpy(snapshot.historyRX, getHistoryRX(), sizeof(snapshot.historyRX) - 1);
+  snapshot.historyRX[sizeof(snapshot.historyRX) - 1] = '\0';
+  if (snapshotCrc(snapshot) != lastWrittenCrc) writeSnapshot();
+#endif
+}
@@ -0,0 +1,17 @@
+#ifndef WARM_RESTART_H
+#define WARM_RESTART_H
+
+#include <Arduino.h>
+#include "network.h"
+
+#define WARM_RESTART_ENABLED 1  // 1 = guarda o estado na memória RTC e retoma direto após watchdog/exceção/queda de tensão
+
+bool loadSnapshot(); // Lê e valida (CRC) o snapshot da RTC; true = retomar sem splash nem scan
+
+const NetworkResume& getSnapshotNetwork(); // Papel e peer salvos (válido após loadSnapshot() == true)
+
+void applySnapshot(); // Devolve histórico, modo, estado e re-temporização aos módulos
+
+void updateSnapshot(); // Regrava o snapshot se o estado mudou (chamar a cada ~1 s)
+
+#endif
@@ -0,0 +1,95 @@
+// Benchmark of the batch Morse kernels (morse-table.cpp) against the per-character
+// lookups the firmware used before: linear search of the character list
+// (charToMorse) and strcmp over the symbol table (translateMorse).
+//
+// Build on the PC (from this folder):
+//   g++ -O2 -mssse3 -I../../morse-transceiver ../../morse-transceiver/morse-table.cpp morse-batch-bench.cpp -o morse-batch-bench
+// Drop -mssse3 to measure the portable (unrolled scalar) kernels.
+//
+// Usage: ./morse-batch-bench [symbols]   (default 4000000)
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+#include "morse-table.h"
+
+static const char* legacyCodes[] = {
+  ".-", "-...", "-.-.", "-..", ".", "..-.", "--.", "....", "..", ".---", "-.-", ".-..", "--", "-.", "---", ".--.", "--.-", ".-.", "...", "-", "..-", "...-", ".--", "-..-", "-.--", "--..",
+  "-----", ".----", "..---", "...--", "....-", ".....", "-....", "--...", "---..", "----.",
+  ".-.-.-", "--..--", "..--..", "-.-.-.", "-....-", "-..-."
+};
+static const char* legacyChars = "ABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789.,?;-/";
+static const size_t legacyCount = sizeof(legacyCodes) / sizeof(legacyCodes[0]);
+
+// Equivalente a charToMorse(): busca linear pelo caractere
+static uint8_t legacyEncode(char c) {
+  if (c == ' ') return MORSE_CODE_SPACE;
+  if (c >= 'a' && c <= 'z') c -= 'a' - 'A';
+  for (size_t i = 0; i < legacyCount; i++) {
+    if (legacyChars[i] == c) return morseCodeFromString(legacyCodes[i]);
+  }
+  return MORSE_CODE_NONE;
+}
+
+// Equivalente a translateMorse(): strcmp contra cada símbolo
+static char legacyDecode(const char* symbol) {
+  if (strcmp(symbol, "") == 0) return '\0';
+  for (size_t i = 0; i < legacyCount; i++) {
+    if (strcmp(symbol, legacyCodes[i]) == 0) return legacyChars[i];
+  }
+  return '\0';
+}
+
+template <typename F>
+static double seconds(F body) {
+  auto start = std::chrono::steady_clock::now();
+  body();
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, char** argv) {
+  size_t count = (argc > 1) ? strtoul(argv[1], nullptr, 10) : 4000000;
+  if (!verifyMorseBatch()) {
+    fprintf(stderr, "verifyMorseBatch() falhou\n");
+    return 1;
+  }
+
+  std::vector<char> text(count);
+  srand(12345);
+  for (size_t i = 0; i < count; i++) text[i] = legacyChars[rand() % legacyCount];
+  std::vector<uint8_t> legacyPacked(count), batchPacked(count);
+  std::vector<char> legacyText(count), batchText(count);
+  std::vector<char> symbols(count * (MORSE_MAX_ELEMENTS + 1));
+
+  double legacyEncodeTime = seconds([&] {
+    for (size_t i = 0; i < count; i++) legacyPacked[i] = legacyEncode(text[i]);
+  });
+  double batchEncodeTime = seconds([&] { encodeMorseBatch(text.data(), batchPacked.data(), count); });
+
+  // A decodificação legada trabalha sobre a string do símbolo, como currentSymbol
+  for (size_t i = 0; i < count; i++) morseCodeToString(batchPacked[i], &symbols[i * (MORSE_MAX_ELEMENTS + 1)]);
+  double legacyDecodeTime = seconds([&] {
+    for (size_t i = 0; i < count; i++) legacyText[i] = legacyDecode(&symbols[i * (MORSE_MAX_ELEMENTS + 1)]);
+  });
+  double batchDecodeTime = seconds([&] { decodeMorseBatch(batchPacked.data(), batchText.data(), count); });
+
+  if (memcmp(legacyPacked.data(), batchPacked.data(), count) != 0 || memcmp(legacyText.data(), batchText.data(), count) != 0 ||
+      memcmp(batchText.data(), text.data(), count) != 0) {
+    fprintf(stderr, "Resultados divergentes entre caminho legado e em lote\n");
+    return 1;
+  }
+
+#if defined(__SSSE3__)
+  const char* path = "SSSE3";
+#else
+  const char* path = "escalar";
+#endif
+  printf("%zu simbolos, codificacao em lote: %s\n", count, path);
+  printf("codificacao: legado %.1f Msym/s, lote %.1f Msym/s (%.1fx)\n", count / legacyEncodeTime / 1e6,
+         count / batchEncodeTime / 1e6, legacyEncodeTime / batchEncodeTime);
+  printf("decodificacao: legado %.1f Msym/s, lote %.1f Msym/s (%.1fx)\n", count / legacyDecodeTime / 1e6,
+         count / batchDecodeTime / 1e6, legacyDecodeTime / batchDecodeTime);
+  return 0;
+}
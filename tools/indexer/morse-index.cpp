@@ -0,0 +1,562 @@
+// Host indexer for the sessions archived by morse-recorderd. Decodes each session with
+// the firmware's Morse table and thresholds and keeps an on-disk inverted index
+// (word -> session, word offset, timestamp). The index is updated incrementally and
+// read through mmap.
+//
+// Build (from this folder):
+//   g++ -O2 -pthread -I../recorder -I../../morse-transceiver ../../morse-transceiver/morse-table.cpp morse-index.cpp -o morse-index
+//
+// Update: ./morse-index --archive <dir> --index <dir> [--threads n]
+//   Reads only the archive blocks it has not seen (plus those of sessions still open),
+//   decodes the sessions closed since the last run on n threads and adds one segment.
+// Search: ./morse-index --index <dir> [--near n] [--limit n] <word> [<word> ...]
+//   Sessions containing every word (with --near, within n words of the first word),
+//   with time, station and the words around each hit. Ex.: K2ABC 599 --near 6
+//
+// Index (in <dir>):
+//   state.txt       archive block to resume from, counts, last session start per station
+//   sessions.dat    SessionRecord per session (id = position)
+//   words.dat       WordRecord per decoded word; each session is contiguous (hit context)
+//   seg-NNNNNN.mix  SegmentHeader, TermEntry[] sorted by term, Posting[] by (session, offset)
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+#include <algorithm>
+#include <atomic>
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+#include "archive.h"
+#include "morse-table.h"
+
+// Mesmos limiares do firmware (cw-transceiver.h, exchange.cpp)
+static const uint64_t DEBOUNCE_TIME = 25;
+static const uint64_t SHORT_PRESS = 150;
+static const uint64_t LETTER_GAP = 800;
+static const uint64_t WORD_GAP = 1600;             // EXCHANGE_WORD_GAP
+static const uint64_t STALE_SESSION_US = 600000000ULL;  // Sessão sem "close" e parada há 10 min: fecha
+static const int TERM_LENGTH = 16;                 // Palavras maiores são truncadas em 15 caracteres
+
+struct SessionRecord {
+  char station[32];   // MAC da unidade
+  uint64_t startUs;
+  uint64_t endUs;
+  uint64_t firstWord;  // Em words.dat
+  uint32_t words;
+  uint32_t reserved;
+};
+
+struct WordRecord {
+  char text[TERM_LENGTH - 1];
+  uint8_t rx;         // 1 = recebido do peer ("<MAC>/peer")
+};
+
+struct Posting {
+  uint32_t session;
+  uint32_t offset;    // Palavra dentro da sessão
+  uint64_t atUs;      // Início do primeiro elemento da palavra
+};
+
+struct TermEntry {
+  char term[TERM_LENGTH];
+  uint64_t first;     // Índice do primeiro Posting do termo
+  uint32_t count;
+  uint32_t reserved;
+};
+
+struct SegmentHeader {
+  char magic[4];      // "MIX1"
+  uint32_t terms;
+  uint64_t postings;
+  uint32_t firstSession;
+  uint32_t lastSession;
+  uint64_t reserved;
+};
+
+static_assert(sizeof(SessionRecord) == 64, "layout da sessão");
+static_assert(sizeof(WordRecord) == 16, "layout da palavra");
+static_assert(sizeof(Posting) == 16, "layout do posting");
+static_assert(sizeof(TermEntry) == 32, "layout do termo");
+static_assert(sizeof(SegmentHeader) == 32, "layout do segmento");
+
+struct Element {
+  uint64_t atUs;      // Chegada (soltura da chave)
+  uint32_t duration;  // ms
+  uint8_t rx;
+};
+
+struct Session {
+  std::string station;
+  uint64_t startUs = 0;
+  uint64_t endUs = 0;
+  uint64_t startBlock = 0;
+  std::vector<Element> elements;
+};
+
+struct Word {
+  WordRecord record;
+  uint64_t atUs;
+};
+
+struct State {
+  uint64_t nextBlock = 0;
+  uint64_t sessions = 0;
+  uint64_t words = 0;
+  uint32_t segments = 0;
+  std::map<std::string, uint64_t> lastStart;  // Sessões até aqui já indexadas
+};
+
+static std::string indexPath(const char* dir, const char* name) {
+  return std::string(dir) + "/" + name;
+}
+
+static std::string segmentPath(const char* dir, uint32_t number) {
+  char name[32];
+  snprintf(name, sizeof(name), "seg-%06u.mix", number);
+  return indexPath(dir, name);
+}
+
+static void loadState(const char* dir, State& state) {
+  FILE* f = fopen(indexPath(dir, "state.txt").c_str(), "r");
+  if (f == nullptr) return;
+  char line[160];
+  while (fgets(line, sizeof(line), f)) {
+    char key[100];
+    unsigned long long value;
+    if (sscanf(line, "%99s %llu", key, &value) != 2) continue;
+    if (strcmp(key, "next-block") == 0) state.nextBlock = value;
+    else if (strcmp(key, "sessions") == 0) state.sessions = value;
+    else if (strcmp(key, "words") == 0) state.words = value;
+    else if (strcmp(key, "segments") == 0) state.segments = (uint32_t)value;
+    else state.lastStart[key] = value;
+  }
+  fclose(f);
+}
+
+// Escrito por último (tmp + rename): o que passar das contagens é de uma execução interrompida
+static bool saveState(const char* dir, const State& state) {
+  std::string path = indexPath(dir, "state.txt");
+  std::string tmp = path + ".tmp";
+  FILE* f = fopen(tmp.c_str(), "w");
+  if (f == nullptr) return false;
+  fprintf(f, "next-block %llu\nsessions %llu\nwords %llu\nsegments %u\n", (unsigned long long)state.nextBlock,
+          (unsigned long long)state.sessions, (unsigned long long)state.words, state.segments);
+  for (const auto& s : state.lastStart) fprintf(f, "%s %llu\n", s.first.c_str(), (unsigned long long)s.second);
+  bool ok = fflush(f) == 0 && fsync(fileno(f)) == 0;
+  fclose(f);
+  return ok && rename(tmp.c_str(), path.c_str()) == 0;
+}
+
+static bool appendFile(const std::string& path, uint64_t keepBytes, const void* data, size_t length) {
+  int fd = open(path.c_str(), O_WRONLY | O_CREAT, 0644);
+  if (fd < 0 || ftruncate(fd, keepBytes) != 0 || lseek(fd, 0, SEEK_END) < 0) return false;
+  const uint8_t* p = static_cast<const uint8_t*>(data);
+  while (length > 0) {
+    ssize_t n = write(fd, p, length);
+    if (n <= 0 && errno != EINTR) {
+      close(fd);
+      return false;
+    }
+    if (n > 0) {
+      p += n;
+      length -= n;
+    }
+  }
+  return close(fd) == 0;
+}
+
+// --- Leitura do arquivo de sessões ---
+
+static std::vector<std::string> loadStations(const char* archiveDir) {
+  std::vector<std::string> stations;
+  FILE* f = fopen(indexPath(archiveDir, "stations.txt").c_str(), "r");
+  if (f == nullptr) return stations;
+  char line[128];
+  while (fgets(line, sizeof(line), f)) {
+    line[strcspn(line, "\r\n")] = '\0';
+    stations.push_back(line);
+  }
+  fclose(f);
+  return stations;
+}
+
+// Sessões fechadas desde nextBlock; as ainda abertas definem onde a próxima execução retoma
+static bool readArchive(const char* archiveDir, State& state, std::vector<Session>& finished, uint64_t& resumeBlock) {
+  std::vector<std::string> stations = loadStations(archiveDir);
+  int idx = open(indexPath(archiveDir, "events.idx").c_str(), O_RDONLY);
+  int blk = open(indexPath(archiveDir, "events.blk").c_str(), O_RDONLY);
+  if (idx < 0 || blk < 0) return false;
+  std::map<std::string, Session> openSessions;
+  std::vector<uint8_t> block;
+  IndexEntry entry;
+  uint64_t number = state.nextBlock;
+  uint64_t lastUs = 0;
+  for (; pread(idx, &entry, sizeof(entry), number * sizeof(entry)) == (ssize_t)sizeof(entry); number++) {
+    BlockHeader h;
+    block.resize(entry.length);
+    if (pread(blk, &h, sizeof(h), entry.offset) != (ssize_t)sizeof(h) ||
+        pread(blk, block.data(), entry.length, entry.offset + sizeof(h)) != (ssize_t)entry.length ||
+        memcmp(h.magic, "MRB1", 4) != 0 || crc32(block.data(), entry.length) != h.crc) {
+      fprintf(stderr, "bloco %llu corrompido; ignorado\n", (unsigned long long)number);
+      continue;
+    }
+    uint64_t atUs = h.firstUs;
+    size_t pos = 0;
+    for (uint32_t i = 0; i < h.count; i++) {
+      uint64_t id, value;
+      uint8_t type;
+      if (!nextRecord(block.data(), h.length, pos, atUs, id, type, value)) break;
+      if (id >= stations.size()) continue;
+      if (atUs > lastUs) lastUs = atUs;
+      std::string name = stations[id];
+      bool rx = name.size() > 5 && name.compare(name.size() - 5, 5, "/peer") == 0;
+      if (rx) name.resize(name.size() - 5);
+      auto it = openSessions.find(name);
+      if (type == REC_OPEN && !rx) {
+        if (it != openSessions.end()) finished.push_back(std::move(it->second));  // Abriu de novo sem "close"
+        openSessions.erase(name);
+        auto done = state.lastStart.find(name);
+        if (done != state.lastStart.end() && done->second >= atUs) continue;  // Já indexada
+        Session& s = openSessions[name];
+        s.station = name;
+        s.startUs = s.endUs = atUs;
+        s.startBlock = number;
+      } else if (it == openSessions.end()) {
+        continue;  // Fora de sessão, ou de uma sessão já indexada
+      } else if (type == REC_CLOSE && !rx) {
+        it->second.endUs = atUs;
+        finished.push_back(std::move(it->second));
+        openSessions.erase(it);
+      } else if (type == REC_ELEMENT && value >= DEBOUNCE_TIME) {
+        it->second.elements.push_back({ atUs, (uint32_t)value, (uint8_t)rx });
+        it->second.endUs = atUs;
+      }
+    }
+  }
+  close(idx);
+  close(blk);
+  resumeBlock = number;
+  for (auto& o : openSessions) {
+    if (lastUs - o.second.endUs > STALE_SESSION_US) finished.push_back(std::move(o.second));  // Gravador caiu sem "close"
+    else resumeBlock = std::min(resumeBlock, o.second.startBlock);
+  }
+  std::sort(finished.begin(), finished.end(), [](const Session& a, const Session& b) { return a.startUs < b.startUs; });
+  return true;
+}
+
+// --- Decodificação (mesmo critério do decodificador do firmware) ---
+
+struct Decoder {
+  uint8_t code = 1;
+  uint64_t lastArrival = 0;
+  char text[TERM_LENGTH];
+  size_t length = 0;
+  uint64_t wordAt = 0;
+};
+
+static void closeLetter(Decoder& d) {
+  if (d.code == 1) return;
+  char c = decodeMorse(d.code);  // 0 (mais de 6 elementos) vira '*'
+  if (d.length < TERM_LENGTH - 1) d.text[d.length++] = c ? c : '*';
+  d.code = 1;
+}
+
+static void closeWord(Decoder& d, uint8_t rx, std::vector<Word>& words) {
+  closeLetter(d);
+  if (d.length == 0) return;
+  Word w = {};
+  memcpy(w.record.text, d.text, d.length);
+  w.record.rx = rx;
+  w.atUs = d.wordAt;
+  words.push_back(w);
+  d.length = 0;
+}
+
+static void decodeSession(const Session& s, std::vector<Word>& words) {
+  Decoder decoders[2];
+  int lastRx = -1;
+  for (const Element& e : s.elements) {
+    Decoder& d = decoders[e.rx];
+    uint64_t startUs = e.atUs - (uint64_t)e.duration * 1000;
+    if (lastRx >= 0 && lastRx != e.rx) closeWord(decoders[lastRx], lastRx, words);  // Troca de câmbio fecha a palavra
+    lastRx = e.rx;
+    if (d.lastArrival != 0 && startUs > d.lastArrival) {
+      uint64_t gap = (startUs - d.lastArrival) / 1000;
+      if (gap >= WORD_GAP) closeWord(d, e.rx, words);
+      else if (gap >= LETTER_GAP) closeLetter(d);
+    }
+    if (d.length == 0 && d.code == 1) d.wordAt = startUs;
+    if (d.code >= 1 << MORSE_MAX_ELEMENTS) d.code = 0;  // Longo demais para a tabela
+    else if (d.code != 0) d.code = (uint8_t)(d.code << 1 | (e.duration > SHORT_PRESS ? 1 : 0));
+    d.lastArrival = e.atUs;
+  }
+  closeWord(decoders[0], 0, words);
+  closeWord(decoders[1], 1, words);
+  std::stable_sort(words.begin(), words.end(), [](const Word& a, const Word& b) { return a.atUs < b.atUs; });
+}
+
+struct TermPosting {
+  char term[TERM_LENGTH];
+  Posting posting;
+};
+
+static bool termLess(const TermPosting& a, const TermPosting& b) {
+  int c = memcmp(a.term, b.term, TERM_LENGTH);
+  if (c != 0) return c < 0;
+  if (a.posting.session != b.posting.session) return a.posting.session < b.posting.session;
+  return a.posting.offset < b.posting.offset;
+}
+
+static int runUpdate(const char* archiveDir, const char* dir, unsigned threads) {
+  mkdir(dir, 0755);
+  State state;
+  loadState(dir, state);
+  std::vector<Session> sessions;
+  uint64_t resumeBlock = 0;
+  if (!readArchive(archiveDir, state, sessions, resumeBlock)) {
+    fprintf(stderr, "nao foi possivel ler o arquivo em %s\n", archiveDir);
+    return 1;
+  }
+
+  // Cada thread decodifica e tokeniza uma fatia das sessões e ordena seus postings
+  std::vector<std::vector<Word>> words(sessions.size());
+  std::vector<std::vector<TermPosting>> runs(threads);
+  std::atomic<size_t> nextSession(0);
+  std::vector<std::thread> workers;
+  for (unsigned t = 0; t < threads; t++) {
+    workers.emplace_back([&, t]() {
+      for (size_t i; (i = nextSession++) < sessions.size();) {
+        decodeSession(sessions[i], words[i]);
+        for (size_t w = 0; w < words[i].size(); w++) {
+          TermPosting tp = {};
+          memcpy(tp.term, words[i][w].record.text, TERM_LENGTH - 1);
+          tp.posting = { (uint32_t)(state.sessions + i), (uint32_t)w, words[i][w].atUs };
+          runs[t].push_back(tp);
+        }
+      }
+      std::sort(runs[t].begin(), runs[t].end(), termLess);
+    });
+  }
+  for (auto& w : workers) w.join();
+  std::vector<TermPosting> all;
+  for (auto& run : runs) {
+    size_t middle = all.size();
+    all.insert(all.end(), run.begin(), run.end());
+    std::inplace_merge(all.begin(), all.begin() + middle, all.end(), termLess);
+    std::vector<TermPosting>().swap(run);
+  }
+
+  // Palavras e sessões (contíguas por sessão); descarta sobras de execução interrompida
+  std::vector<WordRecord> wordRecords;
+  std::vector<SessionRecord> sessionRecords;
+  uint64_t firstWord = state.words;
+  for (size_t i = 0; i < sessions.size(); i++) {
+    SessionRecord r = {};
+    snprintf(r.station, sizeof(r.station), "%s", sessions[i].station.c_str());
+    r.startUs = sessions[i].startUs;
+    r.endUs = sessions[i].endUs;
+    r.firstWord = firstWord;
+    r.words = (uint32_t)words[i].size();
+    firstWord += r.words;
+    sessionRecords.push_back(r);
+    for (const Word& w : words[i]) wordRecords.push_back(w.record);
+    uint64_t& last = state.lastStart[sessions[i].station];
+    if (sessions[i].startUs > last) last = sessions[i].startUs;
+  }
+  if (!appendFile(indexPath(dir, "words.dat"), state.words * sizeof(WordRecord), wordRecords.data(), wordRecords.size() * sizeof(WordRecord)) ||
+      !appendFile(indexPath(dir, "sessions.dat"), state.sessions * sizeof(SessionRecord), sessionRecords.data(), sessionRecords.size() * sizeof(SessionRecord))) {
+    perror("gravando indice");
+    return 1;
+  }
+
+  if (!all.empty()) {
+    std::vector<TermEntry> terms;
+    std::vector<Posting> postings(all.size());
+    for (size_t i = 0; i < all.size(); i++) {
+      if (terms.empty() || memcmp(terms.back().term, all[i].term, TERM_LENGTH) != 0) {
+        TermEntry e = {};
+        memcpy(e.term, all[i].term, TERM_LENGTH);
+        e.first = i;
+        terms.push_back(e);
+      }
+      terms.back().count++;
+      postings[i] = all[i].posting;
+    }
+    SegmentHeader h = {};
+    memcpy(h.magic, "MIX1", 4);
+    h.terms = (uint32_t)terms.size();
+    h.postings = postings.size();
+    h.firstSession = (uint32_t)state.sessions;
+    h.lastSession = (uint32_t)(state.sessions + sessions.size() - 1);
+    std::string path = segmentPath(dir, state.segments);
+    FILE* f = fopen(path.c_str(), "wb");
+    if (f == nullptr || fwrite(&h, sizeof(h), 1, f) != 1 ||
+        fwrite(terms.data(), sizeof(TermEntry), terms.size(), f) != terms.size() ||
+        fwrite(postings.data(), sizeof(Posting), postings.size(), f) != postings.size() || fclose(f) != 0) {
+      perror(path.c_str());
+      return 1;
+    }
+    state.segments++;
+    printf("segmento %s: %u termos, %zu ocorrencias\n", path.c_str(), h.terms, postings.size());
+  }
+  state.sessions += sessions.size();
+  state.words = firstWord;
+  state.nextBlock = resumeBlock;
+  if (!saveState(dir, state)) {
+    perror("state.txt");
+    return 1;
+  }
+  printf("%zu sessoes novas (%zu palavras) com %u threads; total %llu sessoes, retoma no bloco %llu\n",
+         sessions.size(), wordRecords.size(), threads, (unsigned long long)state.sessions,
+         (unsigned long long)state.nextBlock);
+  return 0;
+}
+
+// --- Consulta ---
+
+struct Mapped {
+  const uint8_t* data = nullptr;
+  size_t size = 0;
+};
+
+static Mapped mapFile(const std::string& path) {
+  Mapped m;
+  int fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0) return m;
+  struct stat st;
+  if (fstat(fd, &st) == 0 && st.st_size > 0) {
+    void* p = mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    if (p != MAP_FAILED) {
+      m.data = static_cast<const uint8_t*>(p);
+      m.size = st.st_size;
+    }
+  }
+  close(fd);
+  return m;
+}
+
+// Lista de postings do termo no segmento (busca binária na tabela de termos mapeada)
+static const Posting* findTerm(const Mapped& segment, const char* term, uint32_t* count) {
+  const SegmentHeader* h = reinterpret_cast<const SegmentHeader*>(segment.data);
+  const TermEntry* terms = reinterpret_cast<const TermEntry*>(h + 1);
+  const Posting* postings = reinterpret_cast<const Posting*>(terms + h->terms);
+  char key[TERM_LENGTH] = {};
+  strncpy(key, term, TERM_LENGTH - 1);
+  const TermEntry* end = terms + h->terms;
+  const TermEntry* e = std::lower_bound(terms, end, key, [](const TermEntry& a, const char* k) { return memcmp(a.term, k, TERM_LENGTH) < 0; });
+  *count = 0;
+  if (e == end || memcmp(e->term, key, TERM_LENGTH) != 0) return nullptr;
+  *count = e->count;
+  return postings + e->first;
+}
+
+static void printContext(const Mapped& words, const SessionRecord& s, uint32_t offset) {
+  const WordRecord* all = reinterpret_cast<const WordRecord*>(words.data);
+  uint32_t from = offset > 6 ? offset - 6 : 0;
+  uint32_t to = std::min(s.words, offset + 7);
+  printf("   ");
+  for (uint32_t i = from; i < to; i++) {
+    uint64_t at = s.firstWord + i;
+    if ((at + 1) * sizeof(WordRecord) > words.size) break;
+    char text[TERM_LENGTH] = {};
+    memcpy(text, all[at].text, TERM_LENGTH - 1);
+    printf(i == offset ? " [%c%s]" : " %c%s", all[at].rx ? '<' : '>', text);
+  }
+  printf("\n");
+}
+
+static int runSearch(const char* dir, std::vector<std::string> query, uint32_t near, size_t limit) {
+  timespec start;
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  State state;
+  loadState(dir, state);
+  for (std::string& q : query) std::transform(q.begin(), q.end(), q.begin(), ::toupper);
+  Mapped sessions = mapFile(indexPath(dir, "sessions.dat"));
+  Mapped words = mapFile(indexPath(dir, "words.dat"));
+  const SessionRecord* sessionTable = reinterpret_cast<const SessionRecord*>(sessions.data);
+  size_t sessionCount = std::min<uint64_t>(state.sessions, sessions.size / sizeof(SessionRecord));
+  size_t hits = 0, matchedSessions = 0;
+  for (uint32_t n = 0; n < state.segments && hits < limit; n++) {
+    Mapped segment = mapFile(segmentPath(dir, n));
+    if (segment.size < sizeof(SegmentHeader) || memcmp(segment.data, "MIX1", 4) != 0) continue;
+    std::vector<const Posting*> lists(query.size());
+    std::vector<uint32_t> counts(query.size());
+    bool all = true;
+    for (size_t q = 0; q < query.size(); q++) {
+      lists[q] = findTerm(segment, query[q].c_str(), &counts[q]);
+      all = all && lists[q] != nullptr;
+    }
+    if (all) {
+      // Postings ordenados por (sessão, offset): percorre o primeiro termo e avança os demais
+      std::vector<uint32_t> cursor(query.size(), 0);
+      uint32_t lastSession = UINT32_MAX;
+      for (uint32_t i = 0; i < counts[0] && hits < limit; i++) {
+        const Posting& p = lists[0][i];
+        bool match = true;
+        for (size_t q = 1; q < query.size() && match; q++) {
+          uint32_t lowest = near && p.offset > near ? p.offset - near : 0;
+          while (cursor[q] < counts[q] && (lists[q][cursor[q]].session < p.session ||
+                 (near && lists[q][cursor[q]].session == p.session && lists[q][cursor[q]].offset < lowest))) cursor[q]++;
+          match = cursor[q] < counts[q] && lists[q][cursor[q]].session == p.session &&
+                  (!near || lists[q][cursor[q]].offset <= p.offset + near);
+        }
+        if (!match || (!near && p.session == lastSession)) continue;  // Sem --near: uma linha por sessão
+        if (p.session != lastSession) matchedSessions++;
+        lastSession = p.session;
+        hits++;
+        if (p.session >= sessionCount) continue;
+        const SessionRecord& s = sessionTable[p.session];
+        time_t seconds = (time_t)(p.atUs / 1000000);
+        tm utc;
+        gmtime_r(&seconds, &utc);
+        char stamp[32];
+        strftime(stamp, sizeof(stamp), "%Y-%m-%dT%H:%M:%S", &utc);
+        printf("sessao %u  %s  %s.%03uZ  palavra %u\n", p.session, s.station, stamp, (unsigned)(p.atUs / 1000 % 1000), p.offset);
+        printContext(words, s, p.offset);
+      }
+    }
+    munmap((void*)segment.data, segment.size);
+  }
+  timespec end;
+  clock_gettime(CLOCK_MONOTONIC, &end);
+  double ms = (end.tv_sec - start.tv_sec) * 1e3 + (end.tv_nsec - start.tv_nsec) / 1e6;
+  fprintf(stderr, "%zu ocorrencias em %zu sessoes (%u segmentos, %llu sessoes indexadas) em %.2f ms\n", hits,
+          matchedSessions, state.segments, (unsigned long long)state.sessions, ms);
+  return hits > 0 ? 0 : 1;
+}
+
+int main(int argc, char** argv) {
+  const char* archiveDir = nullptr;
+  const char* dir = nullptr;
+  unsigned threads = std::max(1u, std::thread::hardware_concurrency());
+  uint32_t near = 0;
+  size_t limit = 50;
+  std::vector<std::string> query;
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "--archive") == 0 && i + 1 < argc) archiveDir = argv[++i];
+    else if (strcmp(argv[i], "--index") == 0 && i + 1 < argc) dir = argv[++i];
+    else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) threads = std::max(1, atoi(argv[++i]));
+    else if (strcmp(argv[i], "--near") == 0 && i + 1 < argc) near = atoi(argv[++i]);
+    else if (strcmp(argv[i], "--limit") == 0 && i + 1 < argc) limit = atoi(argv[++i]);
+    else if (argv[i][0] != '-') query.push_back(argv[i]);
+    else {
+      dir = nullptr;
+      break;
+    }
+  }
+  if (dir == nullptr || (archiveDir == nullptr) == query.empty()) {
+    fprintf(stderr, "uso: %s --archive <dir> --index <dir> [--threads n]\n"
+                    "     %s --index <dir> [--near n] [--limit n] <palavra> [<palavra> ...]\n", argv[0], argv[0]);
+    return 2;
+  }
+  if (archiveDir != nullptr) return runUpdate(archiveDir, dir, threads);
+  return runSearch(dir, query, near, limit);
+}
@@ -0,0 +1,205 @@
+// Host check of the PTT/key sequencing (keyer-sequencer.cpp, same file as the
+// firmware) in simulated microsecond time. Feeds bouncy key edges for a few words,
+// runs the sequencer at each deadline it returns (plus a random ISR latency) and
+// verifies every output edge against the input. A clean tap shorter than the
+// debounce window checks that the level read at the end of the window releases it.
+//
+// Build (from this folder):
+//   g++ -O2 -I../../morse-transceiver ../../morse-transceiver/keyer-sequencer.cpp
+//       ../../morse-transceiver/morse-table.cpp keyer-timing.cpp -o keyer-timing
+//
+// Run: ./keyer-timing [--lead ms] [--hang ms] [--tail ms] [--wpm n] [--jitter us] [-v]
+//   Exit status 0 when every check passes.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+#include "keyer-sequencer.h"
+#include "morse-table.h"
+
+struct Edge {
+  uint32_t at;
+  bool down;
+};
+
+struct Change {
+  uint32_t at;
+  uint8_t outputs;
+};
+
+enum Kind { EXACT, TAP, STUCK };  // Duração esperada na saída: igual, até o fim do repique, até o limite
+
+static std::vector<Edge> inputs;     // Bordas brutas da chave (com repique)
+static std::vector<Edge> elements;   // Bordas limpas esperadas na saída (sem o atraso)
+static std::vector<Kind> kinds;      // Um por elemento (par de bordas)
+
+// Acrescenta uma borda limpa e o repique do contato (3 trocas em ~1,5 ms)
+static void keyEdge(uint32_t at, bool down) {
+  if (down) kinds.push_back(EXACT);
+  elements.push_back({ at, down });
+  inputs.push_back({ at, down });
+  inputs.push_back({ at + 400, !down });
+  inputs.push_back({ at + 900, down });
+}
+
+// Toque limpo mais curto que o repique: a subida cai na janela e só o nível no fim dela a recupera
+static void keyTap(uint32_t at, uint32_t lengthUs) {
+  kinds.push_back(TAP);
+  elements.push_back({ at, true });
+  elements.push_back({ at + lengthUs, false });
+  inputs.push_back({ at, true });
+  inputs.push_back({ at + lengthUs, false });
+}
+
+// Texto em Morse a partir de "at"; devolve o instante após o último elemento
+static uint32_t keyText(const char* text, uint32_t at, uint32_t ditUs) {
+  for (const char* c = text; *c != '\0'; c++) {
+    if (*c == ' ') {
+      at += 4 * ditUs;  // 3 dits já contados após a letra anterior = 7
+      continue;
+    }
+    char symbol[8];
+    morseCodeToString(encodeMorse(*c), symbol);
+    for (const char* e = symbol; *e != '\0'; e++) {
+      uint32_t length = (*e == '.') ? ditUs : 3 * ditUs;
+      keyEdge(at, true);
+      keyEdge(at + length, false);
+      at += length + ditUs;
+    }
+    at += 2 * ditUs;
+  }
+  return at;
+}
+
+static bool fail(const char* what, uint32_t at, long value) {
+  printf("FALHA: %s em %u us (%ld)\n", what, at, value);
+  return false;
+}
+
+int main(int argc, char** argv) {
+  KeyerConfig config = { 15000, 400000, 8000, 5000, 5000000 };
+  unsigned wpm = 25;
+  unsigned jitter = 6;
+  bool verbose = false;
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "--lead") == 0 && i + 1 < argc) config.leadUs = atoi(argv[++i]) * 1000;
+    else if (strcmp(argv[i], "--hang") == 0 && i + 1 < argc) config.hangUs = atoi(argv[++i]) * 1000;
+    else if (strcmp(argv[i], "--tail") == 0 && i + 1 < argc) config.tailUs = atoi(argv[++i]) * 1000;
+    else if (strcmp(argv[i], "--wpm") == 0 && i + 1 < argc) wpm = atoi(argv[++i]);
+    else if (strcmp(argv[i], "--jitter") == 0 && i + 1 < argc) jitter = atoi(argv[++i]);
+    else if (strcmp(argv[i], "-v") == 0) verbose = true;
+    else {
+      fprintf(stderr, "uso: %s [--lead ms] [--hang ms] [--tail ms] [--wpm n] [--jitter us] [-v]\n", argv[0]);
+      return 2;
+    }
+  }
+  uint32_t dit = 1200000 / wpm;
+
+  // Cenário: duas palavras dentro do hang, pausa longa (PTT cai), mais uma palavra,
+  // um toque de 3 ms (menor que o repique) isolado, e por fim a chave presa por 7 s
+  uint32_t at = keyText("CQ DE", 100000, dit);
+  at = keyText("K", at + config.hangUs + config.leadUs + 500000, dit);
+  uint32_t tapAt = at + config.hangUs + config.leadUs + 500000;
+  keyTap(tapAt, 3000);
+  uint32_t stuckAt = tapAt + 2000000;
+  keyEdge(stuckAt, true);
+  keyEdge(stuckAt + 7000000, false);
+  kinds.back() = STUCK;  // A chave presa vira um elemento truncado
+
+  KeyerSequencer keyer;
+  keyerBegin(keyer, config);
+  std::vector<Change> changes;
+  uint8_t last = 0;
+  uint32_t now = 0;
+  uint32_t deadline = 0;  // 0 = timer parado
+  size_t next = 0;
+  bool pinDown = false;  // Nível real do pino, lido pelo firmware no fim do repique
+  srand(1);
+  for (;;) {
+    bool haveInput = next < inputs.size();
+    if (!haveInput && deadline == 0) break;
+    bool fromInput = haveInput && (deadline == 0 || (int32_t)(inputs[next].at - deadline) <= 0);
+    if (fromInput) {
+      now = inputs[next].at + (jitter ? rand() % (jitter + 1) : 0);  // Latência da ISR da chave
+      pinDown = inputs[next].down;
+      keyerInput(keyer, pinDown, now);
+      next++;
+    } else {
+      now = deadline;
+    }
+    keyerSettle(keyer, pinDown, now);  // Como runAndArm() em keyer.cpp, antes de cada keyerRun()
+    uint32_t wait = keyerRun(keyer, now);
+    deadline = wait ? now + wait + (jitter ? rand() % (jitter + 1) : 0) : 0;  // Latência da ISR do timer1
+    if (keyer.outputs != last) {
+      changes.push_back({ now, keyer.outputs });
+      last = keyer.outputs;
+    }
+  }
+
+  bool ok = true;
+  uint32_t pttOnAt = 0, keyUpAt = 0, keyDownAt = 0;
+  size_t outElements = 0;
+  long worstError = 0;
+  long tapLength = -1;
+  uint8_t prev = 0;
+  for (const Change& c : changes) {
+    if (verbose) printf("%10u us  PTT %d  KEY %d\n", c.at, (c.outputs & KEYER_OUT_PTT) ? 1 : 0, (c.outputs & KEYER_OUT_KEY) ? 1 : 0);
+    bool key = c.outputs & KEYER_OUT_KEY, ptt = c.outputs & KEYER_OUT_PTT;
+    bool wasKey = prev & KEYER_OUT_KEY, wasPtt = prev & KEYER_OUT_PTT;
+    if (key && !ptt) ok = fail("chave sem PTT", c.at, 0);
+    if (ptt && !wasPtt) pttOnAt = c.at;
+    if (key && !wasKey) {
+      keyDownAt = c.at;
+      if (c.at - pttOnAt < config.leadUs) ok = fail("chave antes do lead", c.at, c.at - pttOnAt);
+      // Mesmo elemento na entrada: a saída é a entrada atrasada de leadUs
+      if (outElements < kinds.size()) {
+        long error = (long)(c.at - config.leadUs) - (long)elements[2 * outElements].at;
+        if (labs(error) > worstError) worstError = labs(error);
+      }
+    }
+    if (!key && wasKey) {
+      keyUpAt = c.at;
+      long outLength = (long)(c.at - keyDownAt);
+      Kind kind = outElements < kinds.size() ? kinds[outElements] : EXACT;
+      long inLength = outElements < kinds.size() ? (long)(elements[2 * outElements + 1].at - elements[2 * outElements].at) : 0;
+      if (kind == EXACT) {
+        if (labs(outLength - inLength) > worstError) worstError = labs(outLength - inLength);
+      } else if (kind == TAP) {
+        // A subida descartada volta no fim da janela: o toque dura no máximo o repique
+        tapLength = outLength;
+        if (outLength < inLength || outLength > (long)(config.debounceUs + 2 * jitter)) ok = fail("toque curto fora da janela de repique", c.at, outLength);
+      } else if (outLength > (long)config.maxDownUs + (long)jitter) {
+        ok = fail("chave presa além do limite", c.at, outLength);
+      }
+      outElements++;
+    }
+    if (!ptt && wasPtt && c.at - keyUpAt < config.tailUs) ok = fail("PTT caiu antes do tail", c.at, c.at - keyUpAt);
+    prev = c.outputs;
+  }
+  if (prev != 0) ok = fail("saídas não voltaram ao repouso", now, prev);
+  if (outElements != kinds.size()) ok = fail("elementos na saída", now, (long)outElements);
+  if (tapLength < 0) ok = fail("toque curto sem elemento na saída", now, 0);
+  if (worstError > 2 * (long)jitter) ok = fail("erro de tempo acima da latência simulada", now, worstError);
+  // PTT cai numa pausa maior que lead + hang (o toque seguinte chega depois da queda)
+  size_t expectedCycles = 1;
+  uint32_t hold = config.hangUs > config.tailUs ? config.hangUs : config.tailUs;
+  for (size_t i = 2; i < elements.size(); i += 2) {
+    if (elements[i].at - elements[i - 1].at >= config.leadUs + hold) expectedCycles++;
+  }
+  size_t pttCycles = 0;
+  prev = 0;
+  for (const Change& c : changes) {
+    if ((c.outputs & KEYER_OUT_PTT) && !(prev & KEYER_OUT_PTT)) pttCycles++;
+    prev = c.outputs;
+  }
+  if (pttCycles != expectedCycles) ok = fail("ciclos de PTT", now, (long)pttCycles);
+
+  printf("lead %u us, hang %u us, tail %u us, %u WPM (dit %u us), latência simulada até %u us\n",
+         config.leadUs, config.hangUs, config.tailUs, wpm, dit, jitter);
+  printf("%zu bordas de entrada (com repique), %zu elementos na saída, %zu ciclos de PTT (esperados %zu)\n",
+         inputs.size(), outElements, pttCycles, expectedCycles);
+  printf("pior erro de borda/duração: %ld us; toque de 3 ms saiu com %ld us (repique %u us)\n", worstError, tapLength, config.debounceUs);
+  printf("%s\n", ok ? "OK" : "FALHOU");
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,194 @@
+// Host simulation of the class multicast stream (mcast-stream.cpp, same file as the
+// firmware) in simulated millisecond time. One sender publishes an element every
+// 60 ms to a group of listeners; every packet (DATA, HEARTBEAT, NACK, REPAIR) is
+// dropped independently per receiver with the given probability. Listeners NACK to
+// the group, hold back when they hear another listener's NACK, and the sender
+// repairs to the group, as multicast.cpp does.
+//
+// Build (from this folder):
+//   g++ -O2 -I../../morse-transceiver ../../morse-transceiver/mcast-stream.cpp
+//       mcast-sim.cpp -o mcast-sim
+//
+// Run: ./mcast-sim [--listeners n] [--loss p] [--elements n] [--seed n] [-v]
+//   Exit status 0 when every listener got every element from the first packet it
+//   heard (earlier ones are never asked for, as for a late joiner), in order.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <deque>
+#include <vector>
+#include "mcast-stream.h"
+
+#define ELEMENT_MS 60          // Um elemento a cada 60 ms (dit de 20 WPM)
+#define NET_DELAY_MS 2         // Atraso do grupo no Wi-Fi
+#define HEARTBEAT_MS 1000      // Como multicast.cpp: a cada 1 s enquanto o último elemento tem menos de 10 s
+#define HEARTBEAT_ACTIVE_MS 10000
+#define SENDER_NODE 1
+#define SENDER -1              // Origem dos pacotes do transmissor na fila
+
+struct Packet {
+  uint32_t at;
+  int from;  // Receptor que mandou (NACK) ou SENDER
+  uint8_t data[MCAST_MAX_PACKET];
+  size_t length;
+};
+
+static std::deque<Packet> group;
+static double loss = 0.05;
+static size_t sentData = 0, sentHeartbeat = 0, sentNack = 0, sentRepair = 0;
+
+static bool dropped() {
+  return (double)rand() / RAND_MAX < loss;
+}
+
+static void send(uint32_t now, int from, const McastPacket& packet) {
+  Packet p;
+  p.at = now + NET_DELAY_MS;
+  p.from = from;
+  p.length = mcastEncode(packet, p.data, sizeof(p.data));
+  group.push_back(p);
+  switch (packet.type) {
+    case MCAST_DATA: sentData++; break;
+    case MCAST_HEARTBEAT: sentHeartbeat++; break;
+    case MCAST_NACK: sentNack++; break;
+    case MCAST_REPAIR: sentRepair++; break;
+  }
+}
+
+static McastPacket elementPacket(McastType type, const McastEvent& event) {
+  McastPacket p = {};
+  p.type = type;
+  p.node = SENDER_NODE;
+  p.seq = event.seq;
+  p.duration = event.duration;
+  p.stamp = event.stamp;
+  return p;
+}
+
+int main(int argc, char** argv) {
+  unsigned listeners = 20;
+  unsigned elements = 2000;
+  unsigned seed = 7;
+  bool verbose = false;
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "--listeners") == 0 && i + 1 < argc) listeners = atoi(argv[++i]);
+    else if (strcmp(argv[i], "--loss") == 0 && i + 1 < argc) loss = atof(argv[++i]);
+    else if (strcmp(argv[i], "--elements") == 0 && i + 1 < argc) elements = atoi(argv[++i]);
+    else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) seed = atoi(argv[++i]);
+    else if (strcmp(argv[i], "-v") == 0) verbose = true;
+    else {
+      fprintf(stderr, "uso: %s [--listeners n] [--loss p] [--elements n] [--seed n] [-v]\n", argv[0]);
+      return 2;
+    }
+  }
+  if (listeners == 0 || elements == 0) {
+    fprintf(stderr, "listeners e elements precisam ser maiores que 0\n");
+    return 2;
+  }
+  srand(seed);
+
+  McastSender sender;
+  mcastSenderBegin(sender, 0xFFFFFFF0u);  // Perto do fim: a sequência dá a volta no meio da simulação
+  std::vector<McastReceiver> receivers(listeners);
+  std::vector<std::vector<uint32_t>> got(listeners);
+  for (unsigned i = 0; i < listeners; i++) mcastReceiverBegin(receivers[i], seed * 1000 + i);
+
+  unsigned published = 0;
+  uint32_t lastSeq = 0, lastPublishAt = 0, lastHeartbeatAt = 0;
+  uint32_t end = elements * ELEMENT_MS + HEARTBEAT_ACTIVE_MS + 1000;
+  for (uint32_t now = 1; now < end; now++) {
+    if (published < elements && now % ELEMENT_MS == 0) {
+      McastEvent event = mcastPublish(sender, ELEMENT_MS, 0);
+      send(now, SENDER, elementPacket(MCAST_DATA, event));
+      lastSeq = event.seq;
+      lastPublishAt = now;
+      published++;
+    }
+    if (published > 0 && now - lastPublishAt < HEARTBEAT_ACTIVE_MS && now - lastHeartbeatAt >= HEARTBEAT_MS) {
+      McastPacket p = {};
+      p.type = MCAST_HEARTBEAT;
+      p.node = SENDER_NODE;
+      p.seq = lastSeq;
+      send(now, SENDER, p);
+      lastHeartbeatAt = now;
+    }
+
+    while (!group.empty() && group.front().at <= now) {
+      Packet k = group.front();
+      group.pop_front();
+      McastPacket p;
+      if (!mcastDecode(k.data, k.length, p)) {
+        printf("FALHA: pacote invalido em %u ms\n", now);
+        return 1;
+      }
+      // O NACK também passa pela perda até o transmissor
+      if (p.type == MCAST_NACK && p.target == SENDER_NODE && !dropped()) {
+        McastEvent out[MCAST_NACK_MAX];
+        size_t n = mcastRepair(sender, p.seq, p.count, now, out, MCAST_NACK_MAX);
+        for (size_t i = 0; i < n; i++) send(now, SENDER, elementPacket(MCAST_REPAIR, out[i]));
+      }
+      for (unsigned i = 0; i < listeners; i++) {
+        if ((int)i == k.from || dropped()) continue;
+        McastReceiver& r = receivers[i];
+        if (p.type == MCAST_DATA || p.type == MCAST_REPAIR) {
+          McastEvent event = { p.seq, p.duration, p.stamp };
+          mcastAccept(r, event, now);
+        } else if (p.type == MCAST_HEARTBEAT) {
+          mcastHeartbeat(r, p.seq, now);
+        } else if (p.type == MCAST_NACK) {
+          mcastNackHeard(r, p.seq, now);
+        }
+      }
+    }
+
+    for (unsigned i = 0; i < listeners; i++) {
+      uint32_t first;
+      uint8_t count;
+      if (mcastPoll(receivers[i], now, first, count)) {
+        McastPacket p = {};
+        p.type = MCAST_NACK;
+        p.node = (uint16_t)(100 + i);
+        p.seq = first;
+        p.target = SENDER_NODE;
+        p.count = count;
+        send(now, (int)i, p);
+        if (verbose) printf("%8u ms  ouvinte %2u NACK %u +%u\n", now, i, first, count);
+      }
+      McastEvent event;
+      while (mcastNext(receivers[i], event)) got[i].push_back(event.seq);
+    }
+  }
+
+  // O primeiro pacote ouvido define o início (como quem entra no meio da aula): o que
+  // veio antes não é pedido. Dali até o último elemento nada pode faltar.
+  bool ok = true;
+  unsigned complete = 0;
+  uint32_t lost = 0, recovered = 0;
+  size_t beforeSync = 0;
+  for (unsigned i = 0; i < listeners; i++) {
+    bool inOrder = !got[i].empty() && got[i].back() == lastSeq;
+    for (size_t j = 1; inOrder && j < got[i].size(); j++) {
+      if (got[i][j] != got[i][j - 1] + 1) inOrder = false;
+    }
+    if (inOrder) {
+      complete++;
+      beforeSync += elements - got[i].size();
+    } else {
+      printf("FALHA: ouvinte %u recebeu %zu de %u elementos fora de sequencia (perdidos %u)\n", i, got[i].size(), elements, receivers[i].lost);
+      ok = false;
+    }
+    lost += receivers[i].lost;
+    recovered += receivers[i].recovered;
+  }
+  if (lost > 0) ok = false;
+
+  size_t total = sentData + sentHeartbeat + sentNack + sentRepair;
+  printf("%u ouvintes, perda %.1f%% por pacote e por ouvinte, %u elementos\n", listeners, loss * 100, elements);
+  printf("%zu pacotes: %zu DATA, %zu HEARTBEAT, %zu NACK, %zu REPAIR\n", total, sentData, sentHeartbeat, sentNack, sentRepair);
+  printf("%.2f pacotes por elemento (TCP: %u), %u recuperados por reparo, %u perdidos, %u/%u ouvintes completos\n",
+         (double)total / elements, listeners, recovered, lost, complete, listeners);
+  printf("%zu elementos anteriores ao primeiro pacote ouvido (não pedidos, como quem entra depois)\n", beforeSync);
+  printf("%s\n", ok ? "OK" : "FALHOU");
+  return ok ? 0 : 1;
+}
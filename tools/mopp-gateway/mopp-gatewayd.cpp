@@ -0,0 +1,334 @@
+// Host gateway between a morse-transceiver unit (TCP port 5000, "duration:<ms>"
+// lines) and MOPP (Morse over Packet, UDP port 7373) used by other CW-over-IP tools.
+// Uses the same MOPP codec (mopp.cpp) and Morse table (morse-table.cpp) as the
+// firmware; all buffers are fixed, nothing is allocated after startup.
+//
+// Build (from this folder):
+//   g++ -O2 -I../../morse-transceiver ../../morse-transceiver/mopp.cpp ../../morse-transceiver/morse-table.cpp mopp-gatewayd.cpp -o mopp-gatewayd
+//
+// Gateway:  ./mopp-gatewayd --unit 192.168.4.1 --peer 127.0.0.1 [--peer-port 7373] [--listen 7373]
+// Stand-in: ./mopp-gatewayd --standin [--listen 7373]
+//   The stand-in is a local MOPP endpoint for tests: it prints every packet it
+//   receives as text and echoes it back to the sender.
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+#include "mopp.h"
+#include "morse-table.h"
+
+// Mesmos limiares do firmware (cw-transceiver.h)
+static const unsigned long SHORT_PRESS = 150;
+static const unsigned long LETTER_GAP = 800;
+static const unsigned long DEBOUNCE_TIME = 25;
+static const unsigned long HEARTBEAT_INTERVAL = 1000;
+static const unsigned long RECONNECT_DELAY = 2000;
+static const unsigned long CONNECT_TIMEOUT = 5000;
+static const int QUEUE_SIZE = 256;
+
+struct Element {
+  unsigned long duration;
+  unsigned long gapAfter;
+};
+
+static unsigned long nowMs() {
+  timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (unsigned long)ts.tv_sec * 1000UL + ts.tv_nsec / 1000000UL;
+}
+
+static int openUdp(unsigned short port) {
+  int fd = socket(AF_INET, SOCK_DGRAM, 0);
+  if (fd < 0) return -1;
+  int one = 1;
+  setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+  sockaddr_in addr = {};
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = htonl(INADDR_ANY);
+  addr.sin_port = htons(port);
+  if (bind(fd, (sockaddr*)&addr, sizeof(addr)) < 0) {
+    close(fd);
+    return -1;
+  }
+  fcntl(fd, F_SETFL, O_NONBLOCK);
+  return fd;
+}
+
+// Converte os símbolos de um pacote MOPP em texto (para log e para o stand-in)
+static void packetToText(const uint8_t* data, size_t length, char* text, size_t size) {
+  size_t out = 0;
+  uint8_t code = 1;
+  size_t symbols = moppSymbolCount(length);
+  for (size_t i = 0; i < symbols && out + 2 < size; i++) {
+    MoppSymbol symbol = moppSymbolAt(data, i);
+    if (symbol == MOPP_DIT || symbol == MOPP_DAH) {
+      if (code < 64) code = (code << 1) | (symbol == MOPP_DAH ? 1 : 0);
+    } else {
+      if (code > 1) {
+        char c = decodeMorse(code);
+        text[out++] = c ? c : '*';
+      }
+      code = 1;
+      if (symbol == MOPP_EOW && out > 0 && text[out - 1] != ' ') text[out++] = ' ';
+    }
+  }
+  text[out] = '\0';
+}
+
+static int runStandIn(unsigned short listenPort) {
+  int udp = openUdp(listenPort);
+  if (udp < 0) {
+    perror("udp");
+    return 1;
+  }
+  printf("stand-in MOPP na porta UDP %u\n", listenPort);
+  fflush(stdout);
+  uint8_t packet[MOPP_MAX_PACKET];
+  for (;;) {
+    pollfd pfd = { udp, POLLIN, 0 };
+    if (poll(&pfd, 1, -1) < 0 && errno != EINTR) return 1;
+    sockaddr_in from = {};
+    socklen_t fromLength = sizeof(from);
+    ssize_t length = recvfrom(udp, packet, sizeof(packet), 0, (sockaddr*)&from, &fromLength);
+    uint8_t serial = 0, wpm = 0;
+    if (length <= 0 || !moppParseHeader(packet, length, &serial, &wpm)) continue;
+    char text[MOPP_MAX_PACKET * 4];
+    packetToText(packet, length, text, sizeof(text));
+    printf("%lu MOPP de %s:%u serial %u %u wpm: \"%s\"\n", nowMs(), inet_ntoa(from.sin_addr), ntohs(from.sin_port), serial, wpm, text);
+    fflush(stdout);
+    sendto(udp, packet, length, 0, (sockaddr*)&from, fromLength);
+  }
+}
+
+struct Gateway {
+  sockaddr_in unit;
+  sockaddr_in peer;
+  int tcp = -1;
+  bool connecting = false;  // connect() em andamento: espera POLLOUT, nada é enviado ainda
+  int udp = -1;
+  char line[128];
+  size_t lineLength = 0;
+  MoppWriter writer;
+  uint8_t serial = 0;
+  uint8_t wpm = 20;
+  unsigned long lastElement = 0;
+  unsigned long lastHeartbeat = 0;
+  unsigned long lastConnectAttempt = 0;
+  Element queue[QUEUE_SIZE];
+  int queueHead = 0;
+  int queueCount = 0;
+  unsigned long nextDispatch = 0;
+};
+
+static void dropUnit(Gateway& gw) {
+  close(gw.tcp);
+  gw.tcp = -1;
+  gw.connecting = false;
+}
+
+static void sendTcp(Gateway& gw, const char* text) {
+  if (gw.tcp < 0 || gw.connecting) return;
+  size_t length = strlen(text);
+  if (send(gw.tcp, text, length, MSG_NOSIGNAL) != (ssize_t)length) dropUnit(gw);
+}
+
+static void connected(Gateway& gw, unsigned long now) {
+  int one = 1;
+  setsockopt(gw.tcp, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+  gw.connecting = false;
+  gw.lineLength = 0;
+  printf("%lu conectado a unidade %s:%u\n", now, inet_ntoa(gw.unit.sin_addr), ntohs(gw.unit.sin_port));
+  fflush(stdout);
+}
+
+// Não bloqueia: com a unidade fora do ar, o lado MOPP continua sendo atendido durante o handshake
+static void connectUnit(Gateway& gw, unsigned long now) {
+  gw.lastConnectAttempt = now;
+  int fd = socket(AF_INET, SOCK_STREAM, 0);
+  if (fd < 0) return;
+  fcntl(fd, F_SETFL, O_NONBLOCK);
+  gw.tcp = fd;
+  if (connect(fd, (sockaddr*)&gw.unit, sizeof(gw.unit)) == 0) connected(gw, now);
+  else if (errno == EINPROGRESS) gw.connecting = true;
+  else dropUnit(gw);
+}
+
+// POLLOUT no socket em andamento: SO_ERROR diz se o connect() terminou bem
+static void finishConnect(Gateway& gw, unsigned long now) {
+  int error = 0;
+  socklen_t length = sizeof(error);
+  if (getsockopt(gw.tcp, SOL_SOCKET, SO_ERROR, &error, &length) < 0 || error != 0) dropUnit(gw);
+  else connected(gw, now);
+}
+
+static void flushPacket(Gateway& gw) {
+  if (gw.writer.bits == 0) return;
+  moppPut(gw.writer, MOPP_EOC);
+  sendto(gw.udp, gw.writer.data, moppLength(gw.writer), 0, (sockaddr*)&gw.peer, sizeof(gw.peer));
+  gw.serial = (gw.serial + 1) & 0x3F;
+  gw.writer.bits = 0;
+}
+
+// Linha da porta 5000 -> símbolo MOPP
+static void handleLine(Gateway& gw, const char* line, unsigned long now) {
+  if (strncmp(line, "duration:", 9) == 0) {
+    unsigned long duration = strtoul(line + 9, nullptr, 10);
+    if (duration < DEBOUNCE_TIME) return;
+    if (gw.writer.bits == 0) moppBegin(gw.writer, gw.serial, gw.wpm);
+    MoppSymbol symbol = duration <= SHORT_PRESS ? MOPP_DIT : MOPP_DAH;
+    if (!moppPut(gw.writer, symbol)) {
+      // Pacote cheio: envia o que tem e o elemento abre o próximo
+      flushPacket(gw);
+      moppBegin(gw.writer, gw.serial, gw.wpm);
+      moppPut(gw.writer, symbol);
+    }
+    if (duration <= SHORT_PRESS) {
+      unsigned long measured = 1200 / duration;
+      if (measured < 5) measured = 5;
+      if (measured > 60) measured = 60;
+      gw.wpm = (gw.wpm * 3 + measured) / 4;
+    }
+    gw.lastElement = now;
+  } else if (strncmp(line, "ping:", 5) == 0) {
+    char pong[32];
+    snprintf(pong, sizeof(pong), "pong:%s\n", line + 5);
+    sendTcp(gw, pong);
+  }
+}
+
+// Pacote MOPP -> elementos agendados para a porta 5000
+static void handlePacket(Gateway& gw, const uint8_t* packet, size_t length) {
+  uint8_t serial = 0, speed = 0;
+  if (!moppParseHeader(packet, length, &serial, &speed)) return;
+  if (speed < 5) speed = 20;
+  unsigned long dit = 1200 / speed;
+  unsigned long dot = dit < DEBOUNCE_TIME + 5 ? DEBOUNCE_TIME + 5 : (dit > SHORT_PRESS ? SHORT_PRESS : dit);
+  unsigned long dash = 3 * dit > SHORT_PRESS ? 3 * dit : SHORT_PRESS + 1;
+  size_t symbols = moppSymbolCount(length);
+  for (size_t i = 0; i < symbols; i++) {
+    MoppSymbol symbol = moppSymbolAt(packet, i);
+    if ((symbol == MOPP_DIT || symbol == MOPP_DAH) && gw.queueCount < QUEUE_SIZE) {
+      Element& e = gw.queue[(gw.queueHead + gw.queueCount++) % QUEUE_SIZE];
+      e.duration = (symbol == MOPP_DIT) ? dot : dash;
+      e.gapAfter = dit;
+    } else if (gw.queueCount > 0) {
+      Element& last = gw.queue[(gw.queueHead + gw.queueCount - 1) % QUEUE_SIZE];
+      unsigned long pause = (symbol == MOPP_EOW) ? LETTER_GAP * 2 : LETTER_GAP + 100;
+      if (last.gapAfter < pause) last.gapAfter = pause;
+    }
+  }
+}
+
+static int runGateway(Gateway& gw) {
+  for (;;) {
+    unsigned long now = nowMs();
+    if (gw.tcp < 0 && now - gw.lastConnectAttempt >= RECONNECT_DELAY) connectUnit(gw, now);
+    if (gw.connecting && now - gw.lastConnectAttempt >= CONNECT_TIMEOUT) dropUnit(gw);
+    pollfd pfds[2] = { { gw.udp, POLLIN, 0 }, { gw.tcp, (short)(gw.connecting ? POLLOUT : POLLIN), 0 } };
+    int count = gw.tcp >= 0 ? 2 : 1;
+    if (poll(pfds, count, 10) < 0 && errno != EINTR) return 1;
+    now = nowMs();
+    if (count == 2 && gw.connecting) {
+      if (pfds[1].revents & (POLLOUT | POLLHUP | POLLERR)) finishConnect(gw, now);
+      pfds[1].revents = 0;
+    }
+
+    if (pfds[0].revents & POLLIN) {
+      uint8_t packet[MOPP_MAX_PACKET];
+      ssize_t length;
+      while ((length = recv(gw.udp, packet, sizeof(packet), 0)) > 0) handlePacket(gw, packet, length);
+    }
+    if (count == 2 && (pfds[1].revents & (POLLIN | POLLHUP | POLLERR))) {
+      char buffer[512];
+      ssize_t length = recv(gw.tcp, buffer, sizeof(buffer), 0);
+      if (length == 0 || (length < 0 && errno != EAGAIN && errno != EWOULDBLOCK)) {
+        printf("%lu unidade desconectada\n", now);
+        fflush(stdout);
+        dropUnit(gw);
+      }
+      for (ssize_t i = 0; i < length; i++) {
+        char c = buffer[i];
+        if (c == '\n') {
+          while (gw.lineLength > 0 && gw.line[gw.lineLength - 1] == '\r') gw.lineLength--;
+          gw.line[gw.lineLength] = '\0';
+          handleLine(gw, gw.line, now);
+          gw.lineLength = 0;
+        } else if (gw.lineLength < sizeof(gw.line) - 1) {
+          gw.line[gw.lineLength++] = c;
+        }
+      }
+    }
+
+    // Fim de caractere: mesmo critério de gap do decodificador do firmware
+    if (gw.writer.bits != 0 && now - gw.lastElement >= LETTER_GAP) flushPacket(gw);
+    if (gw.tcp >= 0 && now - gw.lastHeartbeat >= HEARTBEAT_INTERVAL) {
+      sendTcp(gw, "alive\n");
+      gw.lastHeartbeat = now;
+    }
+    if (gw.queueCount > 0 && (long)(now - gw.nextDispatch) >= 0) {
+      Element e = gw.queue[gw.queueHead];
+      gw.queueHead = (gw.queueHead + 1) % QUEUE_SIZE;
+      gw.queueCount--;
+      char line[32];
+      snprintf(line, sizeof(line), "duration:%lu\n", e.duration);
+      sendTcp(gw, line);
+      gw.nextDispatch = now + e.duration + e.gapAfter;
+    }
+  }
+}
+
+static bool parseAddress(const char* text, unsigned short port, sockaddr_in* addr) {
+  memset(addr, 0, sizeof(*addr));
+  addr->sin_family = AF_INET;
+  addr->sin_port = htons(port);
+  return inet_aton(text, &addr->sin_addr) != 0;
+}
+
+int main(int argc, char** argv) {
+  const char* unit = nullptr;
+  const char* peer = nullptr;
+  unsigned short peerPort = MOPP_PORT;
+  unsigned short listenPort = MOPP_PORT;
+  unsigned short unitPort = 5000;
+  bool standIn = false;
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "--standin") == 0) standIn = true;
+    else if (strcmp(argv[i], "--unit") == 0 && i + 1 < argc) unit = argv[++i];
+    else if (strcmp(argv[i], "--unit-port") == 0 && i + 1 < argc) unitPort = atoi(argv[++i]);
+    else if (strcmp(argv[i], "--peer") == 0 && i + 1 < argc) peer = argv[++i];
+    else if (strcmp(argv[i], "--peer-port") == 0 && i + 1 < argc) peerPort = atoi(argv[++i]);
+    else if (strcmp(argv[i], "--listen") == 0 && i + 1 < argc) listenPort = atoi(argv[++i]);
+    else {
+      fprintf(stderr, "uso: %s --unit <ip> --peer <ip> [--unit-port 5000] [--peer-port 7373] [--listen 7373]\n"
+                      "     %s --standin [--listen 7373]\n", argv[0], argv[0]);
+      return 2;
+    }
+  }
+  signal(SIGPIPE, SIG_IGN);
+  if (standIn) return runStandIn(listenPort);
+
+  static Gateway gw;
+  if (unit == nullptr || peer == nullptr || !parseAddress(unit, unitPort, &gw.unit) || !parseAddress(peer, peerPort, &gw.peer)) {
+    fprintf(stderr, "--unit e --peer devem ser enderecos IPv4\n");
+    return 2;
+  }
+  gw.udp = openUdp(listenPort);
+  if (gw.udp < 0) {
+    perror("udp");
+    return 1;
+  }
+  gw.writer.bits = 0;
+  printf("gateway: unidade %s:%u <-> MOPP %s:%u (escutando UDP %u)\n", unit, unitPort, peer, peerPort, listenPort);
+  fflush(stdout);
+  return runGateway(gw);
+}
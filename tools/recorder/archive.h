@@ -0,0 +1,81 @@
+#ifndef ARCHIVE_H
+#define ARCHIVE_H
+
+// Formato do arquivo de sessões gravado por morse-recorderd e lido por morse-index.
+// Só para o PC (layout nativo little-endian).
+
+#include <stdint.h>
+#include <stddef.h>
+
+// REC_HLC segue o REC_ELEMENT da mesma estação (delta 0) quando a linha trazia "@l.c.node":
+// value = hlcPack() do carimbo do remetente, igual no gravado pela unidade e pelo peer
+enum RecordType : uint8_t { REC_OPEN = 1, REC_CLOSE = 2, REC_ELEMENT = 3, REC_HLC = 4 };
+
+struct BlockHeader {
+  char magic[4];      // "MRB1"
+  uint32_t length;    // Bytes de registros após o cabeçalho
+  uint32_t count;
+  uint32_t crc;       // CRC-32 dos registros
+  uint64_t firstUs;   // Tempo (µs desde a época) do primeiro registro: base fixa dos deltas
+  uint64_t lastUs;    // Do último registro gravado (o relógio de parede pode ter voltado no meio)
+  uint64_t stations;  // Bit (id % 64) de cada estação presente
+};
+
+struct IndexEntry {
+  uint64_t offset;    // Do BlockHeader em events.blk
+  uint64_t minUs;     // Faixa de tempo dos registros do bloco (filtro das consultas)
+  uint64_t maxUs;
+  uint64_t stations;
+  uint32_t count;
+  uint32_t length;
+};
+
+static_assert(sizeof(BlockHeader) == 40, "layout do bloco");
+static_assert(sizeof(IndexEntry) == 40, "layout do índice");
+
+static inline uint32_t crc32(const uint8_t* data, size_t length) {
+  static uint32_t table[256];
+  if (table[1] == 0) {
+    for (uint32_t i = 0; i < 256; i++) {
+      uint32_t c = i;
+      for (int k = 0; k < 8; k++) c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+      table[i] = c;
+    }
+  }
+  uint32_t crc = 0xFFFFFFFFu;
+  for (size_t i = 0; i < length; i++) crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+  return crc ^ 0xFFFFFFFFu;
+}
+
+static inline size_t putVarint(uint8_t* out, uint64_t value) {
+  size_t n = 0;
+  while (value >= 0x80) {
+    out[n++] = (uint8_t)(value | 0x80);
+    value >>= 7;
+  }
+  out[n++] = (uint8_t)value;
+  return n;
+}
+
+static inline bool getVarint(const uint8_t* data, size_t length, size_t& pos, uint64_t& value) {
+  value = 0;
+  for (int shift = 0; shift < 64 && pos < length; shift += 7) {
+    uint8_t b = data[pos++];
+    value |= (uint64_t)(b & 0x7F) << shift;
+    if (!(b & 0x80)) return true;
+  }
+  return false;
+}
+
+// Próximo registro de um bloco; atUs acumula os deltas a partir de BlockHeader.firstUs
+static inline bool nextRecord(const uint8_t* data, size_t length, size_t& pos, uint64_t& atUs,
+                              uint64_t& station, uint8_t& type, uint64_t& value) {
+  uint64_t zigzag;
+  if (!getVarint(data, length, pos, zigzag) || !getVarint(data, length, pos, station) || pos >= length) return false;
+  type = data[pos++];
+  if (!getVarint(data, length, pos, value)) return false;
+  atUs += (uint64_t)((int64_t)(zigzag >> 1) ^ -(int64_t)(zigzag & 1));
+  return true;
+}
+
+#endif
@@ -0,0 +1,651 @@
+// Host recorder: joins units on port 5000 as a passive observer ("listen"), timestamps
+// every element and appends it to a block archive indexed by time and station. One
+// epoll loop drives every session; buffers are fixed, nothing is allocated per event.
+//
+// Build (from this folder):
+//   g++ -O2 -I../../morse-transceiver morse-recorderd.cpp ../../morse-transceiver/hlc.cpp -o morse-recorderd
+//
+// Record: ./morse-recorderd --archive <dir> --unit 192.168.4.1 [--unit ip[:port] ...] [--units <file>]
+//   <file>: one ip[:port] per line, for many classrooms at once
+// Query:  ./morse-recorderd --archive <dir> --query [--from t] [--to t] [--station <name>] [--hlc]
+//   t = epoch seconds or UTC "YYYY-MM-DDTHH:MM:SS"; <name> = unit MAC, or MAC + "/peer"
+//   for what the unit received from its peer
+//   --hlc: one transcript in hybrid-logical-clock order (the order every unit's log uses);
+//   an element recorded by both ends of a link carries the same stamp and is printed once;
+//   sessions (one per connection, merged across a link) go in wall-clock order
+//
+// Archive (in <dir>):
+//   stations.txt  station names, id = line number (0-based)
+//   events.blk    blocks: BlockHeader + records (zigzag delta µs, station, type, value as varints)
+//   events.idx    one IndexEntry per block (offset, time range, station bitmap); a query
+//                 reads only the blocks whose range and bitmap match
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <signal.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+#include <algorithm>
+#include <unordered_map>
+#include <vector>
+#include "archive.h"
+#include "hlc.h"
+
+static const unsigned long RECONNECT_DELAY = 2000;
+static const unsigned long RX_TIMEOUT = 3000;        // Unidade manda "alive" a cada 1 s ao observador
+static const unsigned long TIMER_SCAN = 100;         // Varredura de timeouts/reconexões
+static const unsigned long BLOCK_AGE = 5000;         // Bloco aberto vai ao disco no máximo após isto
+static const uint32_t BLOCK_EVENTS = 4096;
+static const size_t BLOCK_BYTES = 32768;             // Fecha o bloco ao passar deste tamanho
+static const size_t MAX_RECORD = 24;                 // 3 varints + tipo
+static const int MAX_STATIONS = 4096;
+static const int STATION_NAME = 32;
+static const int MAX_SESSIONS = 1024;
+static const int EPOLL_BATCH = 64;
+
+enum SessionState { SESSION_IDLE, SESSION_CONNECTING, SESSION_LISTENING };
+
+struct Session {
+  sockaddr_in unit;
+  char name[24];            // ip:port, estação até a unidade mandar "mac:"
+  int fd = -1;
+  SessionState state = SESSION_IDLE;
+  char line[64];
+  size_t lineLength = 0;
+  int station = -1;
+  int peerStation = -1;
+  unsigned long lastRx = 0;
+  unsigned long retryAt = 0;
+};
+
+struct Archive {
+  int blk = -1;
+  int idx = -1;
+  FILE* stationsFile = nullptr;
+  char stations[MAX_STATIONS][STATION_NAME];
+  int stationCount = 0;
+  uint8_t block[BLOCK_BYTES + MAX_RECORD];
+  BlockHeader header;
+  uint64_t previousUs = 0;
+  uint64_t minUs = 0;          // Faixa do bloco aberto, só para o IndexEntry
+  uint64_t maxUs = 0;
+  uint64_t blkSize = 0;
+  unsigned long openedAt = 0;  // nowMs() do primeiro registro do bloco aberto
+  uint64_t events = 0;
+  uint64_t blocks = 0;
+};
+
+static volatile sig_atomic_t stopRequested = 0;
+
+static unsigned long nowMs() {
+  timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (unsigned long)ts.tv_sec * 1000UL + ts.tv_nsec / 1000000UL;
+}
+
+static uint64_t wallUs() {
+  timespec ts;
+  clock_gettime(CLOCK_REALTIME, &ts);
+  return (uint64_t)ts.tv_sec * 1000000ULL + ts.tv_nsec / 1000;
+}
+
+// --- Arquivo ---
+
+static bool writeAll(int fd, const void* data, size_t length) {
+  const uint8_t* p = static_cast<const uint8_t*>(data);
+  while (length > 0) {
+    ssize_t n = write(fd, p, length);
+    if (n < 0 && errno == EINTR) continue;
+    if (n <= 0) return false;
+    p += n;
+    length -= n;
+  }
+  return true;
+}
+
+static int findStation(Archive& archive, const char* name) {
+  for (int i = 0; i < archive.stationCount; i++) {
+    if (strcmp(archive.stations[i], name) == 0) return i;
+  }
+  return -1;
+}
+
+static int stationId(Archive& archive, const char* name) {
+  int id = findStation(archive, name);
+  if (id >= 0 || archive.stationCount >= MAX_STATIONS) return id;
+  id = archive.stationCount++;
+  snprintf(archive.stations[id], STATION_NAME, "%s", name);
+  fprintf(archive.stationsFile, "%s\n", archive.stations[id]);
+  fflush(archive.stationsFile);
+  return id;
+}
+
+// Abre o arquivo; um bloco sem entrada no índice (queda no meio da escrita) é descartado
+static bool openArchive(Archive& archive, const char* dir, bool writable) {
+  char path[512];
+  if (writable) mkdir(dir, 0755);
+  snprintf(path, sizeof(path), "%s/stations.txt", dir);
+  archive.stationsFile = fopen(path, writable ? "a+" : "r");
+  if (archive.stationsFile == nullptr) return false;
+  rewind(archive.stationsFile);
+  char line[128];
+  while (archive.stationCount < MAX_STATIONS && fgets(line, sizeof(line), archive.stationsFile)) {
+    line[strcspn(line, "\r\n")] = '\0';
+    snprintf(archive.stations[archive.stationCount++], STATION_NAME, "%.31s", line);
+  }
+  int flags = writable ? O_RDWR | O_CREAT : O_RDONLY;
+  snprintf(path, sizeof(path), "%s/events.blk", dir);
+  archive.blk = open(path, flags, 0644);
+  snprintf(path, sizeof(path), "%s/events.idx", dir);
+  archive.idx = open(path, flags, 0644);
+  if (archive.blk < 0 || archive.idx < 0) return false;
+  if (!writable) return true;
+
+  off_t idxSize = lseek(archive.idx, 0, SEEK_END);
+  idxSize -= idxSize % sizeof(IndexEntry);
+  archive.blkSize = 0;
+  if (idxSize > 0) {
+    IndexEntry last;
+    if (pread(archive.idx, &last, sizeof(last), idxSize - sizeof(last)) == (ssize_t)sizeof(last)) {
+      archive.blkSize = last.offset + sizeof(BlockHeader) + last.length;
+    }
+  }
+  if (ftruncate(archive.idx, idxSize) != 0 || ftruncate(archive.blk, archive.blkSize) != 0) return false;
+  lseek(archive.idx, 0, SEEK_END);
+  lseek(archive.blk, 0, SEEK_END);
+  archive.blocks = idxSize / sizeof(IndexEntry);
+  return true;
+}
+
+// Bloco primeiro, índice depois: uma entrada no índice sempre aponta para um bloco completo
+static void flushBlock(Archive& archive) {
+  BlockHeader& h = archive.header;
+  if (h.count == 0) return;
+  memcpy(h.magic, "MRB1", 4);
+  h.crc = crc32(archive.block, h.length);
+  IndexEntry entry = { archive.blkSize, archive.minUs, archive.maxUs, h.stations, h.count, h.length };
+  if (!writeAll(archive.blk, &h, sizeof(h)) || !writeAll(archive.blk, archive.block, h.length) ||
+      !writeAll(archive.idx, &entry, sizeof(entry))) {
+    perror("gravando bloco");
+    exit(1);
+  }
+  archive.blkSize += sizeof(h) + h.length;
+  archive.blocks++;
+  memset(&h, 0, sizeof(h));
+}
+
+static void appendRecord(Archive& archive, uint64_t atUs, int station, RecordType type, uint64_t value) {
+  if (station < 0) return;
+  BlockHeader& h = archive.header;
+  if (h.count == 0) {
+    h.firstUs = atUs;
+    archive.previousUs = atUs;
+    archive.minUs = archive.maxUs = atUs;
+    archive.openedAt = nowMs();
+  }
+  int64_t delta = (int64_t)(atUs - archive.previousUs);  // Relógio de parede pode voltar: zigzag
+  uint8_t* out = archive.block + h.length;
+  size_t n = putVarint(out, ((uint64_t)delta << 1) ^ (uint64_t)(delta >> 63));
+  n += putVarint(out + n, (uint64_t)station);
+  out[n++] = type;
+  n += putVarint(out + n, value);
+  h.length += n;
+  h.count++;
+  h.lastUs = atUs;
+  if (atUs < archive.minUs) archive.minUs = atUs;
+  if (atUs > archive.maxUs) archive.maxUs = atUs;
+  h.stations |= 1ULL << (station % 64);
+  archive.previousUs = atUs;
+  archive.events++;
+  if (h.count >= BLOCK_EVENTS || h.length >= BLOCK_BYTES) flushBlock(archive);
+}
+
+// --- Sessões ---
+
+static void closeSession(Archive& archive, Session& s, int epoll, unsigned long now, const char* why) {
+  if (s.fd < 0) return;
+  epoll_ctl(epoll, EPOLL_CTL_DEL, s.fd, nullptr);
+  close(s.fd);
+  s.fd = -1;
+  if (s.state == SESSION_LISTENING) {
+    appendRecord(archive, wallUs(), s.station, REC_CLOSE, 0);
+    printf("%lu %s: sessao encerrada (%s)\n", now, s.name, why);
+    fflush(stdout);
+  }
+  s.state = SESSION_IDLE;
+  s.retryAt = now + RECONNECT_DELAY;
+}
+
+static void startConnect(Session& s, int epoll, unsigned long now) {
+  s.retryAt = now + RECONNECT_DELAY;
+  int fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK, 0);
+  if (fd < 0) return;
+  int one = 1;
+  setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+  if (connect(fd, (sockaddr*)&s.unit, sizeof(s.unit)) < 0 && errno != EINPROGRESS) {
+    close(fd);
+    return;
+  }
+  epoll_event ev = {};
+  ev.events = EPOLLOUT;
+  ev.data.ptr = &s;
+  if (epoll_ctl(epoll, EPOLL_CTL_ADD, fd, &ev) < 0) {
+    close(fd);
+    return;
+  }
+  s.fd = fd;
+  s.state = SESSION_CONNECTING;
+  s.lastRx = now;
+}
+
+// Conectou: anuncia "listen" (observador, não peer) e passa a só ler
+static void finishConnect(Archive& archive, Session& s, int epoll, unsigned long now) {
+  int error = 0;
+  socklen_t length = sizeof(error);
+  getsockopt(s.fd, SOL_SOCKET, SO_ERROR, &error, &length);
+  if (error != 0 || send(s.fd, "listen\n", 7, MSG_NOSIGNAL) != 7) {
+    closeSession(archive, s, epoll, now, "falha na conexao");
+    return;
+  }
+  epoll_event ev = {};
+  ev.events = EPOLLIN | EPOLLRDHUP;
+  ev.data.ptr = &s;
+  epoll_ctl(epoll, EPOLL_CTL_MOD, s.fd, &ev);
+  s.state = SESSION_LISTENING;
+  s.lineLength = 0;
+  s.lastRx = now;
+  if (s.station < 0) s.station = stationId(archive, s.name);
+  appendRecord(archive, wallUs(), s.station, REC_OPEN, 0);
+  printf("%lu %s: observando\n", now, s.name);
+  fflush(stdout);
+}
+
+// Sufixo "@l.c.node" (firmware com transcrição HLC); unidades antigas não mandam
+static void appendStamp(Archive& archive, uint64_t atUs, int station, const char* line) {
+  Hlc stamp;
+  if (hlcParse(line, stamp)) appendRecord(archive, atUs, station, REC_HLC, hlcPack(stamp));
+}
+
+static void handleLine(Archive& archive, Session& s, const char* line, uint64_t atUs) {
+  if (strncmp(line, "mac:", 4) == 0) {
+    char peer[STATION_NAME];
+    snprintf(peer, sizeof(peer), "%.24s/peer", line + 4);
+    int station = stationId(archive, line + 4);
+    // Primeira conexão abriu a sessão com ip:porta; reabre sob o MAC para agrupar por estação
+    if (station != s.station) appendRecord(archive, atUs, station, REC_OPEN, 0);
+    s.station = station;
+    s.peerStation = stationId(archive, peer);
+  } else if (strncmp(line, "duration:", 9) == 0) {
+    appendRecord(archive, atUs, s.station, REC_ELEMENT, strtoul(line + 9, nullptr, 10));
+    appendStamp(archive, atUs, s.station, line);
+  } else if (strncmp(line, "peer:duration:", 14) == 0) {
+    if (s.peerStation < 0) {
+      char peer[STATION_NAME];
+      snprintf(peer, sizeof(peer), "%.24s/peer", s.name);
+      s.peerStation = stationId(archive, peer);
+    }
+    appendRecord(archive, atUs, s.peerStation, REC_ELEMENT, strtoul(line + 14, nullptr, 10));
+    appendStamp(archive, atUs, s.peerStation, line);
+  }
+  // "alive", "catchup:", "ping:" etc.: só renovam lastRx
+}
+
+static void readSession(Archive& archive, Session& s, int epoll, unsigned long now) {
+  char buffer[1024];
+  for (;;) {
+    ssize_t length = recv(s.fd, buffer, sizeof(buffer), 0);
+    if (length < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) return;
+    if (length < 0 && errno == EINTR) continue;
+    if (length <= 0) {
+      closeSession(archive, s, epoll, now, length == 0 ? "unidade fechou" : strerror(errno));
+      return;
+    }
+    uint64_t atUs = wallUs();  // Linhas do mesmo recv compartilham o instante de chegada
+    s.lastRx = now;
+    for (ssize_t i = 0; i < length; i++) {
+      char c = buffer[i];
+      if (c == '\n') {
+        while (s.lineLength > 0 && s.line[s.lineLength - 1] == '\r') s.lineLength--;
+        s.line[s.lineLength] = '\0';
+        handleLine(archive, s, s.line, atUs);
+        s.lineLength = 0;
+      } else if (s.lineLength < sizeof(s.line) - 1) {
+        s.line[s.lineLength++] = c;
+      }
+    }
+  }
+}
+
+static int runRecorder(Archive& archive, Session* sessions, int count) {
+  int epoll = epoll_create1(0);
+  if (epoll < 0) {
+    perror("epoll");
+    return 1;
+  }
+  static epoll_event events[EPOLL_BATCH];
+  unsigned long lastScan = 0;
+  while (!stopRequested) {
+    int n = epoll_wait(epoll, events, EPOLL_BATCH, TIMER_SCAN);
+    if (n < 0 && errno != EINTR) return 1;
+    unsigned long now = nowMs();
+    for (int i = 0; i < n; i++) {
+      Session& s = *static_cast<Session*>(events[i].data.ptr);
+      if (s.state == SESSION_CONNECTING) {
+        if (events[i].events & (EPOLLOUT | EPOLLERR | EPOLLHUP)) finishConnect(archive, s, epoll, now);
+      } else if (s.state == SESSION_LISTENING) {
+        readSession(archive, s, epoll, now);
+      }
+    }
+    // Timeouts e reconexões: varredura O(sessões) no máximo a cada TIMER_SCAN
+    if (now - lastScan >= TIMER_SCAN) {
+      lastScan = now;
+      for (int i = 0; i < count; i++) {
+        Session& s = sessions[i];
+        if (s.state == SESSION_IDLE && (long)(now - s.retryAt) >= 0) startConnect(s, epoll, now);
+        else if (s.state != SESSION_IDLE && now - s.lastRx > RX_TIMEOUT) closeSession(archive, s, epoll, now, "timeout");
+      }
+      if (archive.header.count > 0 && now - archive.openedAt >= BLOCK_AGE) flushBlock(archive);
+    }
+  }
+  unsigned long now = nowMs();
+  for (int i = 0; i < count; i++) closeSession(archive, sessions[i], epoll, now, "parando");
+  flushBlock(archive);
+  printf("%lu gravados %llu eventos nesta execucao; arquivo com %llu blocos\n", now,
+         (unsigned long long)archive.events, (unsigned long long)archive.blocks);
+  return 0;
+}
+
+// --- Consulta ---
+
+static const char* recordName(uint8_t type) {
+  switch (type) {
+    case REC_OPEN: return "open";
+    case REC_CLOSE: return "close";
+    case REC_ELEMENT: return "duration";
+    case REC_HLC: return "hlc";
+    default: return "?";
+  }
+}
+
+static void formatUtc(uint64_t atUs, char* out, size_t size) {
+  time_t seconds = (time_t)(atUs / 1000000);
+  tm utc;
+  gmtime_r(&seconds, &utc);
+  char whole[24];
+  strftime(whole, sizeof(whole), "%Y-%m-%dT%H:%M:%S", &utc);
+  snprintf(out, size, "%s.%06uZ", whole, (unsigned)(atUs % 1000000));
+}
+
+static const char* nameOf(const Archive& archive, uint64_t id) {
+  return id < (uint64_t)archive.stationCount ? archive.stations[id] : "?";
+}
+
+// Elemento carimbado, para a transcrição em ordem HLC
+struct StampedElement {
+  uint64_t stamp;      // hlcPack()
+  uint64_t atUs;       // Primeira gravação
+  uint64_t sessionUs;  // Abertura (hora de parede) do domínio HLC; preenchido depois de juntar as sessões
+  uint32_t session;
+  uint32_t station;
+  uint32_t duration;
+  uint32_t copies;     // Gravações com o mesmo carimbo (a unidade e o peer dela)
+};
+
+// O l do HLC segue o millis() da unidade e recomeça quando ela reinicia: carimbos só se
+// comparam dentro de um domínio. Cada conexão do gravador a uma unidade abre uma sessão;
+// sessões que gravaram o mesmo carimbo (as duas pontas de um enlace) são um domínio só.
+struct HlcSessions {
+  std::vector<uint64_t> startUs;
+  std::vector<uint32_t> parent;
+
+  uint32_t open(uint64_t atUs) {
+    startUs.push_back(atUs);
+    parent.push_back((uint32_t)parent.size());
+    return (uint32_t)parent.size() - 1;
+  }
+
+  uint32_t root(uint32_t s) {
+    while (parent[s] != s) s = parent[s] = parent[parent[s]];
+    return s;
+  }
+
+  void join(uint32_t a, uint32_t b) {
+    a = root(a);
+    b = root(b);
+    if (a == b) return;
+    if (startUs[b] < startUs[a]) std::swap(a, b);
+    parent[b] = a;  // O domínio começa na sessão mais antiga
+  }
+};
+
+static const uint64_t SAME_STAMP_WINDOW_US = 60000000ULL;  // Mesmo carimbo mais longe que isso: coincidência após reinício
+
+static void joinSessions(HlcSessions& sessions, std::vector<StampedElement>& elements) {
+  std::unordered_map<uint64_t, size_t> lastByStamp;
+  for (size_t i = 0; i < elements.size(); i++) {
+    auto seen = lastByStamp.find(elements[i].stamp);
+    if (seen != lastByStamp.end()) {
+      const StampedElement& other = elements[seen->second];
+      uint64_t apart = elements[i].atUs > other.atUs ? elements[i].atUs - other.atUs : other.atUs - elements[i].atUs;
+      if (apart < SAME_STAMP_WINDOW_US) sessions.join(elements[i].session, other.session);
+    }
+    lastByStamp[elements[i].stamp] = i;
+  }
+  for (StampedElement& e : elements) e.sessionUs = sessions.startUs[sessions.root(e.session)];
+}
+
+// Domínios pela hora de parede da abertura; hlcBefore() dentro de cada um
+static void printHlcTranscript(Archive& archive, std::vector<StampedElement>& elements, size_t unstamped) {
+  std::sort(elements.begin(), elements.end(), [](const StampedElement& a, const StampedElement& b) {
+    if (a.sessionUs != b.sessionUs) return a.sessionUs < b.sessionUs;
+    if (a.stamp != b.stamp) return hlcBefore(a.stamp, b.stamp);
+    return a.atUs < b.atUs;
+  });
+  size_t printed = 0;
+  for (size_t i = 0; i < elements.size();) {
+    StampedElement first = elements[i];
+    size_t j = i + 1;
+    for (; j < elements.size() && elements[j].sessionUs == first.sessionUs && elements[j].stamp == first.stamp; j++) {
+      if (strstr(nameOf(archive, first.station), "/peer") && !strstr(nameOf(archive, elements[j].station), "/peer")) {
+        first.station = elements[j].station;  // Mostra quem enviou, não quem recebeu
+      }
+    }
+    Hlc stamp = hlcUnpack(first.stamp);
+    char when[40];
+    formatUtc(first.atUs, when, sizeof(when));
+    printf("%lu.%u.%u %s %-24s duration %u copias %zu\n", (unsigned long)stamp.l, (unsigned)stamp.c, (unsigned)stamp.node,
+           when, nameOf(archive, first.station),
+           (unsigned)first.duration, j - i);
+    printed++;
+    i = j;
+  }
+  fprintf(stderr, "%zu elementos em ordem HLC; %zu sem carimbo (firmware antigo) omitidos\n", printed, unstamped);
+}
+
+static int runQuery(Archive& archive, uint64_t fromUs, uint64_t toUs, const char* stationName, bool byHlc) {
+  int station = -1;
+  if (stationName != nullptr) {
+    station = findStation(archive, stationName);
+    if (station < 0) {
+      fprintf(stderr, "estacao desconhecida: %s\n", stationName);
+      return 1;
+    }
+  }
+  uint64_t mask = station >= 0 ? 1ULL << (station % 64) : ~0ULL;
+  static uint8_t block[BLOCK_BYTES + MAX_RECORD];
+  IndexEntry entry;
+  size_t scanned = 0, read = 0, printed = 0, unstamped = 0;
+  std::vector<StampedElement> elements;
+  static StampedElement pending[MAX_STATIONS];  // REC_ELEMENT esperando o REC_HLC seguinte da estação
+  static int unitOf[MAX_STATIONS];              // "<MAC>/peer" pertence à sessão da unidade "<MAC>" que o gravou
+  static int sessionOf[MAX_STATIONS];           // Sessão aberta de cada unidade (-1: nenhuma ainda)
+  HlcSessions sessions;
+  for (int i = 0; byHlc && i < archive.stationCount; i++) {
+    char unit[STATION_NAME];
+    snprintf(unit, sizeof(unit), "%s", archive.stations[i]);
+    char* suffix = strstr(unit, "/peer");
+    if (suffix != nullptr) *suffix = '\0';
+    int id = findStation(archive, unit);
+    unitOf[i] = id >= 0 ? id : i;
+    sessionOf[i] = -1;
+  }
+  for (off_t at = 0; pread(archive.idx, &entry, sizeof(entry), at) == (ssize_t)sizeof(entry); at += sizeof(entry)) {
+    scanned++;
+    if (entry.maxUs < fromUs || entry.minUs > toUs || !(entry.stations & mask)) continue;
+    BlockHeader h;
+    if (entry.length > sizeof(block) || pread(archive.blk, &h, sizeof(h), entry.offset) != (ssize_t)sizeof(h) ||
+        pread(archive.blk, block, entry.length, entry.offset + sizeof(h)) != (ssize_t)entry.length ||
+        memcmp(h.magic, "MRB1", 4) != 0 || crc32(block, entry.length) != h.crc) {
+      fprintf(stderr, "bloco corrompido em %llu\n", (unsigned long long)entry.offset);
+      continue;
+    }
+    read++;
+    uint64_t atUs = h.firstUs;
+    size_t pos = 0;
+    for (uint32_t i = 0; i < h.count; i++) {
+      uint64_t id, value;
+      uint8_t type;
+      if (!nextRecord(block, h.length, pos, atUs, id, type, value)) break;
+      if (atUs < fromUs || atUs > toUs || (station >= 0 && (int)id != station)) continue;
+      if (byHlc) {
+        if (id >= (uint64_t)archive.stationCount) continue;
+        StampedElement& p = pending[id];
+        int& session = sessionOf[unitOf[id]];
+        if (type == REC_OPEN && unitOf[id] == (int)id) {
+          session = (int)sessions.open(atUs);
+        } else if (type == REC_ELEMENT) {
+          if (p.copies != 0) unstamped++;
+          if (session < 0) session = (int)sessions.open(atUs);  // Aberta antes de --from
+          p = { 0, atUs, 0, (uint32_t)session, (uint32_t)id, (uint32_t)value, 1 };
+        } else if (type == REC_HLC && p.copies != 0) {
+          p.stamp = value;
+          elements.push_back(p);
+          p.copies = 0;
+        }
+        continue;
+      }
+      char when[40];
+      formatUtc(atUs, when, sizeof(when));
+      printf("%s %-24s %s", when, nameOf(archive, id), recordName(type));
+      if (type == REC_ELEMENT) printf(" %llu", (unsigned long long)value);
+      if (type == REC_HLC) {
+        Hlc stamp = hlcUnpack(value);
+        printf(" %lu.%u.%u", (unsigned long)stamp.l, (unsigned)stamp.c, (unsigned)stamp.node);
+      }
+      printf("\n");
+      printed++;
+    }
+  }
+  if (byHlc) {
+    for (int i = 0; i < MAX_STATIONS; i++) unstamped += pending[i].copies;
+    joinSessions(sessions, elements);
+    printHlcTranscript(archive, elements, unstamped);
+  } else {
+    fprintf(stderr, "%zu eventos; %zu de %zu blocos lidos\n", printed, read, scanned);
+  }
+  return 0;
+}
+
+// Segundos desde a época (aceita fração) ou "YYYY-MM-DDTHH:MM:SS" em UTC
+static bool parseTime(const char* text, uint64_t* us) {
+  tm t = {};
+  if (strptime(text, "%Y-%m-%dT%H:%M:%S", &t) != nullptr) {
+    *us = (uint64_t)timegm(&t) * 1000000ULL;
+    return true;
+  }
+  char* end;
+  double seconds = strtod(text, &end);
+  if (end == text || *end != '\0' || seconds < 0) return false;
+  *us = (uint64_t)(seconds * 1e6);
+  return true;
+}
+
+static bool parseUnit(const char* text, Session& s) {
+  char host[64];
+  snprintf(host, sizeof(host), "%s", text);
+  unsigned short port = 5000;
+  char* colon = strchr(host, ':');
+  if (colon != nullptr) {
+    *colon = '\0';
+    port = atoi(colon + 1);
+  }
+  memset(&s.unit, 0, sizeof(s.unit));
+  s.unit.sin_family = AF_INET;
+  s.unit.sin_port = htons(port);
+  if (inet_aton(host, &s.unit.sin_addr) == 0) return false;
+  snprintf(s.name, sizeof(s.name), "%.15s:%u", host, port);
+  return true;
+}
+
+static void onSignal(int) {
+  stopRequested = 1;
+}
+
+int main(int argc, char** argv) {
+  const char* dir = nullptr;
+  const char* unitsFile = nullptr;
+  const char* station = nullptr;
+  bool query = false, byHlc = false;
+  uint64_t fromUs = 0, toUs = UINT64_MAX;
+  static Session sessions[MAX_SESSIONS];
+  int count = 0;
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "--archive") == 0 && i + 1 < argc) dir = argv[++i];
+    else if (strcmp(argv[i], "--unit") == 0 && i + 1 < argc && count < MAX_SESSIONS) {
+      if (!parseUnit(argv[++i], sessions[count++])) {
+        fprintf(stderr, "endereco invalido: %s\n", argv[i]);
+        return 2;
+      }
+    }
+    else if (strcmp(argv[i], "--units") == 0 && i + 1 < argc) unitsFile = argv[++i];
+    else if (strcmp(argv[i], "--query") == 0) query = true;
+    else if (strcmp(argv[i], "--from") == 0 && i + 1 < argc && parseTime(argv[i + 1], &fromUs)) i++;
+    else if (strcmp(argv[i], "--to") == 0 && i + 1 < argc && parseTime(argv[i + 1], &toUs)) i++;
+    else if (strcmp(argv[i], "--station") == 0 && i + 1 < argc) station = argv[++i];
+    else if (strcmp(argv[i], "--hlc") == 0) byHlc = true;
+    else {
+      fprintf(stderr, "uso: %s --archive <dir> --unit <ip[:porta]> [--unit ...] [--units <arquivo>]\n"
+                      "     %s --archive <dir> --query [--from t] [--to t] [--station <nome>] [--hlc]\n", argv[0], argv[0]);
+      return 2;
+    }
+  }
+  if (unitsFile != nullptr) {
+    FILE* f = fopen(unitsFile, "r");
+    if (f == nullptr) {
+      perror(unitsFile);
+      return 2;
+    }
+    char line[128];
+    while (count < MAX_SESSIONS && fgets(line, sizeof(line), f)) {
+      line[strcspn(line, "\r\n# ")] = '\0';
+      if (line[0] != '\0' && parseUnit(line, sessions[count])) count++;
+    }
+    fclose(f);
+  }
+  static Archive archive;
+  if (dir == nullptr || !openArchive(archive, dir, !query)) {
+    fprintf(stderr, "nao foi possivel abrir o arquivo em %s\n", dir ? dir : "(--archive ausente)");
+    return 1;
+  }
+  if (query) return runQuery(archive, fromUs, toUs, station, byHlc);
+  if (count == 0) {
+    fprintf(stderr, "nenhuma unidade (--unit/--units)\n");
+    return 2;
+  }
+  signal(SIGPIPE, SIG_IGN);
+  signal(SIGINT, onSignal);
+  signal(SIGTERM, onSignal);
+  printf("gravando %d sessoes em %s (%llu blocos existentes)\n", count, dir, (unsigned long long)archive.blocks);
+  fflush(stdout);
+  return runRecorder(archive, sessions, count);
+}
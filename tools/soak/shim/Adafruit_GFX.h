@@ -0,0 +1,37 @@
+#ifndef SOAK_ADAFRUIT_GFX_H
+#define SOAK_ADAFRUIT_GFX_H
+
+// Subconjunto do Adafruit_GFX usado pelo display. O texto sai em células de 6x8 com
+// um glifo aproximado: o que importa no soak é a quantidade de pixels acesos.
+
+#include <Arduino.h>
+
+class Adafruit_GFX : public Print {
+ public:
+  Adafruit_GFX(int16_t w, int16_t h) : _width(w), _height(h) {}
+  virtual void drawPixel(int16_t x, int16_t y, uint16_t color) = 0;
+  virtual void drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color);
+  virtual void drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color);
+  virtual void fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color);
+  virtual void fillScreen(uint16_t color);
+  void drawRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color);
+  void drawBitmap(int16_t x, int16_t y, const uint8_t* bitmap, int16_t w, int16_t h, uint16_t color);
+  void setTextSize(uint8_t size) { textSize = size ? size : 1; }
+  void setTextColor(uint16_t color) { textColor = textBackground = color; }
+  void setTextColor(uint16_t color, uint16_t background) { textColor = color; textBackground = background; }
+  void setCursor(int16_t x, int16_t y) { cursorX = x; cursorY = y; }
+  void setTextWrap(bool wrap) { textWrap = wrap; }
+  size_t write(uint8_t c) override;
+  using Print::write;
+  int16_t width() const { return _width; }
+  int16_t height() const { return _height; }
+
+ protected:
+  int16_t _width, _height;
+  int16_t cursorX = 0, cursorY = 0;
+  uint8_t textSize = 1;
+  uint16_t textColor = 1, textBackground = 1;  // Iguais: fundo transparente, como na biblioteca
+  bool textWrap = true;
+};
+
+#endif
@@ -0,0 +1,33 @@
+#ifndef SOAK_ADAFRUIT_SSD1306_H
+#define SOAK_ADAFRUIT_SSD1306_H
+
+// SSD1306 128x64 com o framebuffer de 1 KB no heap simulado (alocado em begin, como a biblioteca)
+
+#include <Adafruit_GFX.h>
+#include <Wire.h>
+
+#define SSD1306_SWITCHCAPVCC 2
+#define WHITE 1
+#define BLACK 0
+#define INVERSE 2
+#define SSD1306_WHITE 1
+#define SSD1306_BLACK 0
+#define SSD1306_SETCONTRAST 0x81
+
+class Adafruit_SSD1306 : public Adafruit_GFX {
+ public:
+  Adafruit_SSD1306(uint8_t w, uint8_t h, TwoWire*, int8_t) : Adafruit_GFX(w, h) {}
+  ~Adafruit_SSD1306();
+  bool begin(uint8_t vcc, uint8_t address);
+  void clearDisplay();
+  void display() {}
+  void drawPixel(int16_t x, int16_t y, uint16_t color) override;
+  void ssd1306_command(uint8_t) {}
+  void dim(bool) {}
+  uint8_t* getBuffer() { return buffer; }
+
+ private:
+  uint8_t* buffer = nullptr;
+};
+
+#endif
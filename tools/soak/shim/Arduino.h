@@ -0,0 +1,232 @@
+#ifndef SOAK_ARDUINO_H
+#define SOAK_ARDUINO_H
+
+// Núcleo Arduino/ESP8266 para rodar o firmware no PC (tools/soak). Só o que o
+// firmware usa: relógio virtual, pinos com ISR, Print/Stream/String, Serial, ESP e
+// timer1. O lado do teste (avançar o relógio, mexer nos pinos, ler o heap) está em host.h.
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <ctype.h>
+#include <math.h>
+#include <algorithm>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <new>
+#include <random>
+#include <string>
+#include <vector>
+
+// Como no core 3.x: min/max aceitam tipos mistos (min(x, 99UL) com x unsigned int)
+template <typename T, typename L>
+auto min(const T& a, const L& b) -> decltype((b < a) ? b : a) {
+  return (b < a) ? b : a;
+}
+
+template <typename T, typename L>
+auto max(const T& a, const L& b) -> decltype((b < a) ? b : a) {
+  return (a < b) ? b : a;
+}
+
+#define HIGH 1
+#define LOW 0
+#define INPUT 0
+#define OUTPUT 1
+#define INPUT_PULLUP 2
+#define RISING 1
+#define FALLING 2
+#define CHANGE 3
+#define HEX 16
+#define DEC 10
+
+enum { D0 = 16, D1 = 5, D2 = 4, D3 = 0, D4 = 2, D5 = 14, D6 = 12, D7 = 13, D8 = 15 };
+
+#define PROGMEM
+#define PSTR(s) (s)
+#define F(s) (s)
+#define IRAM_ATTR
+#define ICACHE_RAM_ATTR
+#define pgm_read_byte(p) (*(const uint8_t*)(p))
+#define pgm_read_word(p) (*(const uint16_t*)(p))
+#define pgm_read_ptr(p) (*(void* const*)(p))
+#define strcpy_P strcpy
+#define memcpy_P memcpy
+#define constrain(a, l, h) ((a) < (l) ? (l) : ((a) > (h) ? (h) : (a)))
+#define digitalPinToInterrupt(p) (p)
+#define noInterrupts()
+#define interrupts()
+
+typedef uint8_t byte;
+typedef bool boolean;
+
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+void yield();
+
+int digitalRead(uint8_t pin);
+void digitalWrite(uint8_t pin, uint8_t level);
+void pinMode(uint8_t pin, uint8_t mode);
+int analogRead(uint8_t pin);
+void attachInterrupt(uint8_t pin, void (*isr)(void), int mode);
+void attachInterruptArg(uint8_t pin, void (*isr)(void*), void* arg, int mode);
+void detachInterrupt(uint8_t pin);
+
+long random(long max);
+long random(long min, long max);
+void randomSeed(unsigned long seed);
+long map(long x, long inMin, long inMax, long outMin, long outMax);
+
+class String;
+class Print;
+
+class Printable {
+ public:
+  virtual ~Printable() {}
+  virtual size_t printTo(Print& out) const = 0;
+};
+
+class Print {
+ public:
+  virtual ~Print() {}
+  virtual size_t write(uint8_t c) = 0;
+  virtual size_t write(const uint8_t* data, size_t length);
+  size_t write(const char* s) { return write((const uint8_t*)s, strlen(s)); }
+  size_t print(const char* s);
+  size_t print(char c);
+  size_t print(int value, int base = DEC);
+  size_t print(unsigned int value, int base = DEC);
+  size_t print(long value, int base = DEC);
+  size_t print(unsigned long value, int base = DEC);
+  size_t print(double value, int digits = 2);
+  size_t print(const String& s);
+  size_t print(const Printable& p);
+  size_t println();
+  size_t println(const char* s);
+  size_t println(char c);
+  size_t println(int value, int base = DEC);
+  size_t println(unsigned int value, int base = DEC);
+  size_t println(long value, int base = DEC);
+  size_t println(unsigned long value, int base = DEC);
+  size_t println(double value, int digits = 2);
+  size_t println(const String& s);
+  size_t println(const Printable& p);
+  size_t printf(const char* format, ...) __attribute__((format(printf, 2, 3)));
+  virtual void flush() {}
+};
+
+class Stream : public Print {
+ public:
+  virtual int available() = 0;
+  virtual int read() = 0;
+  virtual int peek() = 0;
+  void setTimeout(unsigned long) {}
+};
+
+// Texto no heap simulado (como no ESP8266): cada cópia e concatenação aloca
+class String {
+ public:
+  String(const char* s = "");
+  String(const String& other);
+  String(String&& other) noexcept;
+  explicit String(char c);
+  String(int value);
+  String(unsigned int value);
+  String(long value);
+  String(unsigned long value);
+  ~String();
+  String& operator=(const String& other);
+  String& operator=(String&& other) noexcept;
+  String& operator=(const char* s);
+  String& operator+=(const String& other);
+  String& operator+=(const char* s);
+  String& operator+=(char c);
+  const char* c_str() const { return buffer ? buffer : ""; }
+  unsigned int length() const { return len; }
+  void trim();
+  bool startsWith(const char* prefix) const;
+  String substring(unsigned int from) const;
+  String substring(unsigned int from, unsigned int to) const;
+  long toInt() const;
+  bool operator==(const char* s) const { return strcmp(c_str(), s) == 0; }
+  bool operator==(const String& s) const { return strcmp(c_str(), s.c_str()) == 0; }
+  bool operator!=(const char* s) const { return !(*this == s); }
+  bool operator>(const String& s) const { return strcmp(c_str(), s.c_str()) > 0; }
+  bool operator<(const String& s) const { return strcmp(c_str(), s.c_str()) < 0; }
+  char operator[](unsigned int i) const { return i < len ? buffer[i] : '\0'; }
+  friend String operator+(const String& a, const String& b);
+  friend String operator+(const String& a, const char* b);
+  friend String operator+(const char* a, const String& b);
+
+ private:
+  void assign(const char* s, size_t n);
+  void append(const char* s, size_t n);
+  char* buffer = nullptr;
+  unsigned int len = 0;
+};
+
+class HardwareSerial : public Stream {
+ public:
+  void begin(unsigned long) {}
+  size_t write(uint8_t c) override;
+  using Print::write;
+  int available() override;
+  int read() override;
+  int peek() override;
+  explicit operator bool() const { return true; }
+};
+
+extern HardwareSerial Serial;
+
+struct rst_info {
+  uint32_t reason;
+};
+
+enum { REASON_DEFAULT_RST = 0, REASON_WDT_RST, REASON_EXCEPTION_RST, REASON_SOFT_WDT_RST, REASON_SOFT_RESTART, REASON_DEEP_SLEEP_AWAKE, REASON_EXT_SYS_RST };
+
+class EspClass {
+ public:
+  uint32_t getFreeHeap();
+  uint32_t getMaxFreeBlockSize();
+  uint8_t getHeapFragmentation();
+  uint32_t getCycleCount();
+  uint8_t getCpuFreqMHz() { return 80; }
+  bool rtcUserMemoryRead(uint32_t offset, uint32_t* data, size_t size);
+  bool rtcUserMemoryWrite(uint32_t offset, uint32_t* data, size_t size);
+  rst_info* getResetInfoPtr();
+  void restart();
+  uint32_t random();
+};
+
+extern EspClass ESP;
+
+#define TIM_DIV1 0
+#define TIM_DIV16 1
+#define TIM_DIV256 3
+#define TIM_EDGE 0
+#define TIM_LEVEL 1
+#define TIM_SINGLE 0
+#define TIM_LOOP 1
+
+void timer1_attachInterrupt(void (*isr)(void));
+void timer1_enable(uint8_t divider, uint8_t type, uint8_t reload);
+void timer1_write(uint32_t ticks);
+void timer1_disable();
+
+// O firmware foi escrito para o Xtensa, que é ILP32: unsigned long tem 32 bits e
+// "now - last" continua certo depois da volta de millis(). No x86-64 long tem 64
+// bits e a mesma conta vira um número enorme na volta, então nas unidades do
+// firmware (e do teste) long passa a ser int. Os arquivos do próprio shim definem
+// SOAK_SHIM e ficam com o long nativo; por isso todo cabeçalho padrão usado depois
+// deste ponto já foi incluído acima, e os cabeçalhos do shim não usam long.
+#ifndef SOAK_SHIM
+#define long int
+#endif
+
+#endif
@@ -0,0 +1,158 @@
+#ifndef SOAK_ESP8266WIFI_H
+#define SOAK_ESP8266WIFI_H
+
+// Wi-Fi, TCP e UDP do core ESP8266 sobre o "ar" do shim: um único AP (o peer, em
+// 192.168.4.1:5000) que o teste liga, desliga e cujo socket ele alimenta (host.h)
+
+#include <Arduino.h>
+#include <functional>
+#include <memory>
+
+class IPAddress : public Printable {
+ public:
+  IPAddress() : address(0) {}
+  IPAddress(uint8_t a, uint8_t b, uint8_t c, uint8_t d) : address((uint32_t)a | (uint32_t)b << 8 | (uint32_t)c << 16 | (uint32_t)d << 24) {}
+  IPAddress(uint32_t raw) : address(raw) {}
+  operator uint32_t() const { return address; }
+  uint8_t operator[](int i) const { return (uint8_t)(address >> (8 * i)); }
+  size_t printTo(Print& out) const override;
+  String toString() const;
+
+ private:
+  uint32_t address;  // Ordem de rede, como no core (primeiro octeto no byte baixo)
+};
+
+enum WiFiMode_t { WIFI_OFF = 0, WIFI_STA = 1, WIFI_AP = 2, WIFI_AP_STA = 3 };
+enum WiFiPhyMode_t { WIFI_PHY_MODE_11B = 1, WIFI_PHY_MODE_11G = 2, WIFI_PHY_MODE_11N = 3 };
+enum WiFiSleepType_t { WIFI_NONE_SLEEP = 0, WIFI_LIGHT_SLEEP = 1, WIFI_MODEM_SLEEP = 2 };
+enum wl_status_t { WL_IDLE_STATUS = 0, WL_NO_SSID_AVAIL = 1, WL_SCAN_COMPLETED = 2, WL_CONNECTED = 3, WL_CONNECT_FAILED = 4, WL_CONNECTION_LOST = 5, WL_WRONG_PASSWORD = 6, WL_DISCONNECTED = 7 };
+
+#define WIFI_SCAN_RUNNING (-1)
+#define WIFI_SCAN_FAILED (-2)
+
+struct WiFiEventStationModeGotIP {
+  IPAddress ip, mask, gw;
+};
+
+struct WiFiEventStationModeDisconnected {
+  uint8_t bssid[6];
+  int reason;
+};
+
+struct WiFiEventSoftAPModeStationConnected {
+  uint8_t mac[6];
+  uint8_t aid;
+};
+
+struct WiFiEventSoftAPModeStationDisconnected {
+  uint8_t mac[6];
+  uint8_t aid;
+};
+
+struct WiFiEventHandlerOpaque {
+  virtual ~WiFiEventHandlerOpaque() {}
+};
+typedef std::shared_ptr<WiFiEventHandlerOpaque> WiFiEventHandler;
+
+class ESP8266WiFiClass {
+ public:
+  bool mode(WiFiMode_t mode);
+  WiFiMode_t getMode();
+  bool setPhyMode(WiFiPhyMode_t) { return true; }
+  int8_t scanNetworks(bool async = false, bool showHidden = false);
+  int8_t scanComplete();
+  void scanDelete();
+  String SSID(uint8_t i) const;
+  String SSID() const;
+  int32_t RSSI(uint8_t i);
+  int32_t RSSI();
+  int32_t channel(uint8_t i);
+  int32_t channel();
+  uint8_t encryptionType(uint8_t) { return 7; }  // ENC_TYPE_NONE
+  String BSSIDstr(uint8_t i);
+  uint8_t* BSSID();
+  wl_status_t begin(const char* ssid, const char* pass = nullptr, int32_t channel = 0, const uint8_t* bssid = nullptr, bool connect = true);
+  wl_status_t status();
+  void printDiag(Print& out);
+  bool softAP(const char* ssid, const char* pass = nullptr, int channel = 1, int hidden = 0, int maxConnections = 4);
+  IPAddress softAPIP();
+  String softAPmacAddress();
+  uint8_t softAPgetStationNum();
+  bool softAPdisconnect(bool wifiOff = false);
+  String macAddress();
+  uint8_t* macAddress(uint8_t* mac);
+  IPAddress localIP();
+  IPAddress gatewayIP();
+  bool disconnect(bool wifiOff = false);
+  void setOutputPower(float) {}
+  bool setSleepMode(WiFiSleepType_t type);
+  WiFiSleepType_t getSleepMode();
+  bool setAutoReconnect(bool) { return true; }
+  bool config(IPAddress local, IPAddress gateway, IPAddress subnet);
+  WiFiEventHandler onStationModeGotIP(std::function<void(const WiFiEventStationModeGotIP&)> handler);
+  WiFiEventHandler onStationModeDisconnected(std::function<void(const WiFiEventStationModeDisconnected&)> handler);
+  WiFiEventHandler onSoftAPModeStationConnected(std::function<void(const WiFiEventSoftAPModeStationConnected&)> handler);
+  WiFiEventHandler onSoftAPModeStationDisconnected(std::function<void(const WiFiEventSoftAPModeStationDisconnected&)> handler);
+};
+
+extern ESP8266WiFiClass WiFi;
+
+struct HostSocket;
+
+class WiFiClient : public Stream {
+ public:
+  WiFiClient() {}
+  explicit WiFiClient(std::shared_ptr<HostSocket> socket) : socket(socket) {}
+  int connect(IPAddress ip, uint16_t port);
+  uint8_t connected();
+  size_t write(uint8_t c) override;
+  size_t write(const uint8_t* data, size_t length) override;
+  using Print::write;
+  int available() override;
+  int availableForWrite();
+  int read() override;
+  int read(uint8_t* data, size_t length);
+  int peek() override;
+  void flush() override {}
+  void stop();
+  explicit operator bool();
+  IPAddress remoteIP();
+  void setNoDelay(bool) {}
+
+ private:
+  std::shared_ptr<HostSocket> socket;
+};
+
+class WiFiServer {
+ public:
+  WiFiServer(uint16_t port) : port(port) {}
+  void begin();
+  WiFiClient available();
+  void setNoDelay(bool) {}
+
+ private:
+  uint16_t port;
+};
+
+// Sem tráfego multicast no ar simulado: o grupo existe, mas nada chega
+class WiFiUDP : public Stream {
+ public:
+  uint8_t begin(uint16_t) { return 1; }
+  uint8_t beginMulticast(IPAddress, IPAddress, uint16_t) { return 1; }
+  int beginPacket(IPAddress, uint16_t) { return 1; }
+  int beginPacketMulticast(IPAddress, uint16_t, IPAddress, int = 1) { return 1; }
+  int endPacket() { return 1; }
+  size_t write(uint8_t) override { return 1; }
+  size_t write(const uint8_t*, size_t length) override { return length; }
+  using Print::write;
+  int parsePacket() { return 0; }
+  int available() override { return 0; }
+  int read() override { return -1; }
+  int read(uint8_t*, size_t) { return 0; }
+  int peek() override { return -1; }
+  IPAddress remoteIP() { return IPAddress(); }
+  uint16_t remotePort() { return 0; }
+  void stop() {}
+};
+
+#endif
@@ -0,0 +1,8 @@
+#ifndef SOAK_ESP8266WIFIMULTI_H
+#define SOAK_ESP8266WIFIMULTI_H
+
+#include <ESP8266WiFi.h>
+
+class ESP8266WiFiMulti {};
+
+#endif
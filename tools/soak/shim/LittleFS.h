@@ -0,0 +1,57 @@
+#ifndef SOAK_LITTLEFS_H
+#define SOAK_LITTLEFS_H
+
+// LittleFS em memória: arquivos inteiros no PC, blocos de 4 KB contados contra a
+// capacidade de host::initFlash e cada arquivo aberto ocupando o heap simulado
+
+#include <Arduino.h>
+#include <memory>
+
+namespace fs {
+
+enum SeekMode { SeekSet = 0, SeekCur = 1, SeekEnd = 2 };
+
+struct OpenFile;
+
+class File : public Stream {
+ public:
+  File() {}
+  explicit File(std::shared_ptr<OpenFile> handle) : handle(handle) {}
+  size_t write(uint8_t c) override;
+  size_t write(const uint8_t* data, size_t length) override;
+  using Print::write;
+  int available() override;
+  int read() override;
+  size_t read(uint8_t* data, size_t length);
+  int peek() override;
+  void flush() override;
+  bool seek(uint32_t offset, SeekMode mode = SeekSet);
+  size_t position() const;
+  size_t size() const;
+  void close();
+  explicit operator bool() const { return handle != nullptr; }
+
+ private:
+  std::shared_ptr<OpenFile> handle;
+};
+
+class FS {
+ public:
+  bool begin();
+  File open(const char* path, const char* mode);
+  bool exists(const char* path);
+  bool remove(const char* path);
+  bool rename(const char* from, const char* to);
+};
+
+}  // namespace fs
+
+using fs::File;
+using fs::FS;
+using fs::SeekSet;
+using fs::SeekCur;
+using fs::SeekEnd;
+
+extern fs::FS LittleFS;
+
+#endif
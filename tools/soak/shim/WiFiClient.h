@@ -0,0 +1,6 @@
+#ifndef SOAK_WIFICLIENT_H
+#define SOAK_WIFICLIENT_H
+
+#include <ESP8266WiFi.h>
+
+#endif
@@ -0,0 +1,6 @@
+#ifndef SOAK_WIFIUDP_H
+#define SOAK_WIFIUDP_H
+
+#include <ESP8266WiFi.h>
+
+#endif
@@ -0,0 +1,21 @@
+#ifndef SOAK_WIRE_H
+#define SOAK_WIRE_H
+
+// I2C sem barramento: as transmissões sempre terminam com ACK (0)
+
+#include <Arduino.h>
+
+class TwoWire {
+ public:
+  void begin() {}
+  void begin(int, int) {}
+  void setClock(uint32_t) {}
+  void beginTransmission(uint8_t) {}
+  size_t write(uint8_t) { return 1; }
+  size_t write(const uint8_t*, size_t length) { return length; }
+  uint8_t endTransmission(bool = true) { return 0; }
+};
+
+extern TwoWire Wire;
+
+#endif
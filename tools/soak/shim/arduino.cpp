@@ -0,0 +1,728 @@
+#define SOAK_SHIM  // long nativo (ver Arduino.h)
+#include "Arduino.h"
+#include <stdarg.h>
+#include <map>
+#include <new>
+#include <random>
+#include "host.h"
+#include "internal.h"
+
+HardwareSerial Serial;
+EspClass ESP;
+
+// ---------------------------------------------------------------- Heap simulado
+
+namespace {
+
+const uint32_t HEAP_MAGIC = 0x50414548;  // "HEAP"
+const uint32_t HEAP_BLOCK = 8;
+const uint32_t HEAP_HEADER = 4;
+
+// Cabeçalho na memória real: diz se o bloco também ocupa o heap simulado
+struct alignas(16) Allocation {
+  uint32_t magic;
+  int32_t block;   // Primeiro bloco no heap simulado; -1 = memória do shim/teste
+  uint32_t blocks;
+};
+
+bool firmwareContext = false;
+bool insideHeap = false;  // std::map do próprio heap aloca memória do shim
+std::map<uint32_t, uint32_t>* freeBlocks = nullptr;  // Primeiro bloco -> quantidade
+host::HeapStats stats;
+
+void* rawAlloc(size_t size, int32_t block, uint32_t blocks) {
+  Allocation* a = (Allocation*)malloc(sizeof(Allocation) + (size ? size : 1));
+  if (a == nullptr) return nullptr;
+  a->magic = HEAP_MAGIC;
+  a->block = block;
+  a->blocks = blocks;
+  return a + 1;
+}
+
+void refreshStats() {
+  uint32_t maxBlock = 0;
+  double squares = 0;
+  uint32_t freeBytes = 0;
+  for (const auto& f : *freeBlocks) {
+    uint32_t bytes = f.second * HEAP_BLOCK;
+    maxBlock = max(maxBlock, bytes);
+    squares += (double)bytes * bytes;
+    freeBytes += bytes;
+  }
+  stats.used = stats.size - freeBytes;
+  stats.maxUsed = max(stats.maxUsed, stats.used);
+  stats.maxBlock = maxBlock > HEAP_HEADER ? maxBlock - HEAP_HEADER : 0;
+  stats.minMaxBlock = min(stats.minMaxBlock, stats.maxBlock);
+  stats.fragmentation = freeBytes > 0 ? (uint8_t)(100 - (uint32_t)(sqrt(squares) * 100 / freeBytes)) : 0;
+  stats.maxFragmentation = max(stats.maxFragmentation, stats.fragmentation);
+}
+
+// Best fit como o umm_malloc do core: o menor trecho livre que couber
+int32_t placeBlocks(uint32_t blocks) {
+  auto best = freeBlocks->end();
+  for (auto it = freeBlocks->begin(); it != freeBlocks->end(); ++it) {
+    if (it->second >= blocks && (best == freeBlocks->end() || it->second < best->second)) best = it;
+  }
+  if (best == freeBlocks->end()) return -1;
+  uint32_t first = best->first;
+  uint32_t left = best->second - blocks;
+  freeBlocks->erase(best);
+  if (left > 0) (*freeBlocks)[first + blocks] = left;
+  return (int32_t)first;
+}
+
+void releaseBlocks(uint32_t first, uint32_t blocks) {
+  auto next = freeBlocks->find(first + blocks);
+  if (next != freeBlocks->end()) {
+    blocks += next->second;
+    freeBlocks->erase(next);
+  }
+  auto it = freeBlocks->lower_bound(first);
+  if (it != freeBlocks->begin()) {
+    auto prev = std::prev(it);
+    if (prev->first + prev->second == first) {
+      prev->second += blocks;
+      return;
+    }
+  }
+  (*freeBlocks)[first] = blocks;
+}
+
+}  // namespace
+
+namespace host {
+
+void initHeap(uint32_t size) {
+  HostScope scope;
+  insideHeap = true;
+  if (freeBlocks == nullptr) freeBlocks = new std::map<uint32_t, uint32_t>();
+  freeBlocks->clear();
+  (*freeBlocks)[0] = size / HEAP_BLOCK;
+  insideHeap = false;
+  memset(&stats, 0, sizeof(stats));
+  stats.size = size / HEAP_BLOCK * HEAP_BLOCK;
+  stats.minMaxBlock = UINT32_MAX;
+  refreshStats();
+}
+
+HeapStats heapStats() {
+  return stats;
+}
+
+void* heapAlloc(size_t size) {
+  if (freeBlocks == nullptr || insideHeap) return rawAlloc(size, -1, 0);
+  uint32_t blocks = (uint32_t)((size + HEAP_HEADER + HEAP_BLOCK - 1) / HEAP_BLOCK);
+  insideHeap = true;
+  int32_t first = placeBlocks(blocks);
+  insideHeap = false;
+  if (first < 0) {
+    stats.failures++;
+    return nullptr;
+  }
+  void* p = rawAlloc(size, first, blocks);
+  stats.allocations++;
+  stats.liveBlocks++;
+  insideHeap = true;
+  refreshStats();
+  insideHeap = false;
+  return p;
+}
+
+void heapFree(void* p) {
+  if (p == nullptr) return;
+  Allocation* a = (Allocation*)p - 1;
+  if (a->magic != HEAP_MAGIC) abort();
+  a->magic = 0;
+  if (a->block >= 0) {
+    insideHeap = true;
+    releaseBlocks((uint32_t)a->block, a->blocks);
+    refreshStats();
+    insideHeap = false;
+    stats.liveBlocks--;
+  }
+  free(a);
+}
+
+FirmwareScope::FirmwareScope() : previous(firmwareContext) {
+  firmwareContext = true;
+}
+
+FirmwareScope::~FirmwareScope() {
+  firmwareContext = previous;
+}
+
+HostScope::HostScope() : previous(firmwareContext) {
+  firmwareContext = false;
+}
+
+HostScope::~HostScope() {
+  firmwareContext = previous;
+}
+
+}  // namespace host
+
+static void* allocate(size_t size) {
+  return firmwareContext && !insideHeap ? host::heapAlloc(size) : rawAlloc(size, -1, 0);
+}
+
+void* operator new(size_t size) {
+  void* p = allocate(size);
+  if (p == nullptr) throw std::bad_alloc();
+  return p;
+}
+
+void* operator new[](size_t size) {
+  return operator new(size);
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+  return allocate(size);
+}
+
+void* operator new[](size_t size, const std::nothrow_t&) noexcept {
+  return allocate(size);
+}
+
+void operator delete(void* p) noexcept {
+  host::heapFree(p);
+}
+
+void operator delete[](void* p) noexcept {
+  host::heapFree(p);
+}
+
+void operator delete(void* p, size_t) noexcept {
+  host::heapFree(p);
+}
+
+void operator delete[](void* p, size_t) noexcept {
+  host::heapFree(p);
+}
+
+uint32_t EspClass::getFreeHeap() {
+  return stats.size - stats.used;
+}
+
+uint32_t EspClass::getMaxFreeBlockSize() {
+  return stats.maxBlock;
+}
+
+uint8_t EspClass::getHeapFragmentation() {
+  return stats.fragmentation;
+}
+
+// ---------------------------------------------------------------- Relógio e timer1
+
+static uint64_t clockUs = 0;
+static uint32_t firstMillis = 0;
+static void (*timer1Isr)(void) = nullptr;
+static bool timer1Armed = false;
+static uint64_t timer1At = 0;
+static uint32_t timer1TicksPerUs = 5;
+
+namespace host {
+
+uint64_t nowUs() {
+  return clockUs;
+}
+
+void startClock(uint32_t first) {
+  clockUs = 0;
+  firstMillis = first;
+}
+
+uint64_t elapsedUs() {
+  return clockUs;
+}
+
+void advance(uint32_t us) {
+  uint64_t target = clockUs + us;
+  while (timer1Armed && timer1At <= target) {
+    clockUs = max(clockUs, timer1At);
+    timer1Armed = false;  // TIM_SINGLE: o ISR rearma com timer1_write
+    if (timer1Isr) timer1Isr();
+  }
+  clockUs = target;
+  wifiTick();
+}
+
+}  // namespace host
+
+unsigned long millis() {
+  return (unsigned long)(uint32_t)(firstMillis + clockUs / 1000);
+}
+
+unsigned long micros() {
+  return (unsigned long)(uint32_t)clockUs;
+}
+
+void delay(unsigned long ms) {
+  host::advance(ms * 1000);
+}
+
+void delayMicroseconds(unsigned int us) {
+  host::advance(us);
+}
+
+void yield() {
+}
+
+uint32_t EspClass::getCycleCount() {
+  return (uint32_t)(clockUs * 80);
+}
+
+void timer1_attachInterrupt(void (*isr)(void)) {
+  timer1Isr = isr;
+}
+
+void timer1_enable(uint8_t divider, uint8_t, uint8_t) {
+  timer1TicksPerUs = divider == TIM_DIV1 ? 80 : divider == TIM_DIV16 ? 5 : 1;
+}
+
+void timer1_write(uint32_t ticks) {
+  timer1At = clockUs + max(ticks / timer1TicksPerUs, 1u);
+  timer1Armed = true;
+}
+
+void timer1_disable() {
+  timer1Armed = false;
+}
+
+// ---------------------------------------------------------------- Pinos
+
+struct PinState {
+  int level = HIGH;  // Entradas com pull-up
+  void (*isr)(void) = nullptr;
+  void (*isrArg)(void*) = nullptr;
+  void* arg = nullptr;
+  int mode = CHANGE;
+};
+
+static PinState pins[17];
+
+int digitalRead(uint8_t pin) {
+  return pin < 17 ? pins[pin].level : LOW;
+}
+
+void digitalWrite(uint8_t pin, uint8_t level) {
+  if (pin < 17) pins[pin].level = level;
+}
+
+void pinMode(uint8_t pin, uint8_t mode) {
+  if (pin < 17 && mode != OUTPUT) pins[pin].level = HIGH;
+}
+
+int analogRead(uint8_t) {
+  return 512;
+}
+
+void attachInterrupt(uint8_t pin, void (*isr)(void), int mode) {
+  if (pin >= 17) return;
+  pins[pin].isr = isr;
+  pins[pin].isrArg = nullptr;
+  pins[pin].mode = mode;
+}
+
+void attachInterruptArg(uint8_t pin, void (*isr)(void*), void* arg, int mode) {
+  if (pin >= 17) return;
+  pins[pin].isr = nullptr;
+  pins[pin].isrArg = isr;
+  pins[pin].arg = arg;
+  pins[pin].mode = mode;
+}
+
+void detachInterrupt(uint8_t pin) {
+  if (pin >= 17) return;
+  pins[pin].isr = nullptr;
+  pins[pin].isrArg = nullptr;
+}
+
+namespace host {
+
+void setPin(uint8_t pin, int level) {
+  if (pin >= 17 || pins[pin].level == level) return;
+  PinState& p = pins[pin];
+  p.level = level;
+  bool fire = p.mode == CHANGE || (p.mode == RISING && level == HIGH) || (p.mode == FALLING && level == LOW);
+  if (!fire) return;
+  FirmwareScope scope;
+  if (p.isr) p.isr();
+  if (p.isrArg) p.isrArg(p.arg);
+}
+
+int outputLevel(uint8_t pin) {
+  return pin < 17 ? pins[pin].level : LOW;
+}
+
+}  // namespace host
+
+// ---------------------------------------------------------------- Aleatórios
+
+static std::mt19937 firmwareRandom(1);
+static std::mt19937 hardwareRandom(2);
+
+long random(long max) {
+  return max > 0 ? (long)(firmwareRandom() % (unsigned long)max) : 0;
+}
+
+long random(long min, long max) {
+  return max > min ? min + random(max - min) : min;
+}
+
+void randomSeed(unsigned long seed) {
+  firmwareRandom.seed(seed);
+}
+
+long map(long x, long inMin, long inMax, long outMin, long outMax) {
+  return (x - inMin) * (outMax - outMin) / (inMax - inMin) + outMin;
+}
+
+uint32_t EspClass::random() {
+  return hardwareRandom();
+}
+
+// ---------------------------------------------------------------- ESP: RTC, reset
+
+static uint32_t rtcMemory[128];  // 512 bytes de memória de usuário da RTC
+static rst_info resetInfo = { REASON_DEFAULT_RST };
+static bool restarted = false;
+
+bool EspClass::rtcUserMemoryRead(uint32_t offset, uint32_t* data, size_t size) {
+  if (offset * 4 + size > sizeof(rtcMemory)) return false;
+  memcpy(data, rtcMemory + offset, size);
+  return true;
+}
+
+bool EspClass::rtcUserMemoryWrite(uint32_t offset, uint32_t* data, size_t size) {
+  if (offset * 4 + size > sizeof(rtcMemory)) return false;
+  memcpy(rtcMemory + offset, data, size);
+  return true;
+}
+
+rst_info* EspClass::getResetInfoPtr() {
+  return &resetInfo;
+}
+
+void EspClass::restart() {
+  restarted = true;
+}
+
+namespace host {
+
+bool restartRequested() {
+  return restarted;
+}
+
+}  // namespace host
+
+// ---------------------------------------------------------------- Print
+
+size_t Print::write(const uint8_t* data, size_t length) {
+  size_t n = 0;
+  while (length--) n += write(*data++);
+  return n;
+}
+
+static size_t printNumber(Print& out, unsigned long value, int base, bool negative) {
+  char text[40];
+  char* p = text + sizeof(text);
+  *--p = '\0';
+  if (base < 2) base = DEC;
+  do {
+    int digit = value % base;
+    *--p = (char)(digit < 10 ? '0' + digit : 'A' + digit - 10);
+    value /= base;
+  } while (value > 0);
+  if (negative) *--p = '-';
+  return out.write(p);
+}
+
+size_t Print::print(const char* s) {
+  return write(s);
+}
+
+size_t Print::print(char c) {
+  return write((uint8_t)c);
+}
+
+size_t Print::print(int value, int base) {
+  return print((long)value, base);
+}
+
+size_t Print::print(unsigned int value, int base) {
+  return print((unsigned long)value, base);
+}
+
+size_t Print::print(long value, int base) {
+  if (base == DEC && value < 0) return printNumber(*this, (unsigned long)-value, DEC, true);
+  return printNumber(*this, (unsigned long)value, base, false);
+}
+
+size_t Print::print(unsigned long value, int base) {
+  return printNumber(*this, value, base, false);
+}
+
+size_t Print::print(double value, int digits) {
+  char text[48];
+  if (isnan(value)) return write("nan");
+  if (isinf(value)) return write("inf");
+  snprintf(text, sizeof(text), "%.*f", digits, value);
+  return write(text);
+}
+
+size_t Print::print(const String& s) {
+  return write(s.c_str());
+}
+
+size_t Print::print(const Printable& p) {
+  return p.printTo(*this);
+}
+
+size_t Print::println() {
+  return write("\r\n");
+}
+
+size_t Print::println(const char* s) {
+  return print(s) + println();
+}
+
+size_t Print::println(char c) {
+  return print(c) + println();
+}
+
+size_t Print::println(int value, int base) {
+  return print(value, base) + println();
+}
+
+size_t Print::println(unsigned int value, int base) {
+  return print(value, base) + println();
+}
+
+size_t Print::println(long value, int base) {
+  return print(value, base) + println();
+}
+
+size_t Print::println(unsigned long value, int base) {
+  return print(value, base) + println();
+}
+
+size_t Print::println(double value, int digits) {
+  return print(value, digits) + println();
+}
+
+size_t Print::println(const String& s) {
+  return print(s) + println();
+}
+
+size_t Print::println(const Printable& p) {
+  return print(p) + println();
+}
+
+size_t Print::printf(const char* format, ...) {
+  char text[256];
+  va_list args;
+  va_start(args, format);
+  vsnprintf(text, sizeof(text), format, args);
+  va_end(args);
+  return write(text);
+}
+
+// ---------------------------------------------------------------- String
+
+void String::assign(const char* s, size_t n) {
+  char* fresh = (char*)host::heapAlloc(n + 1);
+  if (fresh == nullptr) {  // Como no core: String inválida (vazia) sem memória
+    host::heapFree(buffer);
+    buffer = nullptr;
+    len = 0;
+    return;
+  }
+  memcpy(fresh, s, n);
+  fresh[n] = '\0';
+  host::heapFree(buffer);
+  buffer = fresh;
+  len = (unsigned int)n;
+}
+
+void String::append(const char* s, size_t n) {
+  char* fresh = (char*)host::heapAlloc(len + n + 1);
+  if (fresh == nullptr) return;
+  memcpy(fresh, c_str(), len);
+  memcpy(fresh + len, s, n);
+  fresh[len + n] = '\0';
+  host::heapFree(buffer);
+  buffer = fresh;
+  len += (unsigned int)n;
+}
+
+String::String(const char* s) {
+  assign(s ? s : "", s ? strlen(s) : 0);
+}
+
+String::String(const String& other) {
+  assign(other.c_str(), other.len);
+}
+
+String::String(String&& other) noexcept : buffer(other.buffer), len(other.len) {
+  other.buffer = nullptr;
+  other.len = 0;
+}
+
+String::String(char c) {
+  assign(&c, 1);
+}
+
+String::String(int value) : String((long)value) {
+}
+
+String::String(unsigned int value) : String((unsigned long)value) {
+}
+
+String::String(long value) {
+  char text[24];
+  snprintf(text, sizeof(text), "%ld", value);
+  assign(text, strlen(text));
+}
+
+String::String(unsigned long value) {
+  char text[24];
+  snprintf(text, sizeof(text), "%lu", value);
+  assign(text, strlen(text));
+}
+
+String::~String() {
+  host::heapFree(buffer);
+}
+
+String& String::operator=(const String& other) {
+  if (this != &other) assign(other.c_str(), other.len);
+  return *this;
+}
+
+String& String::operator=(String&& other) noexcept {
+  if (this != &other) {
+    host::heapFree(buffer);
+    buffer = other.buffer;
+    len = other.len;
+    other.buffer = nullptr;
+    other.len = 0;
+  }
+  return *this;
+}
+
+String& String::operator=(const char* s) {
+  assign(s, strlen(s));
+  return *this;
+}
+
+String& String::operator+=(const String& other) {
+  append(other.c_str(), other.len);
+  return *this;
+}
+
+String& String::operator+=(const char* s) {
+  append(s, strlen(s));
+  return *this;
+}
+
+String& String::operator+=(char c) {
+  append(&c, 1);
+  return *this;
+}
+
+void String::trim() {
+  const char* s = c_str();
+  size_t start = 0, end = len;
+  while (start < end && isspace((unsigned char)s[start])) start++;
+  while (end > start && isspace((unsigned char)s[end - 1])) end--;
+  if (start > 0 || end < len) {
+    String copy(*this);
+    assign(copy.c_str() + start, end - start);
+  }
+}
+
+bool String::startsWith(const char* prefix) const {
+  return strncmp(c_str(), prefix, strlen(prefix)) == 0;
+}
+
+String String::substring(unsigned int from) const {
+  return substring(from, len);
+}
+
+String String::substring(unsigned int from, unsigned int to) const {
+  String out;
+  if (from < to && from < len) out.assign(c_str() + from, min(to, len) - from);
+  return out;
+}
+
+long String::toInt() const {
+  return atol(c_str());
+}
+
+String operator+(const String& a, const String& b) {
+  String out(a);
+  out += b;
+  return out;
+}
+
+String operator+(const String& a, const char* b) {
+  String out(a);
+  out += b;
+  return out;
+}
+
+String operator+(const char* a, const String& b) {
+  String out(a);
+  out += b;
+  return out;
+}
+
+// ---------------------------------------------------------------- Serial
+
+static char serialLine[512];
+static size_t serialLength = 0;
+static void (*serialSink)(const char* line) = nullptr;
+static std::string serialIn;
+
+size_t HardwareSerial::write(uint8_t c) {
+  if (c == '\n') {
+    serialLine[serialLength] = '\0';
+    if (serialLength > 0 && serialLine[serialLength - 1] == '\r') serialLine[serialLength - 1] = '\0';
+    if (serialSink) {
+      host::HostScope scope;  // O teste analisa a linha com a própria memória
+      serialSink(serialLine);
+    }
+    serialLength = 0;
+  } else if (serialLength < sizeof(serialLine) - 1) {
+    serialLine[serialLength++] = (char)c;
+  }
+  return 1;
+}
+
+int HardwareSerial::available() {
+  return (int)serialIn.size();
+}
+
+int HardwareSerial::read() {
+  if (serialIn.empty()) return -1;
+  int c = (uint8_t)serialIn[0];
+  host::HostScope scope;
+  serialIn.erase(0, 1);
+  return c;
+}
+
+int HardwareSerial::peek() {
+  return serialIn.empty() ? -1 : (uint8_t)serialIn[0];
+}
+
+namespace host {
+
+void setSerialSink(void (*sink)(const char* line)) {
+  serialSink = sink;
+}
+
+void serialInput(const char* text) {
+  serialIn += text;
+}
+
+}  // namespace host
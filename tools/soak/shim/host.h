@@ -0,0 +1,83 @@
+#ifndef SOAK_HOST_H
+#define SOAK_HOST_H
+
+// Lado do teste do shim: relógio virtual, pinos, Serial, heap simulado, flash e o
+// "ar" (AP do peer e o socket TCP). O firmware não inclui este arquivo.
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string>
+
+namespace host {
+
+// Relógio: micros() é o tempo virtual; millis() = início + tempo/1000 (volta aos 2^32 ms)
+void startClock(uint32_t firstMillis);
+uint64_t elapsedUs();      // Desde startClock
+void advance(uint32_t us); // Avança, dispara timer1 e entrega eventos de Wi-Fi vencidos
+
+// Pinos: nível do pino de entrada visto pelo firmware; a troca chama a ISR
+void setPin(uint8_t pin, int level);
+int outputLevel(uint8_t pin);
+
+// Serial: cada linha completa do firmware vai para sink; input é lido por Serial.read()
+void setSerialSink(void (*sink)(const char* line));
+void serialInput(const char* text);
+
+// Heap do ESP8266 simulado (umm_malloc: blocos de 8 bytes, cabeçalho de 4, best fit).
+// Alocações dentro de FirmwareScope (new, String, conexões, arquivos) vão para ele.
+struct HeapStats {
+  uint32_t size;
+  uint32_t used;
+  uint32_t maxUsed;          // High-water
+  uint32_t maxBlock;         // Maior bloco livre agora
+  uint32_t minMaxBlock;      // Menor "maior bloco livre" já visto
+  uint8_t fragmentation;     // Mesma fórmula de ESP.getHeapFragmentation()
+  uint8_t maxFragmentation;
+  uint32_t allocations;
+  uint32_t liveBlocks;
+  uint32_t failures;         // Pedidos sem bloco livre que coubesse
+};
+void initHeap(uint32_t size);
+HeapStats heapStats();
+void* heapAlloc(size_t size);
+void heapFree(void* p);
+
+struct FirmwareScope {  // Enquanto existir, new/delete usam o heap simulado
+  FirmwareScope();
+  ~FirmwareScope();
+  bool previous;
+};
+
+struct HostScope {      // Memória do próprio shim (std::map etc.) dentro de chamadas do firmware
+  HostScope();
+  ~HostScope();
+  bool previous;
+};
+
+// Flash (LittleFS em memória)
+struct FlashStats {
+  uint64_t bytesWritten;
+  uint32_t bytesUsed;
+  uint32_t maxBytesUsed;
+  uint32_t files;
+  uint32_t openFiles;
+  uint32_t fullWrites;       // Escritas recusadas por falta de espaço
+};
+void initFlash(uint32_t size);
+FlashStats flashStats();
+
+// Rede: o peer é o AP "morse-transceiver" em 192.168.4.1:5000
+void setApVisible(bool visible); // false derruba a STA (evento de desassociação) e o socket
+bool apVisible();
+bool peerLinkOpen();             // Há conexão TCP da unidade com o peer
+void peerSend(const char* line); // Linha do peer para a unidade ('\n' acrescentado)
+bool peerReceive(std::string& line); // Próxima linha da unidade para o peer
+void peerReset();                // Fecha o socket (RST) sem mexer no Wi-Fi
+uint32_t peerConnections();      // Conexões TCP aceitas pelo peer desde o início
+
+// ESP.restart() chamado (o teste trata como falha)
+bool restartRequested();
+
+}  // namespace host
+
+#endif
@@ -0,0 +1,16 @@
+#ifndef SOAK_INTERNAL_H
+#define SOAK_INTERNAL_H
+
+// Ligações entre os arquivos do shim (nem firmware nem teste usam)
+
+#include <stdint.h>
+
+namespace host {
+
+uint64_t nowUs();
+void wifiTick();       // Scan, associação e eventos vencidos (chamado por advance)
+void noteFlashWrite(uint32_t bytes);
+
+}  // namespace host
+
+#endif
@@ -0,0 +1,201 @@
+#define SOAK_SHIM  // long nativo (ver Arduino.h)
+#include "LittleFS.h"
+#include <map>
+#include <string>
+#include <vector>
+#include "host.h"
+#include "internal.h"
+
+fs::FS LittleFS;
+
+static const uint32_t FLASH_BLOCK = 4096;
+static const uint32_t OPEN_FILE_BYTES = 300;  // lfs_file_t + cache de um bloco parcial
+static const uint32_t COMMIT_BYTES = 32;      // Entrada de metadados gravada a cada flush/close
+
+typedef std::vector<uint8_t> Contents;
+
+static std::map<std::string, std::shared_ptr<Contents>>* files = nullptr;
+static host::FlashStats stats;
+static uint32_t capacity = 1024 * 1024;
+
+static uint32_t blocksFor(size_t bytes) {
+  return (uint32_t)((bytes + FLASH_BLOCK - 1) / FLASH_BLOCK) + 1;  // + bloco de metadados
+}
+
+static void refreshUsage() {
+  uint32_t used = 0;
+  for (const auto& f : *files) used += blocksFor(f.second->size()) * FLASH_BLOCK;
+  stats.bytesUsed = used;
+  stats.maxBytesUsed = max(stats.maxBytesUsed, used);
+  stats.files = (uint32_t)files->size();
+}
+
+namespace fs {
+
+struct OpenFile {
+  std::shared_ptr<Contents> data;
+  size_t pos = 0;
+  bool writable = false;
+  bool dirty = false;
+  void* context = nullptr;
+
+  OpenFile() {
+    context = host::heapAlloc(OPEN_FILE_BYTES);
+    stats.openFiles++;
+  }
+
+  ~OpenFile() {
+    if (dirty) host::noteFlashWrite(COMMIT_BYTES);
+    host::heapFree(context);
+    stats.openFiles--;
+  }
+};
+
+size_t File::write(uint8_t c) {
+  return write(&c, 1);
+}
+
+size_t File::write(const uint8_t* bytes, size_t length) {
+  if (!handle || !handle->writable) return 0;
+  host::HostScope scope;
+  Contents& data = *handle->data;
+  size_t end = max(data.size(), handle->pos + length);
+  if (blocksFor(end) > blocksFor(data.size()) && stats.bytesUsed + (blocksFor(end) - blocksFor(data.size())) * FLASH_BLOCK > capacity) {
+    stats.fullWrites++;
+    return 0;
+  }
+  if (end > data.size()) data.resize(end);
+  memcpy(data.data() + handle->pos, bytes, length);
+  handle->pos += length;
+  handle->dirty = true;
+  host::noteFlashWrite((uint32_t)length);
+  refreshUsage();
+  return length;
+}
+
+int File::available() {
+  return handle ? (int)(handle->data->size() - min(handle->pos, handle->data->size())) : 0;
+}
+
+int File::read() {
+  if (available() <= 0) return -1;
+  return (*handle->data)[handle->pos++];
+}
+
+size_t File::read(uint8_t* bytes, size_t length) {
+  size_t n = min(length, (size_t)max(available(), 0));
+  if (n > 0) memcpy(bytes, handle->data->data() + handle->pos, n);
+  if (handle) handle->pos += n;
+  return n;
+}
+
+int File::peek() {
+  return available() > 0 ? (*handle->data)[handle->pos] : -1;
+}
+
+void File::flush() {
+  if (handle && handle->dirty) {
+    host::noteFlashWrite(COMMIT_BYTES);
+    handle->dirty = false;
+  }
+}
+
+bool File::seek(uint32_t offset, SeekMode mode) {
+  if (!handle) return false;
+  size_t base = mode == SeekSet ? 0 : mode == SeekCur ? handle->pos : handle->data->size();
+  if (base + offset > handle->data->size()) return false;
+  handle->pos = base + offset;
+  return true;
+}
+
+size_t File::position() const {
+  return handle ? handle->pos : 0;
+}
+
+size_t File::size() const {
+  return handle ? handle->data->size() : 0;
+}
+
+void File::close() {
+  handle.reset();  // Último File aberto para o arquivo grava o commit e libera o heap
+}
+
+bool FS::begin() {
+  host::HostScope scope;
+  if (files == nullptr) files = new std::map<std::string, std::shared_ptr<Contents>>();
+  return true;
+}
+
+File FS::open(const char* path, const char* mode) {
+  if (files == nullptr) return File();
+  host::HostScope scope;
+  auto found = files->find(path);
+  bool write = mode[0] == 'w' || mode[0] == 'a';
+  if (found == files->end()) {
+    if (!write) return File();
+    if (stats.bytesUsed + blocksFor(0) * FLASH_BLOCK > capacity) {
+      stats.fullWrites++;
+      return File();
+    }
+    found = files->emplace(path, std::make_shared<Contents>()).first;
+    host::noteFlashWrite(COMMIT_BYTES);
+  }
+  std::shared_ptr<OpenFile> handle = std::make_shared<OpenFile>();  // Contexto no heap simulado (OpenFile)
+  if (handle->context == nullptr) return File();
+  handle->data = found->second;
+  handle->writable = write || mode[1] == '+';
+  if (mode[0] == 'w') {
+    handle->data->clear();
+    host::noteFlashWrite(COMMIT_BYTES);
+  }
+  if (mode[0] == 'a') handle->pos = handle->data->size();
+  refreshUsage();
+  return File(handle);
+}
+
+bool FS::exists(const char* path) {
+  host::HostScope scope;
+  return files != nullptr && files->count(path) > 0;
+}
+
+bool FS::remove(const char* path) {
+  if (files == nullptr) return false;
+  host::HostScope scope;
+  bool removed = files->erase(path) > 0;
+  if (removed) {
+    host::noteFlashWrite(COMMIT_BYTES);
+    refreshUsage();
+  }
+  return removed;
+}
+
+bool FS::rename(const char* from, const char* to) {
+  if (files == nullptr) return false;
+  host::HostScope scope;
+  auto found = files->find(from);
+  if (found == files->end()) return false;
+  std::shared_ptr<Contents> data = found->second;
+  files->erase(found);
+  (*files)[to] = data;
+  host::noteFlashWrite(COMMIT_BYTES);
+  refreshUsage();
+  return true;
+}
+
+}  // namespace fs
+
+namespace host {
+
+void initFlash(uint32_t size) {
+  capacity = size;
+}
+
+FlashStats flashStats() {
+  return stats;
+}
+
+void noteFlashWrite(uint32_t bytes) {
+  stats.bytesWritten += bytes;
+}
+
+}  // namespace host
@@ -0,0 +1,67 @@
+#ifndef SOAK_LWIP_TCP_H
+#define SOAK_LWIP_TCP_H
+
+// API raw do lwIP (callbacks) sobre o mesmo socket do shim que o WiFiClient usa
+// (wifi.cpp). Só o que lwip-link.cpp chama; os callbacks rodam em advance(), entre
+// passagens do loop, como os do SDK.
+
+#include <stdint.h>
+
+typedef int8_t err_t;
+
+#define ERR_OK 0
+#define ERR_MEM -1
+#define ERR_RTE -4
+#define ERR_VAL -6
+#define ERR_CONN -11
+#define ERR_ABRT -13
+#define ERR_RST -14
+
+struct ip_addr_t {
+  uint32_t addr;  // Ordem de rede, como IPAddress
+};
+
+#define IP_ADDR4(ipaddr, a, b, c, d) ((ipaddr)->addr = (uint32_t)(a) | (uint32_t)(b) << 8 | (uint32_t)(c) << 16 | (uint32_t)(d) << 24)
+
+extern const ip_addr_t ip_addr_any;
+#define IP_ADDR_ANY (&ip_addr_any)
+
+struct pbuf {
+  pbuf* next;
+  void* payload;
+  uint16_t tot_len;  // Este pbuf e os seguintes da cadeia
+  uint16_t len;
+  uint16_t ref;
+};
+
+void pbuf_free(pbuf* p);               // Solta uma referência; libera a cadeia até o próximo ainda referenciado
+void pbuf_ref(pbuf* p);
+void pbuf_cat(pbuf* head, pbuf* tail); // A referência de tail passa para a cadeia
+
+struct tcp_pcb;
+
+typedef err_t (*tcp_recv_fn)(void* arg, tcp_pcb* pcb, pbuf* p, err_t err);
+typedef void (*tcp_err_fn)(void* arg, err_t err);
+typedef err_t (*tcp_connected_fn)(void* arg, tcp_pcb* pcb, err_t err);
+typedef err_t (*tcp_accept_fn)(void* arg, tcp_pcb* newPcb, err_t err);
+
+#define TCP_WRITE_FLAG_COPY 0x01
+#define TCP_WRITE_FLAG_MORE 0x02
+
+tcp_pcb* tcp_new();
+err_t tcp_bind(tcp_pcb* pcb, const ip_addr_t* ip, uint16_t port);
+tcp_pcb* tcp_listen(tcp_pcb* pcb);
+void tcp_accept(tcp_pcb* pcb, tcp_accept_fn accept);
+err_t tcp_connect(tcp_pcb* pcb, const ip_addr_t* ip, uint16_t port, tcp_connected_fn connected);
+err_t tcp_close(tcp_pcb* pcb);
+void tcp_abort(tcp_pcb* pcb);
+void tcp_arg(tcp_pcb* pcb, void* arg);
+void tcp_recv(tcp_pcb* pcb, tcp_recv_fn recv);
+void tcp_err(tcp_pcb* pcb, tcp_err_fn err);
+void tcp_nagle_disable(tcp_pcb* pcb);
+uint16_t tcp_sndbuf(tcp_pcb* pcb);
+err_t tcp_write(tcp_pcb* pcb, const void* data, uint16_t length, uint8_t flags);
+err_t tcp_output(tcp_pcb* pcb);
+void tcp_recved(tcp_pcb* pcb, uint16_t length);
+
+#endif
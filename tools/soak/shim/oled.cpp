@@ -0,0 +1,83 @@
+#define SOAK_SHIM  // long nativo (ver Arduino.h)
+#include "Adafruit_SSD1306.h"
+#include "host.h"
+
+TwoWire Wire;
+
+void Adafruit_GFX::drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color) {
+  for (int16_t i = 0; i < h; i++) drawPixel(x, y + i, color);
+}
+
+void Adafruit_GFX::drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color) {
+  for (int16_t i = 0; i < w; i++) drawPixel(x + i, y, color);
+}
+
+void Adafruit_GFX::fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) {
+  for (int16_t i = 0; i < w; i++) drawFastVLine(x + i, y, h, color);
+}
+
+void Adafruit_GFX::fillScreen(uint16_t color) {
+  fillRect(0, 0, _width, _height, color);
+}
+
+void Adafruit_GFX::drawRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) {
+  drawFastHLine(x, y, w, color);
+  drawFastHLine(x, y + h - 1, w, color);
+  drawFastVLine(x, y, h, color);
+  drawFastVLine(x + w - 1, y, h, color);
+}
+
+void Adafruit_GFX::drawBitmap(int16_t x, int16_t y, const uint8_t* bitmap, int16_t w, int16_t h, uint16_t color) {
+  int16_t stride = (w + 7) / 8;
+  for (int16_t j = 0; j < h; j++)
+    for (int16_t i = 0; i < w; i++)
+      if (bitmap[j * stride + i / 8] & (0x80 >> (i & 7))) drawPixel(x + i, y + j, color);
+}
+
+size_t Adafruit_GFX::write(uint8_t c) {
+  if (c == '\n') {
+    cursorX = 0;
+    cursorY += 8 * textSize;
+    return 1;
+  }
+  if (c == '\r') return 1;
+  if (textWrap && cursorX + 6 * textSize > _width) {
+    cursorX = 0;
+    cursorY += 8 * textSize;
+  }
+  if (textBackground != textColor) fillRect(cursorX, cursorY, 6 * textSize, 8 * textSize, textBackground);
+  if (c != ' ') {
+    // Glifo 5x7 derivado do código do caractere: densidade parecida com a da fonte real
+    for (int16_t row = 0; row < 7; row++) {
+      uint8_t bits = (uint8_t)((c * 0x9E) >> (row % 4)) | (row == 0 || row == 6 ? 0x0E : 0x11);
+      for (int16_t col = 0; col < 5; col++)
+        if (bits & (1 << col)) fillRect(cursorX + col * textSize, cursorY + row * textSize, textSize, textSize, textColor);
+    }
+  }
+  cursorX += 6 * textSize;
+  return 1;
+}
+
+Adafruit_SSD1306::~Adafruit_SSD1306() {
+  host::heapFree(buffer);
+}
+
+bool Adafruit_SSD1306::begin(uint8_t, uint8_t) {
+  if (buffer == nullptr) buffer = (uint8_t*)host::heapAlloc(_width * ((_height + 7) / 8));
+  if (buffer == nullptr) return false;
+  clearDisplay();
+  return true;
+}
+
+void Adafruit_SSD1306::clearDisplay() {
+  if (buffer) memset(buffer, 0, _width * ((_height + 7) / 8));
+}
+
+void Adafruit_SSD1306::drawPixel(int16_t x, int16_t y, uint16_t color) {
+  if (buffer == nullptr || x < 0 || y < 0 || x >= _width || y >= _height) return;
+  uint8_t& byte = buffer[x + (y / 8) * _width];
+  uint8_t bit = 1 << (y & 7);
+  if (color == WHITE) byte |= bit;
+  else if (color == INVERSE) byte ^= bit;
+  else byte &= ~bit;
+}
@@ -0,0 +1,733 @@
+#define SOAK_SHIM  // long nativo (ver Arduino.h)
+#include "ESP8266WiFi.h"
+#include <deque>
+#include <random>
+#include <string>
+#include <vector>
+#include "host.h"
+#include "internal.h"
+#include "lwip/tcp.h"
+
+ESP8266WiFiClass WiFi;
+
+// ---------------------------------------------------------------- O "ar"
+
+static const char* PEER_SSID = "morse-transceiver";
+static const uint8_t PEER_BSSID[6] = { 0x1A, 0xFE, 0x34, 0x00, 0x00, 0x01 };
+static const uint8_t UNIT_MAC[6] = { 0x5C, 0xCF, 0x7F, 0x12, 0x34, 0x56 };
+static const int32_t PEER_CHANNEL = 6;
+static const uint64_t SCAN_US = 2200000;        // Scan ativo em todos os canais
+static const uint64_t ASSOCIATE_US = 1200000;   // Autenticação + associação + DHCP
+static const uint64_t NO_AP_RETRY_US = 3000000; // O core repete o "disconnected" enquanto procura
+static const uint32_t SCAN_ENTRY_BYTES = 60;    // bss_info por rede no heap
+static const uint32_t SOCKET_CONTEXT_BYTES = 200; // tcp_pcb + ClientContext
+static const uint32_t PBUF_OVERHEAD = 16;
+
+struct Neighbor {
+  const char* ssid;
+  int32_t rssi;
+  int32_t channel;
+};
+
+static const Neighbor NEIGHBORS[] = { { "vizinho-2g", -81, 1 }, { "oficina", -74, 11 } };
+
+enum PendingKind { PENDING_GOT_IP, PENDING_STA_DISCONNECTED };
+
+struct Pending {
+  uint64_t at;
+  PendingKind kind;
+};
+
+template <typename Event>
+struct Handler : WiFiEventHandlerOpaque {
+  std::function<void(const Event&)> fn;
+};
+
+static bool apOn = true;
+static WiFiMode_t wifiMode = WIFI_OFF;
+static WiFiSleepType_t sleepType = WIFI_MODEM_SLEEP;
+static bool staWanted = false;      // begin() chamado: o core tenta (re)associar sozinho
+static bool staAssociated = false;
+static bool associating = false;
+static uint64_t associateAt = 0;
+static uint64_t nextNoApEvent = 0;
+static uint32_t staticIp = 0;
+static bool softApOn = false;
+static bool scanRunning = false;
+static bool scanDone = false;
+static uint64_t scanDoneAt = 0;
+static int scanCount = 0;
+static bool scanSawPeer = false;
+static void* scanResults = nullptr;  // No heap simulado até scanDelete
+static std::vector<Pending>* pending = nullptr;
+static std::vector<std::weak_ptr<Handler<WiFiEventStationModeGotIP>>>* gotIpHandlers = nullptr;
+static std::vector<std::weak_ptr<Handler<WiFiEventStationModeDisconnected>>>* disconnectedHandlers = nullptr;
+static std::mt19937 airRandom(7);
+
+struct HostSocket {
+  bool open = true;
+  bool reset = false;  // Fechado por RST do peer (o pcb raw recebe erro, não FIN)
+  void* context = nullptr;
+  std::deque<std::pair<void*, std::string>> toUnit;  // pbufs ainda não lidos
+  size_t readOffset = 0;
+  std::string fromUnit;
+
+  HostSocket() {
+    context = host::heapAlloc(SOCKET_CONTEXT_BYTES);
+  }
+
+  ~HostSocket() {
+    host::HostScope scope;
+    for (auto& p : toUnit) host::heapFree(p.first);
+    host::heapFree(context);
+  }
+
+  int available() const {
+    size_t total = 0;
+    for (const auto& p : toUnit) total += p.second.size();
+    return (int)(total - readOffset);
+  }
+
+  int read(bool consume) {
+    if (toUnit.empty()) return -1;
+    int c = (uint8_t)toUnit.front().second[readOffset];
+    if (!consume) return c;
+    if (++readOffset == toUnit.front().second.size()) {
+      host::heapFree(toUnit.front().first);
+      toUnit.pop_front();
+      readOffset = 0;
+    }
+    return c;
+  }
+};
+
+static std::weak_ptr<HostSocket> peerSide;  // O peer não mantém o socket vivo: quem fecha é a unidade
+static uint32_t connections = 0;
+
+static void schedule(uint64_t at, PendingKind kind) {
+  host::HostScope scope;
+  if (pending == nullptr) pending = new std::vector<Pending>();
+  pending->push_back({ at, kind });
+}
+
+static void closePeerSocket(bool reset = false) {
+  if (auto socket = peerSide.lock()) {
+    socket->open = false;
+    socket->reset = reset;
+  }
+}
+
+static void serviceRawPcbs();
+
+static void dropAssociation() {
+  if (staAssociated) schedule(host::nowUs(), PENDING_STA_DISCONNECTED);
+  staAssociated = false;
+  associating = false;
+  closePeerSocket();  // Sem enlace o socket morre (o lado da unidade percebe pelo connected())
+}
+
+static void startAssociation() {
+  associating = true;
+  associateAt = host::nowUs() + ASSOCIATE_US + airRandom() % 800000;
+}
+
+template <typename Event>
+static void deliver(std::vector<std::weak_ptr<Handler<Event>>>* handlers, const Event& event) {
+  if (handlers == nullptr) return;
+  std::vector<std::shared_ptr<Handler<Event>>> live;
+  {
+    host::HostScope scope;
+    for (auto& weak : *handlers)
+      if (auto handler = weak.lock()) live.push_back(handler);
+  }
+  host::FirmwareScope scope;
+  for (auto& handler : live) handler->fn(event);
+}
+
+namespace host {
+
+void wifiTick() {
+  uint64_t now = nowUs();
+  serviceRawPcbs();
+  if (scanRunning && now >= scanDoneAt) {
+    scanRunning = false;
+    scanDone = true;
+    scanSawPeer = apOn;
+    scanCount = (int)(sizeof(NEIGHBORS) / sizeof(NEIGHBORS[0])) + (apOn ? 1 : 0);
+    scanResults = heapAlloc(scanCount * SCAN_ENTRY_BYTES);
+  }
+  if (staWanted && !staAssociated) {
+    if (apOn && !associating) startAssociation();
+    if (associating && now >= associateAt) {
+      associating = false;
+      if (apOn) {
+        staAssociated = true;
+        schedule(now, PENDING_GOT_IP);
+      }
+    }
+    if (!apOn && now >= nextNoApEvent) {
+      nextNoApEvent = now + NO_AP_RETRY_US;
+      schedule(now, PENDING_STA_DISCONNECTED);
+    }
+  }
+  if (pending == nullptr || pending->empty()) return;
+  std::vector<Pending> due;
+  {
+    HostScope scope;
+    for (size_t i = 0; i < pending->size();) {
+      if ((*pending)[i].at <= now) {
+        due.push_back((*pending)[i]);
+        pending->erase(pending->begin() + i);
+      } else {
+        i++;
+      }
+    }
+  }
+  for (const Pending& p : due) {
+    if (p.kind == PENDING_GOT_IP) {
+      WiFiEventStationModeGotIP event;
+      event.ip = WiFi.localIP();
+      event.mask = IPAddress(255, 255, 255, 0);
+      event.gw = IPAddress(192, 168, 4, 1);
+      deliver(gotIpHandlers, event);
+    } else {
+      WiFiEventStationModeDisconnected event;
+      memcpy(event.bssid, PEER_BSSID, sizeof(event.bssid));
+      event.reason = apOn ? 8 : 201;  // ASSOC_LEAVE / NO_AP_FOUND
+      deliver(disconnectedHandlers, event);
+    }
+  }
+}
+
+void setApVisible(bool visible) {
+  if (apOn == visible) return;
+  apOn = visible;
+  if (!visible) {
+    dropAssociation();
+    nextNoApEvent = nowUs() + NO_AP_RETRY_US;
+  }
+}
+
+bool apVisible() {
+  return apOn;
+}
+
+bool peerLinkOpen() {
+  auto socket = peerSide.lock();
+  return socket && socket->open;
+}
+
+void peerSend(const char* line) {
+  auto socket = peerSide.lock();
+  if (!socket || !socket->open) return;
+  std::string text = std::string(line) + "\n";
+  void* pbuf = heapAlloc(text.size() + PBUF_OVERHEAD);
+  if (pbuf == nullptr) return;  // Sem memória o lwIP descarta o segmento
+  HostScope scope;
+  socket->toUnit.emplace_back(pbuf, text);
+}
+
+bool peerReceive(std::string& line) {
+  auto socket = peerSide.lock();
+  if (!socket) return false;
+  size_t end = socket->fromUnit.find('\n');
+  if (end == std::string::npos) return false;
+  HostScope scope;
+  line = socket->fromUnit.substr(0, end);
+  socket->fromUnit.erase(0, end + 1);
+  return true;
+}
+
+void peerReset() {
+  closePeerSocket(true);
+}
+
+uint32_t peerConnections() {
+  return connections;
+}
+
+}  // namespace host
+
+// ---------------------------------------------------------------- IPAddress
+
+size_t IPAddress::printTo(Print& out) const {
+  return out.printf("%u.%u.%u.%u", (*this)[0], (*this)[1], (*this)[2], (*this)[3]);
+}
+
+String IPAddress::toString() const {
+  char text[16];
+  snprintf(text, sizeof(text), "%u.%u.%u.%u", (*this)[0], (*this)[1], (*this)[2], (*this)[3]);
+  return String(text);
+}
+
+// ---------------------------------------------------------------- ESP8266WiFiClass
+
+bool ESP8266WiFiClass::mode(WiFiMode_t newMode) {
+  if (!(newMode & WIFI_STA)) {
+    staWanted = false;
+    dropAssociation();
+  }
+  if (!(newMode & WIFI_AP)) softApOn = false;
+  wifiMode = newMode;
+  return true;
+}
+
+WiFiMode_t ESP8266WiFiClass::getMode() {
+  return wifiMode;
+}
+
+int8_t ESP8266WiFiClass::scanNetworks(bool async, bool) {
+  scanDelete();
+  if (async) {
+    scanRunning = true;
+    scanDoneAt = host::nowUs() + SCAN_US;
+    return WIFI_SCAN_RUNNING;
+  }
+  scanDoneAt = host::nowUs();
+  scanRunning = true;
+  host::wifiTick();  // Síncrono: o core bloqueia; aqui o resultado já sai pronto
+  return (int8_t)scanCount;
+}
+
+int8_t ESP8266WiFiClass::scanComplete() {
+  if (scanRunning) return WIFI_SCAN_RUNNING;
+  if (scanDone) return (int8_t)scanCount;
+  return WIFI_SCAN_FAILED;
+}
+
+void ESP8266WiFiClass::scanDelete() {
+  host::heapFree(scanResults);
+  scanResults = nullptr;
+  scanDone = false;
+  scanCount = 0;
+}
+
+static const Neighbor* scanEntry(uint8_t i) {
+  static const Neighbor peer = { PEER_SSID, -58, PEER_CHANNEL };
+  if (!scanDone || i >= scanCount) return nullptr;
+  if (scanSawPeer) {
+    if (i == 0) return &peer;
+    i--;
+  }
+  return &NEIGHBORS[i];
+}
+
+String ESP8266WiFiClass::SSID(uint8_t i) const {
+  const Neighbor* entry = scanEntry(i);
+  return String(entry ? entry->ssid : "");
+}
+
+String ESP8266WiFiClass::SSID() const {
+  return String(staAssociated ? PEER_SSID : "");
+}
+
+int32_t ESP8266WiFiClass::RSSI(uint8_t i) {
+  const Neighbor* entry = scanEntry(i);
+  return entry ? entry->rssi : 0;
+}
+
+int32_t ESP8266WiFiClass::RSSI() {
+  if (!staAssociated) return 31;  // Valor do SDK sem associação
+  return -62 + (int32_t)(airRandom() % 7);
+}
+
+int32_t ESP8266WiFiClass::channel(uint8_t i) {
+  const Neighbor* entry = scanEntry(i);
+  return entry ? entry->channel : 0;
+}
+
+int32_t ESP8266WiFiClass::channel() {
+  return staAssociated ? PEER_CHANNEL : 1;
+}
+
+String ESP8266WiFiClass::BSSIDstr(uint8_t i) {
+  const Neighbor* entry = scanEntry(i);
+  char text[18];
+  uint8_t last = entry == nullptr ? 0 : (uint8_t)(entry->channel + 0x10);
+  if (entry != nullptr && entry->ssid == PEER_SSID) last = PEER_BSSID[5];
+  snprintf(text, sizeof(text), "%02X:%02X:%02X:%02X:%02X:%02X", PEER_BSSID[0], PEER_BSSID[1], PEER_BSSID[2], PEER_BSSID[3], PEER_BSSID[4], last);
+  return String(text);
+}
+
+uint8_t* ESP8266WiFiClass::BSSID() {
+  static uint8_t bssid[6];
+  memcpy(bssid, PEER_BSSID, sizeof(bssid));
+  return bssid;
+}
+
+wl_status_t ESP8266WiFiClass::begin(const char*, const char*, int32_t, const uint8_t*, bool connect) {
+  if (!(wifiMode & WIFI_STA)) wifiMode = (WiFiMode_t)(wifiMode | WIFI_STA);
+  staWanted = connect;
+  if (connect && !staAssociated) {
+    associating = false;  // Reinicia a tentativa em curso
+    nextNoApEvent = host::nowUs() + NO_AP_RETRY_US;
+  }
+  return status();
+}
+
+wl_status_t ESP8266WiFiClass::status() {
+  if (staAssociated) return WL_CONNECTED;
+  return staWanted ? WL_DISCONNECTED : WL_IDLE_STATUS;
+}
+
+void ESP8266WiFiClass::printDiag(Print& out) {
+  out.printf("Mode: %s\n", wifiMode == WIFI_AP_STA ? "STA+AP" : wifiMode == WIFI_AP ? "AP" : wifiMode == WIFI_STA ? "STA" : "NULL");
+  out.printf("Channel: %d\n", (int)channel());
+  out.printf("Status: %d\n", (int)status());
+}
+
+bool ESP8266WiFiClass::softAP(const char*, const char*, int, int, int) {
+  wifiMode = (WiFiMode_t)(wifiMode | WIFI_AP);
+  softApOn = true;
+  return true;
+}
+
+IPAddress ESP8266WiFiClass::softAPIP() {
+  return softApOn ? IPAddress(192, 168, 4, 1) : IPAddress();
+}
+
+String ESP8266WiFiClass::softAPmacAddress() {
+  char text[18];
+  snprintf(text, sizeof(text), "%02X:%02X:%02X:%02X:%02X:%02X", UNIT_MAC[0] | 0x02, UNIT_MAC[1], UNIT_MAC[2], UNIT_MAC[3], UNIT_MAC[4], UNIT_MAC[5]);
+  return String(text);
+}
+
+uint8_t ESP8266WiFiClass::softAPgetStationNum() {
+  return 0;  // Ninguém se associa ao AP da unidade neste mundo: o peer é sempre o AP
+}
+
+bool ESP8266WiFiClass::softAPdisconnect(bool) {
+  softApOn = false;
+  wifiMode = (WiFiMode_t)(wifiMode & ~WIFI_AP);
+  return true;
+}
+
+String ESP8266WiFiClass::macAddress() {
+  char text[18];
+  snprintf(text, sizeof(text), "%02X:%02X:%02X:%02X:%02X:%02X", UNIT_MAC[0], UNIT_MAC[1], UNIT_MAC[2], UNIT_MAC[3], UNIT_MAC[4], UNIT_MAC[5]);
+  return String(text);
+}
+
+uint8_t* ESP8266WiFiClass::macAddress(uint8_t* mac) {
+  memcpy(mac, UNIT_MAC, sizeof(UNIT_MAC));
+  return mac;
+}
+
+IPAddress ESP8266WiFiClass::localIP() {
+  if (!staAssociated) return IPAddress();
+  return staticIp != 0 ? IPAddress(staticIp) : IPAddress(192, 168, 4, 2);
+}
+
+IPAddress ESP8266WiFiClass::gatewayIP() {
+  return staAssociated ? IPAddress(192, 168, 4, 1) : IPAddress();
+}
+
+bool ESP8266WiFiClass::disconnect(bool) {
+  staWanted = false;
+  dropAssociation();
+  return true;
+}
+
+bool ESP8266WiFiClass::setSleepMode(WiFiSleepType_t type) {
+  sleepType = type;
+  return true;
+}
+
+WiFiSleepType_t ESP8266WiFiClass::getSleepMode() {
+  return sleepType;
+}
+
+bool ESP8266WiFiClass::config(IPAddress local, IPAddress, IPAddress) {
+  staticIp = (uint32_t)local;
+  return true;
+}
+
+// O core guarda só weak_ptr: o handler vive enquanto o firmware mantiver a referência
+template <typename Event>
+static WiFiEventHandler subscribe(std::vector<std::weak_ptr<Handler<Event>>>*& handlers, std::function<void(const Event&)> fn) {
+  auto handler = std::make_shared<Handler<Event>>();
+  handler->fn = fn;
+  host::HostScope scope;
+  if (handlers == nullptr) handlers = new std::vector<std::weak_ptr<Handler<Event>>>();
+  handlers->push_back(handler);
+  return handler;
+}
+
+WiFiEventHandler ESP8266WiFiClass::onStationModeGotIP(std::function<void(const WiFiEventStationModeGotIP&)> handler) {
+  return subscribe(gotIpHandlers, handler);
+}
+
+WiFiEventHandler ESP8266WiFiClass::onStationModeDisconnected(std::function<void(const WiFiEventStationModeDisconnected&)> handler) {
+  return subscribe(disconnectedHandlers, handler);
+}
+
+WiFiEventHandler ESP8266WiFiClass::onSoftAPModeStationConnected(std::function<void(const WiFiEventSoftAPModeStationConnected&)>) {
+  return std::make_shared<Handler<WiFiEventSoftAPModeStationConnected>>();  // Nunca dispara (ver softAPgetStationNum)
+}
+
+WiFiEventHandler ESP8266WiFiClass::onSoftAPModeStationDisconnected(std::function<void(const WiFiEventSoftAPModeStationDisconnected&)>) {
+  return std::make_shared<Handler<WiFiEventSoftAPModeStationDisconnected>>();
+}
+
+// ---------------------------------------------------------------- TCP
+
+int WiFiClient::connect(IPAddress ip, uint16_t port) {
+  stop();
+  if (!staAssociated || !apOn || ip != IPAddress(192, 168, 4, 1) || port != 5000) return 0;
+  std::shared_ptr<HostSocket> created;
+  {
+    host::HostScope scope;
+    created = std::make_shared<HostSocket>();
+  }
+  if (created->context == nullptr) return 0;  // Sem heap para o pcb
+  socket = created;
+  peerSide = created;
+  connections++;
+  return 1;
+}
+
+uint8_t WiFiClient::connected() {
+  return socket && (socket->open || socket->available() > 0);
+}
+
+size_t WiFiClient::write(uint8_t c) {
+  return write(&c, 1);
+}
+
+size_t WiFiClient::write(const uint8_t* data, size_t length) {
+  if (!socket || !socket->open) return 0;
+  host::HostScope scope;
+  socket->fromUnit.append((const char*)data, length);
+  return length;
+}
+
+int WiFiClient::available() {
+  return socket ? socket->available() : 0;
+}
+
+int WiFiClient::availableForWrite() {
+  return (socket && socket->open) ? 2920 : 0;  // TCP_SND_BUF: o peer lê na hora
+}
+
+int WiFiClient::read() {
+  return socket ? socket->read(true) : -1;
+}
+
+int WiFiClient::read(uint8_t* data, size_t length) {
+  size_t n = 0;
+  while (n < length && available() > 0) data[n++] = (uint8_t)read();
+  return (int)n;
+}
+
+int WiFiClient::peek() {
+  return socket ? socket->read(false) : -1;
+}
+
+void WiFiClient::stop() {
+  if (socket) socket->open = false;
+  socket.reset();  // Último dono libera o contexto e os pbufs no heap simulado
+}
+
+WiFiClient::operator bool() {
+  return connected();
+}
+
+IPAddress WiFiClient::remoteIP() {
+  return socket ? IPAddress(192, 168, 4, 1) : IPAddress();
+}
+
+void WiFiServer::begin() {
+  (void)port;
+}
+
+WiFiClient WiFiServer::available() {
+  return WiFiClient();
+}
+
+// ---------------------------------------------------------------- lwIP raw (NET_RAW_LWIP)
+
+static const uint16_t RAW_WINDOW = 5840;  // TCP_WND do core (4 × MSS)
+static const uint16_t RAW_SNDBUF = 2920;  // TCP_SND_BUF (2 × MSS); o peer lê na hora
+
+const ip_addr_t ip_addr_any = { 0 };
+
+struct tcp_pcb {
+  std::shared_ptr<HostSocket> socket;
+  void* arg = nullptr;
+  tcp_recv_fn recv = nullptr;
+  tcp_err_fn err = nullptr;
+  tcp_connected_fn connected = nullptr;  // Handshake concluído no próximo tick
+  bool listening = false;
+  bool finDelivered = false;
+  bool freed = false;  // Fechado ou abortado: apagado no fim do tick (pode estar dentro de um callback)
+  uint16_t window = RAW_WINDOW;
+};
+
+static std::vector<tcp_pcb*>* pcbs = nullptr;
+
+static void releaseSocket(tcp_pcb* pcb) {
+  host::HostScope scope;
+  if (pcb->socket) pcb->socket->open = false;
+  pcb->socket.reset();
+  pcb->freed = true;
+}
+
+// Um segmento por pbuf, cabeçalho e dados num só bloco do heap simulado (PBUF_RAM)
+static pbuf* newPbuf(const std::string& data) {
+  pbuf* p = static_cast<pbuf*>(host::heapAlloc(sizeof(pbuf) + data.size()));
+  if (p == nullptr) return nullptr;
+  p->next = nullptr;
+  p->payload = p + 1;
+  p->len = p->tot_len = (uint16_t)data.size();
+  p->ref = 1;
+  memcpy(p->payload, data.data(), data.size());
+  return p;
+}
+
+static void failPcb(tcp_pcb* pcb, err_t error) {
+  tcp_err_fn err = pcb->err;
+  void* arg = pcb->arg;
+  releaseSocket(pcb);  // O lwIP libera o pcb antes de avisar
+  host::FirmwareScope scope;
+  if (err != nullptr) err(arg, error);
+}
+
+// Handshake, segmentos recebidos (dentro da janela) e FIN, na ordem do lwIP
+static void serviceRawPcbs() {
+  if (pcbs == nullptr) return;
+  host::HostScope scope;
+  std::vector<tcp_pcb*> live = *pcbs;
+  for (tcp_pcb* pcb : live) {
+    if (pcb->freed || pcb->listening || !pcb->socket) continue;
+    std::shared_ptr<HostSocket> socket = pcb->socket;
+    if (socket->reset || (!socket->open && pcb->connected != nullptr)) {
+      failPcb(pcb, socket->reset ? ERR_RST : ERR_CONN);
+      continue;
+    }
+    if (pcb->connected != nullptr) {
+      tcp_connected_fn connected = pcb->connected;
+      pcb->connected = nullptr;
+      host::FirmwareScope firmware;
+      connected(pcb->arg, pcb, ERR_OK);
+    }
+    while (!pcb->freed && pcb->recv != nullptr && !socket->toUnit.empty() && socket->toUnit.front().second.size() <= pcb->window) {
+      pbuf* p = newPbuf(socket->toUnit.front().second);
+      if (p == nullptr) break;  // Sem heap: o segmento fica para o próximo tick
+      pcb->window -= p->len;
+      host::heapFree(socket->toUnit.front().first);
+      socket->toUnit.pop_front();
+      host::FirmwareScope firmware;
+      pcb->recv(pcb->arg, pcb, p, ERR_OK);
+    }
+    if (!pcb->freed && pcb->recv != nullptr && !socket->open && socket->toUnit.empty() && !pcb->finDelivered) {
+      pcb->finDelivered = true;
+      host::FirmwareScope firmware;
+      pcb->recv(pcb->arg, pcb, nullptr, ERR_OK);
+    }
+  }
+  for (size_t i = 0; i < pcbs->size();) {
+    if ((*pcbs)[i]->freed) {
+      delete (*pcbs)[i];
+      pcbs->erase(pcbs->begin() + i);
+    } else {
+      i++;
+    }
+  }
+}
+
+void pbuf_free(pbuf* p) {
+  while (p != nullptr && --p->ref == 0) {
+    pbuf* next = p->next;
+    host::heapFree(p);
+    p = next;
+  }
+}
+
+void pbuf_ref(pbuf* p) {
+  p->ref++;
+}
+
+void pbuf_cat(pbuf* head, pbuf* tail) {
+  pbuf* last = head;
+  for (; last->next != nullptr; last = last->next) last->tot_len += tail->tot_len;
+  last->tot_len += tail->tot_len;
+  last->next = tail;
+}
+
+tcp_pcb* tcp_new() {
+  host::HostScope scope;
+  if (pcbs == nullptr) pcbs = new std::vector<tcp_pcb*>();
+  tcp_pcb* pcb = new tcp_pcb();
+  pcbs->push_back(pcb);
+  return pcb;
+}
+
+err_t tcp_bind(tcp_pcb*, const ip_addr_t*, uint16_t) {
+  return ERR_OK;
+}
+
+tcp_pcb* tcp_listen(tcp_pcb* pcb) {
+  pcb->listening = true;
+  return pcb;
+}
+
+void tcp_accept(tcp_pcb*, tcp_accept_fn) {
+  // Ninguém se associa ao AP da unidade neste mundo (ver softAPgetStationNum)
+}
+
+err_t tcp_connect(tcp_pcb* pcb, const ip_addr_t* ip, uint16_t port, tcp_connected_fn connected) {
+  if (!staAssociated || !apOn) return ERR_RTE;
+  if (ip->addr != (uint32_t)IPAddress(192, 168, 4, 1) || port != 5000) return ERR_CONN;
+  host::HostScope scope;
+  std::shared_ptr<HostSocket> created = std::make_shared<HostSocket>();
+  if (created->context == nullptr) return ERR_MEM;  // Sem heap para o pcb
+  pcb->socket = created;
+  pcb->connected = connected;
+  pcb->window = RAW_WINDOW;
+  peerSide = created;
+  connections++;
+  return ERR_OK;
+}
+
+err_t tcp_close(tcp_pcb* pcb) {
+  releaseSocket(pcb);
+  return ERR_OK;
+}
+
+void tcp_abort(tcp_pcb* pcb) {
+  releaseSocket(pcb);
+}
+
+void tcp_arg(tcp_pcb* pcb, void* arg) {
+  pcb->arg = arg;
+}
+
+void tcp_recv(tcp_pcb* pcb, tcp_recv_fn recv) {
+  pcb->recv = recv;
+}
+
+void tcp_err(tcp_pcb* pcb, tcp_err_fn err) {
+  pcb->err = err;
+}
+
+void tcp_nagle_disable(tcp_pcb*) {
+}
+
+uint16_t tcp_sndbuf(tcp_pcb* pcb) {
+  return (pcb->socket && pcb->socket->open) ? RAW_SNDBUF : 0;
+}
+
+err_t tcp_write(tcp_pcb* pcb, const void* data, uint16_t length, uint8_t) {
+  if (!pcb->socket || !pcb->socket->open) return ERR_CONN;
+  host::HostScope scope;
+  pcb->socket->fromUnit.append(static_cast<const char*>(data), length);
+  return ERR_OK;
+}
+
+err_t tcp_output(tcp_pcb*) {
+  return ERR_OK;
+}
+
+void tcp_recved(tcp_pcb* pcb, uint16_t length) {
+  pcb->window = (uint16_t)std::min<uint32_t>(RAW_WINDOW, (uint32_t)pcb->window + length);
+}
@@ -0,0 +1,593 @@
+// Soak test of the whole firmware on the PC. morse-transceiver.ino and every module
+// are compiled unchanged against a small Arduino/ESP8266 shim (shim/) whose clock is
+// virtual, so weeks of operation run in minutes. millis() starts close to its 32-bit
+// rollover and the peer's clock is ahead of the unit's, so both wrap during the run.
+// In the firmware files long is int (shim/Arduino.h), as on the 32-bit ESP8266, so
+// "now - last" behaves across the wrap exactly as on the device.
+//
+// The scripted world: the peer is the AP "morse-transceiver" at 192.168.4.1:5000 and
+// speaks the same line protocol as network.cpp (mac:, alive, ping:/pong:, txpower:,
+// duration:NN@l.c.node). QSO sessions alternate local overs (edges on the key pin,
+// with contact bounce) and remote overs (duration lines from the peer) at random
+// speeds. Faults are injected at random: AP off for seconds to hours, TCP reset and
+// a peer that stops talking.
+//
+// Checks: allocation failures, high-water, largest free block, fragmentation and
+// day-over-day growth of the simulated ESP8266 heap; flash space and write volume;
+// every keyed letter decoded; every local element sent with its keyed duration; the
+// unit's heartbeat and inactivity timers; HLC stamps that keep up with time across
+// the rollover; late letters in the transcript; reconnect latency after each fault;
+// no ESP.restart().
+//
+// Build (from this folder):
+//   g++ -O2 -std=gnu++17 -DARDUINO -Ishim -I../../morse-transceiver
+//       shim/*.cpp ../../morse-transceiver/*.cpp soak.cpp -o soak
+//
+// Add -DNET_RAW_LWIP=1 to run the port-5000 link over lwip-link.cpp; shim/lwip/tcp.h
+// drives its callbacks from the same simulated socket.
+//
+// Run: ./soak [--days n] [--seed n] [--heap bytes] [--start-ms n] [-v] [--trace]
+//   -v prints faults and overs, --trace every firmware Serial line.
+//   Exit status 0 when every check passes.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <functional>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+#include "host.h"
+#include "morse-transceiver.ino"  // setup() e loop() do firmware, sem alterações
+#include "hlc.h"
+#include "morse-table.h"
+#include "net-message.h"
+
+static const uint64_t DAY_MS = 86400000ULL;
+static const uint32_t PEER_AHEAD_MS = 7 * 3600000UL;  // Relógio do peer: vira 7 h antes do da unidade
+static const char* PEER_MAC = "1A:FE:34:00:00:01";    // Menor que o da unidade: ela fica STA
+static const uint16_t PEER_NODE = 0x0001;
+static const uint32_t PEER_HEARTBEAT_MS = 1000;
+static const uint32_t PEER_TIMEOUT_MS = 3000;         // O peer derruba quem fica mais que isto sem "alive"
+static const uint32_t STABLE_MS = 5000;               // Conexão que dura isto conta como reconectada
+static const uint32_t RECONNECT_LIMIT_MS = 90000;     // Teto de backoff + associação + TCP
+static const uint32_t FREE_SLACK_MS = 500;            // Além de INACTIVITY_TIMEOUT para voltar a FREE
+static const uint32_t DURATION_TOLERANCE_MS = 3;      // Repique do contato (2 ms) + passo do relógio
+static const uint32_t LEAK_LIMIT = 256;               // Crescimento aceito do mínimo diário do heap
+static const uint32_t MIN_FREE_BLOCK = 4096;          // Abaixo disto uma conexão TCP nova pode falhar
+static const uint8_t MAX_FRAGMENTATION = 50;
+static const double MIN_FLASH_YEARS = 5;              // 100 mil ciclos por bloco, com nivelamento de desgaste
+static const char* CONSOLE_COMMANDS[] = { "metrics", "energy", "txpower", "keytiming", "exchange", "qso", "retime" };
+
+static std::mt19937 rng;
+static bool verbose = false;
+static bool trace = false;
+static bool ok = true;
+static std::map<std::string, uint32_t> failures;
+
+static uint64_t nowMs() {
+  return host::elapsedUs() / 1000;
+}
+
+static uint32_t uniform(uint32_t low, uint32_t high) {
+  return low + rng() % (high - low + 1);
+}
+
+static bool chance(double p) {
+  return std::uniform_real_distribution<double>(0, 1)(rng) < p;
+}
+
+// Registra a falha; imprime só as primeiras de cada tipo
+static void fail(const char* what, int value) {
+  ok = false;
+  if (++failures[what] <= 3) printf("FALHA: %s (%d) em %.3f h\n", what, value, nowMs() / 3600000.0);
+}
+
+// ---------------------------------------------------------------- Agenda
+
+static std::multimap<uint64_t, std::function<void()>> agenda;  // Instante em us -> ação
+
+static void schedule(uint64_t atMs, std::function<void()> action) {
+  agenda.emplace(atMs * 1000, action);
+}
+
+// ---------------------------------------------------------------- Serial da unidade
+
+static std::string decoded;          // Letras decodificadas no câmbio atual
+static bool unitBusy = false;        // TX/RX até "Inativo: FREE"
+static uint32_t unitTimeouts = 0;
+static uint32_t lateLetters = 0;
+static uint64_t consoleLines = 0;
+
+static void onSerialLine(const char* line) {
+  if (trace) puts(line);
+  const char* text = strstr(line, " - ");
+  text = text ? text + 3 : line;
+  if (strncmp(text, "Historico atualizado (", 22) == 0) {
+    const char* letter = strstr(text, "): ");
+    if (letter) decoded += letter[3];
+  } else if (strncmp(text, "Exibindo estado: ", 17) == 0) {
+    unitBusy = true;
+  } else if (strncmp(text, "Inativo: FREE", 13) == 0) {
+    unitBusy = false;
+  } else if (strncmp(text, "Heartbeat timeout", 17) == 0) {
+    unitTimeouts++;
+  }
+  if (const char* late = strstr(line, ", tardios ")) lateLetters = (uint32_t)atol(late + 10);
+  consoleLines++;
+}
+
+// ---------------------------------------------------------------- Peer (AP)
+
+struct Peer {
+  uint32_t connections = 0;
+  bool linked = false;
+  uint64_t connectedAtMs = 0;
+  bool stable = false;
+  uint64_t lastSentMs = 0;
+  uint64_t lastUnitAliveMs = 0;
+  uint64_t silentUntilMs = 0;
+  uint32_t lastL = 0;
+  uint16_t c = 0;
+  uint32_t maxAliveGapMs = 0;
+  uint32_t shortConnections = 0;
+  uint32_t dropsByPeer = 0;
+  bool haveUnitStamp = false;
+  uint32_t unitL = 0;
+  uint64_t unitStampAtMs = 0;
+  uint32_t maxUnitC = 0;
+  uint64_t stampsChecked = 0;
+  std::vector<uint32_t> received;  // "duration:" da unidade no câmbio atual
+};
+
+static Peer peer;
+static uint64_t reconnectSinceMs = 0;  // Fim da última falha (0 = nada pendente)
+static bool reconnectPending = true;   // O boot conta como "fim de falha" em 0
+static uint32_t maxReconnectMs = 0;
+static uint32_t reconnects = 0;
+
+static uint32_t peerMillis() {
+  return (uint32_t)millis() + PEER_AHEAD_MS;
+}
+
+static bool peerTalking() {
+  return nowMs() >= peer.silentUntilMs;
+}
+
+static void peerLine(const char* line) {
+  if (peerTalking()) host::peerSend(line);
+}
+
+// Carimbo do peer: o mesmo HLC, com o relógio dele
+static Hlc peerStamp() {
+  Hlc stamp;
+  uint32_t l = peerMillis();
+  if (l == peer.lastL) peer.c++;
+  else peer.c = 0;
+  peer.lastL = l;
+  stamp.l = l;
+  stamp.c = peer.c;
+  stamp.node = PEER_NODE;
+  return stamp;
+}
+
+static void checkUnitStamp(const char* line) {
+  Hlc stamp;
+  if (!hlcParse(line, stamp)) {
+    fail("duration sem carimbo HLC", 0);
+    return;
+  }
+  uint64_t at = nowMs();
+  if (peer.haveUnitStamp) {
+    int32_t advanced = (int32_t)(stamp.l - peer.unitL);
+    int elapsed = (int)(at - peer.unitStampAtMs);
+    if (advanced < 0) fail("HLC da unidade voltou", advanced);
+    else if (advanced + 50 < elapsed) fail("HLC da unidade atrás do tempo (ms)", elapsed - advanced);
+  }
+  if (stamp.c > peer.maxUnitC) peer.maxUnitC = stamp.c;
+  peer.haveUnitStamp = true;
+  peer.unitL = stamp.l;
+  peer.unitStampAtMs = at;
+  peer.stampsChecked++;
+}
+
+static void handleUnitLine(const std::string& line) {
+  uint64_t at = nowMs();
+  if (line == "alive") {
+    uint32_t gap = (uint32_t)(at - peer.lastUnitAliveMs);
+    if (gap > peer.maxAliveGapMs) peer.maxAliveGapMs = gap;
+    peer.lastUnitAliveMs = at;
+  } else if (line.compare(0, 5, "ping:") == 0) {
+    peerLine(("pong:" + line.substr(5)).c_str());
+  } else if (line.compare(0, 9, "duration:") == 0) {
+    peer.received.push_back((uint32_t)atol(line.c_str() + 9));
+    checkUnitStamp(line.c_str());
+  }
+}
+
+static void servicePeer() {
+  uint64_t at = nowMs();
+  if (host::peerConnections() != peer.connections) {
+    if (peer.linked && !peer.stable) peer.shortConnections++;
+    peer.connections = host::peerConnections();
+    peer.linked = true;
+    peer.stable = false;
+    peer.connectedAtMs = at;
+    peer.lastUnitAliveMs = at;
+    peer.lastSentMs = 0;
+    peerLine((std::string("mac:") + PEER_MAC).c_str());
+  }
+  if (!host::peerLinkOpen()) {
+    if (peer.linked && !peer.stable) peer.shortConnections++;
+    peer.linked = false;
+    return;
+  }
+  std::string line;
+  while (host::peerReceive(line)) handleUnitLine(line);
+  if (!peer.stable && at - peer.connectedAtMs >= STABLE_MS) {
+    peer.stable = true;
+    if (reconnectPending) {
+      uint32_t latency = (uint32_t)(peer.connectedAtMs - min(reconnectSinceMs, peer.connectedAtMs));
+      if (latency > maxReconnectMs) maxReconnectMs = latency;
+      if (latency > RECONNECT_LIMIT_MS) fail("reconexao lenta (ms)", latency);
+      if (verbose) printf("%10.3f h  reconectado em %u ms\n", at / 3600000.0, latency);
+      reconnectPending = false;
+      reconnects++;
+    }
+  }
+  if (peerTalking() && at - peer.lastSentMs >= PEER_HEARTBEAT_MS) {
+    char ping[24];
+    snprintf(ping, sizeof(ping), "ping:%u", (unsigned)peerMillis());
+    peerLine("alive");
+    peerLine(ping);
+    peerLine("txpower:17");
+    peer.lastSentMs = at;
+  }
+  if (at - peer.lastUnitAliveMs > PEER_TIMEOUT_MS) {
+    fail("unidade sem heartbeat; peer derrubou o enlace (ms)", (int)(at - peer.lastUnitAliveMs));
+    peer.dropsByPeer++;
+    host::peerReset();
+  }
+}
+
+// ---------------------------------------------------------------- Falhas injetadas
+
+enum FaultKind { FAULT_AP_OFF, FAULT_TCP_RESET, FAULT_PEER_SILENT, FAULT_KINDS };
+static const char* FAULT_NAMES[] = { "AP desligado", "RST no TCP", "peer mudo" };
+
+static uint64_t nextFaultMs = 0;
+static bool faultActive = false;
+static uint32_t faultCount[FAULT_KINDS] = {};
+
+static void faultEnded(uint64_t atMs) {
+  faultActive = false;
+  reconnectSinceMs = atMs;
+  reconnectPending = true;
+}
+
+static void injectFault() {
+  uint64_t at = nowMs();
+  if (faultActive || reconnectPending || at < nextFaultMs) return;
+  nextFaultMs = at + uniform(2, 16) * 3600000ULL;
+  FaultKind kind = (FaultKind)(rng() % FAULT_KINDS);
+  faultCount[kind]++;
+  faultActive = true;
+  uint32_t lengthMs = 0;
+  switch (kind) {
+    case FAULT_AP_OFF:
+      // Quase sempre curto; às vezes o peer some por horas
+      lengthMs = chance(0.7) ? uniform(10, 120) * 1000 : chance(0.8) ? uniform(2, 30) * 60000 : uniform(30, 120) * 60000;
+      host::setApVisible(false);
+      schedule(at + lengthMs, [] { host::setApVisible(true); faultEnded(nowMs()); });
+      break;
+    case FAULT_TCP_RESET:
+      host::peerReset();
+      faultEnded(at);
+      break;
+    case FAULT_PEER_SILENT:
+      lengthMs = uniform(4, 20) * 1000;
+      peer.silentUntilMs = at + lengthMs;
+      schedule(at + lengthMs, [] { faultEnded(nowMs()); });
+      break;
+    default:
+      break;
+  }
+  if (verbose) printf("%10.3f h  falha: %s (%u ms)\n", at / 3600000.0, FAULT_NAMES[kind], lengthMs);
+}
+
+// ---------------------------------------------------------------- Câmbios
+
+enum OverPhase { PHASE_WAIT, PHASE_KEYING, PHASE_SETTLING };
+
+struct Over {
+  bool local;
+  std::string text;
+  std::vector<uint32_t> durations;
+  uint64_t lastElementEndMs;
+  uint32_t connections;
+  bool disturbed;
+  bool linked;
+};
+
+static OverPhase phase = PHASE_WAIT;
+static Over over;
+static uint64_t nextOverMs = 0;
+static uint64_t sessionEndMs = 0;
+static uint64_t settleDeadlineMs = 0;
+static uint32_t overs[2] = {};  // Remotos, locais
+static uint64_t lettersChecked = 0;
+static uint64_t elementsChecked = 0;
+static uint32_t worstDurationError = 0;
+static uint32_t oversSkipped = 0;
+
+static void keyEdge(uint64_t atMs, bool down) {
+  schedule(atMs, [down] { host::setPin(LOCAL_PIN, down ? LOW : HIGH); });
+}
+
+// Chave local com repique em parte das bordas (desce, sobe, desce em 2 ms)
+static void keyElement(uint64_t atMs, uint32_t duration) {
+  keyEdge(atMs, true);
+  if (chance(0.3)) {
+    keyEdge(atMs + 1, false);
+    keyEdge(atMs + 2, true);
+  }
+  keyEdge(atMs + duration, false);
+  if (chance(0.3)) {
+    keyEdge(atMs + duration + 1, true);
+    keyEdge(atMs + duration + 2, false);
+  }
+}
+
+static void remoteElement(uint64_t atMs, uint32_t duration) {
+  schedule(atMs + duration, [duration] {
+    if (!host::peerLinkOpen()) return;
+    char line[NET_MESSAGE_MAX];
+    int length = snprintf(line, sizeof(line), "duration:%u", duration);
+    hlcFormat(peerStamp(), line + length, sizeof(line) - length);
+    peerLine(line);
+  });
+}
+
+static void startOver() {
+  static const char ALPHABET[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789";
+  bool local = !host::peerLinkOpen() || overs[1] <= overs[0] || chance(0.2);
+  over = Over();
+  over.local = local;
+  over.connections = host::peerConnections();
+  over.linked = host::peerLinkOpen() && peer.stable && !faultActive;
+  uint32_t dit = 1200 / uniform(10, 20);
+  uint64_t at = nowMs() + 200;
+  uint32_t words = uniform(1, 3);
+  for (uint32_t w = 0; w < words; w++) {
+    uint32_t letters = uniform(2, 5);
+    for (uint32_t l = 0; l < letters; l++) {
+      char c = ALPHABET[rng() % (sizeof(ALPHABET) - 1)];
+      char symbol[MORSE_MAX_ELEMENTS + 1];
+      morseCodeToString(encodeMorse(c), symbol);
+      for (const char* e = symbol; *e; e++) {
+        uint32_t duration = (*e == '.' ? dit : 3 * dit) * uniform(90, 110) / 100;
+        if (local) keyElement(at, duration);
+        else remoteElement(at, duration);
+        over.durations.push_back(duration);
+        over.lastElementEndMs = at + duration;
+        at += duration + dit * uniform(90, 110) / 100;
+      }
+      over.text += c;
+      at += uniform(900, 1300);  // Acima de LETTER_GAP mais o atraso do loop
+    }
+    at += uniform(800, 1500);
+  }
+  decoded.clear();
+  peer.received.clear();
+  overs[local ? 1 : 0]++;
+  phase = PHASE_KEYING;
+  if (verbose) printf("%10.3f h  cambio %s: %s (dit %u ms)\n", nowMs() / 3600000.0, local ? "local" : "remoto", over.text.c_str(), dit);
+}
+
+static void checkOver() {
+  bool disturbed = over.disturbed || over.connections != host::peerConnections();
+  if (over.local || (over.linked && !disturbed)) {
+    if (decoded != over.text) {
+      fail(over.local ? "letras locais decodificadas erradas" : "letras remotas decodificadas erradas", (int)decoded.size());
+      if (failures[over.local ? "letras locais decodificadas erradas" : "letras remotas decodificadas erradas"] <= 3)
+        printf("       esperado \"%s\", decodificado \"%s\"\n", over.text.c_str(), decoded.c_str());
+    }
+    lettersChecked += over.text.size();
+  } else {
+    oversSkipped++;
+  }
+  if (over.local && over.linked && !disturbed) {
+    if (peer.received.size() != over.durations.size()) {
+      fail("elementos locais nao enviados ao peer", (int)over.durations.size() - (int)peer.received.size());
+    } else {
+      for (size_t i = 0; i < over.durations.size(); i++) {
+        uint32_t error = (uint32_t)abs((int)peer.received[i] - (int)over.durations[i]);
+        if (error > worstDurationError) worstDurationError = error;
+        if (error > DURATION_TOLERANCE_MS) fail("duracao enviada diferente da chaveada (ms)", (int)error);
+      }
+      elementsChecked += over.durations.size();
+    }
+  }
+}
+
+static void direct() {
+  uint64_t at = nowMs();
+  if (phase == PHASE_KEYING) {
+    if (faultActive || !host::peerLinkOpen()) over.disturbed = true;
+    if (at < over.lastElementEndMs + LETTER_GAP + 300) return;
+    checkOver();
+    phase = PHASE_SETTLING;
+    settleDeadlineMs = over.lastElementEndMs + INACTIVITY_TIMEOUT + FREE_SLACK_MS;
+  } else if (phase == PHASE_SETTLING) {
+    if (unitBusy && at <= settleDeadlineMs) return;
+    if (unitBusy) {
+      fail("unidade nao voltou a FREE apos o cambio (ms)", (int)(at - over.lastElementEndMs));
+      unitBusy = false;
+    }
+    phase = PHASE_WAIT;
+    nextOverMs = at + uniform(500, 4000);
+  } else if (at >= nextOverMs) {
+    if (at >= sessionEndMs) {
+      // Próxima sessão de QSO: intervalo de 10 min a 6 h, duração de 5 a 40 min
+      uint64_t start = at + uniform(10, 360) * 60000ULL;
+      sessionEndMs = start + uniform(5, 40) * 60000ULL;
+      nextOverMs = start;
+      return;
+    }
+    startOver();
+  }
+}
+
+// ---------------------------------------------------------------- Heap e flash
+
+static std::vector<uint32_t> dayMinUsed;
+
+static void sampleHeap() {
+  // Só em repouso comparável: enlace estável, sem falha nem câmbio
+  if (phase == PHASE_KEYING || faultActive || !peer.stable) return;
+  size_t day = (size_t)(nowMs() / DAY_MS);
+  if (dayMinUsed.size() <= day) dayMinUsed.resize(day + 1, UINT32_MAX);
+  dayMinUsed[day] = min(dayMinUsed[day], host::heapStats().used);
+}
+
+static void printDay(uint32_t day) {
+  host::HeapStats heap = host::heapStats();
+  host::FlashStats flash = host::flashStats();
+  printf("dia %3u: heap %5u B (pico %5u), maior bloco %5u B (min %5u), frag %2u%% (max %2u%%), flash %4u KB, %u conexoes, cambios %u/%u\n",
+         day, heap.used, heap.maxUsed, heap.maxBlock, heap.minMaxBlock, heap.fragmentation, heap.maxFragmentation,
+         flash.bytesUsed / 1024, peer.connections, overs[1], overs[0]);
+  fflush(stdout);
+}
+
+int main(int argc, char** argv) {
+  double days = 21;
+  uint32_t seed = 1;
+  uint32_t heapSize = 40 * 1024;
+  bool startGiven = false;
+  uint32_t startMs = 0;
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "--days") == 0 && i + 1 < argc) days = atof(argv[++i]);
+    else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) seed = atoi(argv[++i]);
+    else if (strcmp(argv[i], "--heap") == 0 && i + 1 < argc) heapSize = atoi(argv[++i]);
+    else if (strcmp(argv[i], "--start-ms") == 0 && i + 1 < argc) startMs = strtoul(argv[++i], nullptr, 10), startGiven = true;
+    else if (strcmp(argv[i], "-v") == 0) verbose = true;
+    else if (strcmp(argv[i], "--trace") == 0) trace = true;
+    else {
+      fprintf(stderr, "uso: %s [--days n] [--seed n] [--heap bytes] [--start-ms n] [-v] [--trace]\n", argv[0]);
+      return 2;
+    }
+  }
+  if (days <= 0) days = 1;
+  if (!startGiven) startMs = (uint32_t)(0x100000000ULL - (uint64_t)(days * DAY_MS / 3));  // Vira no primeiro terço
+  rng.seed(seed);
+
+  host::initHeap(heapSize);
+  host::initFlash(1024 * 1024);
+  host::startClock(startMs);
+  host::setSerialSink(onSerialLine);
+  {
+    host::FirmwareScope firmware;
+    setup();
+  }
+  nextFaultMs = uniform(1, 6) * 3600000ULL;
+  nextOverMs = uniform(1, 10) * 60000ULL;
+  sessionEndMs = nextOverMs + uniform(5, 40) * 60000ULL;
+
+  uint64_t endUs = (uint64_t)(days * DAY_MS) * 1000;
+  uint64_t nextMinuteMs = 60000;
+  uint64_t nextConsoleMs = uniform(1, 6) * 3600000ULL;
+  uint64_t nextTranscriptMs = 3600000;
+  uint32_t day = 0;
+  uint64_t wrapAtMs = 0x100000000ULL - startMs;
+  while (host::elapsedUs() < endUs) {
+    uint64_t now = host::elapsedUs();
+    while (!agenda.empty() && agenda.begin()->first <= now) {
+      std::function<void()> action = agenda.begin()->second;
+      agenda.erase(agenda.begin());
+      action();
+    }
+    direct();
+    injectFault();
+    {
+      host::FirmwareScope firmware;
+      loop();
+    }
+    servicePeer();
+    uint64_t at = nowMs();
+    if (at >= nextMinuteMs) {
+      sampleHeap();
+      nextMinuteMs += 60000;
+    }
+    if (at >= nextConsoleMs && phase != PHASE_KEYING) {
+      uint32_t n = sizeof(CONSOLE_COMMANDS) / sizeof(CONSOLE_COMMANDS[0]);
+      host::serialInput(CONSOLE_COMMANDS[rng() % n]);
+      host::serialInput("\n");
+      nextConsoleMs = at + uniform(1, 8) * 3600000ULL;
+    }
+    if (at >= nextTranscriptMs) {
+      host::serialInput("transcript\n");
+      nextTranscriptMs = at + 3600000;
+    }
+    if (at / DAY_MS > day) printDay(++day);
+    if (host::restartRequested()) {
+      fail("ESP.restart() chamado", 0);
+      break;
+    }
+    // Passo de 5 ms durante a chave (o período do amostrador), 20 ms em repouso
+    uint64_t next = now + (phase == PHASE_KEYING ? 5000 : 20000);
+    if (!agenda.empty() && agenda.begin()->first < next) next = agenda.begin()->first;
+    host::advance((uint32_t)max(next - now, (uint64_t)1));
+  }
+  {
+    host::FirmwareScope firmware;
+    host::serialInput("transcript\n");
+    for (int i = 0; i < 3; i++) loop();
+  }
+
+  host::HeapStats heap = host::heapStats();
+  host::FlashStats flash = host::flashStats();
+  if (heap.failures > 0) fail("alocacoes sem memoria", heap.failures);
+  if (heap.minMaxBlock < MIN_FREE_BLOCK) fail("maior bloco livre abaixo do minimo (B)", heap.minMaxBlock);
+  if (heap.maxFragmentation > MAX_FRAGMENTATION) fail("fragmentacao do heap (%)", heap.maxFragmentation);
+  uint32_t firstDayMin = 0, lastDayMin = 0;
+  if (dayMinUsed.size() >= 3) {
+    firstDayMin = dayMinUsed[1];  // Dia 0: aquecimento (caches, arquivos abertos)
+    for (size_t d = dayMinUsed.size() - 1; d > 1; d--) {
+      if (dayMinUsed[d] != UINT32_MAX) {
+        lastDayMin = dayMinUsed[d];
+        break;
+      }
+    }
+    if (firstDayMin != UINT32_MAX && lastDayMin > firstDayMin + LEAK_LIMIT) fail("heap em repouso crescendo (B)", (int)(lastDayMin - firstDayMin));
+  }
+  if (flash.fullWrites > 0) fail("escritas recusadas por flash cheia", flash.fullWrites);
+  double bytesPerDay = (double)flash.bytesWritten / days;
+  double flashYears = bytesPerDay > 0 ? 1024.0 * 1024 * 100000 / bytesPerDay / 365 : 1e9;
+  if (flashYears < MIN_FLASH_YEARS) fail("vida estimada da flash (anos)", (int)flashYears);
+  if (peer.maxAliveGapMs > PEER_TIMEOUT_MS) fail("intervalo entre heartbeats da unidade (ms)", peer.maxAliveGapMs);
+  if (peer.maxUnitC > 1000) fail("contador c do HLC acumulando", peer.maxUnitC);
+  if (lateLetters > 0) fail("letras tardias na transcricao", lateLetters);
+  if (reconnectPending && nowMs() - reconnectSinceMs > RECONNECT_LIMIT_MS) fail("sem reconexao ao fim (ms)", (int)(nowMs() - reconnectSinceMs));
+  if (lettersChecked == 0 || elementsChecked == 0) fail("nenhum cambio conferido", 0);
+
+  printf("\n%.1f dias simulados, semente %u; millis() de %u, virou em %.2f dias (peer %.2f dias)\n",
+         days, seed, (unsigned)startMs, wrapAtMs / (double)DAY_MS, (wrapAtMs - PEER_AHEAD_MS) / (double)DAY_MS);
+  printf("heap (%u B): pico %u B, maior bloco livre min %u B, fragmentacao max %u%%, %u alocacoes, %u falhas\n",
+         heap.size, heap.maxUsed, heap.minMaxBlock, heap.maxFragmentation, heap.allocations, heap.failures);
+  printf("heap em repouso: min do dia 1 %u B, do ultimo dia %u B\n", firstDayMin, lastDayMin);
+  printf("flash: pico %u KB de %u KB, %u arquivos, %.1f KB gravados/dia (vida estimada %.0f anos)\n",
+         flash.maxBytesUsed / 1024, 1024, flash.files, bytesPerDay / 1024, flashYears);
+  printf("enlace: %u conexoes, %u reconexoes, %u curtas; falhas injetadas: %u AP, %u RST, %u mudo; maior reconexao %u ms\n",
+         peer.connections, reconnects, peer.shortConnections, faultCount[FAULT_AP_OFF], faultCount[FAULT_TCP_RESET],
+         faultCount[FAULT_PEER_SILENT], maxReconnectMs);
+  printf("heartbeat: maior intervalo da unidade %u ms, %u timeouts na unidade, %u quedas pelo peer\n",
+         peer.maxAliveGapMs, unitTimeouts, peer.dropsByPeer);
+  printf("cambios: %u locais, %u remotos (%u sem conferencia por falha no enlace), %u letras e %u elementos conferidos, pior erro de duracao %u ms\n",
+         overs[1], overs[0], oversSkipped, (unsigned)lettersChecked, (unsigned)elementsChecked, worstDurationError);
+  printf("hlc: %u carimbos conferidos, maior c %u, %u letras tardias; %u linhas na Serial\n",
+         (unsigned)peer.stampsChecked, peer.maxUnitC, lateLetters, (unsigned)consoleLines);
+  for (const auto& f : failures) printf("  %s: %u\n", f.first.c_str(), f.second);
+  printf("%s\n", ok ? "OK" : "FALHOU");
+  return ok ? 0 : 1;
+}
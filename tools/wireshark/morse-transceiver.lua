@@ -0,0 +1,86 @@
+-- Wireshark dissector for morse-transceiver protocol captures.
+--
+-- The firmware exports its capture ring (command "pcap" on the Serial Monitor)
+-- as a pcap with LINKTYPE_USER0 (147). Each record carries a 4-byte synthetic
+-- link-layer header followed by one text line of the port-5000 protocol:
+--
+--   offset 0  'M' 'T'     magic
+--   offset 2  direction   0 = received, 1 = sent
+--   offset 3  flags       bit 0 = line truncated to the capture snaplen
+--   offset 4  text line without the trailing '\n'
+--
+-- Install: copy to the Wireshark personal plugins folder, or run
+--   wireshark -X lua_script:morse-transceiver.lua captura.pcap
+
+local proto = Proto("morse_tx", "Morse Transceiver Protocol")
+
+local directions = { [0] = "RX", [1] = "TX" }
+
+local f_magic = ProtoField.string("morse_tx.magic", "Magic")
+local f_direction = ProtoField.uint8("morse_tx.direction", "Direction", base.DEC, directions)
+local f_truncated = ProtoField.bool("morse_tx.truncated", "Truncated", 8, nil, 0x01)
+local f_line = ProtoField.string("morse_tx.line", "Line")
+local f_type = ProtoField.string("morse_tx.type", "Message")
+local f_value = ProtoField.string("morse_tx.value", "Value")
+local f_duration = ProtoField.uint32("morse_tx.duration", "Duration (ms)")
+local f_mac = ProtoField.string("morse_tx.mac", "MAC")
+local f_timestamp = ProtoField.uint32("morse_tx.ping", "Sender millis()")
+local f_hlc = ProtoField.string("morse_tx.hlc", "HLC stamp")
+local f_hlc_l = ProtoField.uint32("morse_tx.hlc.l", "HLC l (ms)")
+local f_hlc_c = ProtoField.uint16("morse_tx.hlc.c", "HLC c")
+local f_hlc_node = ProtoField.uint16("morse_tx.hlc.node", "HLC node")
+
+proto.fields = { f_magic, f_direction, f_truncated, f_line, f_type, f_value, f_duration, f_mac, f_timestamp,
+                 f_hlc, f_hlc_l, f_hlc_c, f_hlc_node }
+
+-- Messages with a ":<value>" payload
+local valued = {
+  duration = f_duration,
+  mac = f_mac,
+  ping = f_timestamp,
+  pong = f_timestamp,
+  catchup = f_value,
+}
+
+function proto.dissector(buffer, pinfo, tree)
+  if buffer:len() < 4 or buffer(0, 2):string() ~= "MT" then return 0 end
+  pinfo.cols.protocol = "MORSE"
+  local direction = buffer(2, 1):uint()
+  local subtree = tree:add(proto, buffer(), "Morse Transceiver Protocol")
+  subtree:add(f_magic, buffer(0, 2))
+  subtree:add(f_direction, buffer(2, 1))
+  subtree:add(f_truncated, buffer(3, 1))
+  if buffer:len() == 4 then return 4 end
+
+  local body = buffer(4)
+  local text = body:string()
+  subtree:add(f_line, body)
+  local name, value = text:match("^([%w_]+):(.*)$")
+  if name == nil then name = text end
+  subtree:add(f_type, body, name)
+  if value ~= nil and #value > 0 then  -- "rx:" with no payload: body(#name + 1) would run past the buffer
+    local field = valued[name] or f_value
+    local range = body(#name + 1)
+    if field == f_duration then
+      -- "duration:<ms>@l.c.node": the HLC suffix follows the leading digits
+      local digits = value:match("^(%d+)")
+      subtree:add(field, range(0, digits and #digits or range:len()), tonumber(digits) or 0)
+      local at = value:find("@", 1, true)
+      local l, c, node = value:match("@(%d+)%.(%d+)%.(%d+)$")
+      if l ~= nil and buffer(3, 1):uint() % 2 == 0 then  -- A truncated line could end mid-field
+        local stamp = subtree:add(f_hlc, range(at - 1), value:sub(at + 1))
+        stamp:add(f_hlc_l, range(at, #l), tonumber(l))
+        stamp:add(f_hlc_c, range(at + #l + 1, #c), tonumber(c))
+        stamp:add(f_hlc_node, range(at + #l + #c + 2, #node), tonumber(node))
+      end
+    elseif field == f_timestamp then
+      subtree:add(field, range, tonumber(value) or 0)
+    else
+      subtree:add(field, range, value)
+    end
+  end
+  pinfo.cols.info = string.format("%s %s", directions[direction] or "?", text)
+  return buffer:len()
+end
+
+DissectorTable.get("wtap_encap"):add(wtap.USER0, proto)